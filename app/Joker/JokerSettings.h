@@ -11,6 +11,7 @@
 #include "PhCommonUI/PhDocumentWindowSettings.h"
 #include "PhCommonUI/PhFeedbackSettings.h"
 #include "PhLtc/PhLtcReaderSettings.h"
+#include "PhSync/PhSynchronizerSettings.h"
 
 
 /**
@@ -22,7 +23,8 @@ class JokerSettings : public PhGenericSettings,
 	public PhSonySettings,
 	public PhDocumentWindowSettings,
 	public PhFeedbackSettings,
-	public PhLtcReaderSettings
+	public PhLtcReaderSettings,
+	public PhSynchronizerSettings
 {
 public:
 	// PhWindowSettings
@@ -45,6 +47,8 @@ public:
 
 
 	PH_SETTING_INT3(setScreenDelay, screenDelay, delay)
+	PH_SETTING_BOOL(setVideoShaderConversion, videoShaderConversion)
+	PH_SETTING_INT(setVideoDecoderThreadCount, videoDecoderThreadCount)
 
 	// PhGraphicSettings
 	PH_SETTING_BOOL(setDisplayInfo, displayInfo)
@@ -60,6 +64,7 @@ public:
 	PH_SETTING_STRING2(setHudFontFile, hudFontFile, QApplication::applicationDirPath() + PATH_TO_RESSOURCES + "/HelveticaCYPlain.ttf")
 	PH_SETTING_STRING2(setTextFontFile, textFontFile, QApplication::applicationDirPath() + PATH_TO_RESSOURCES + "/SWENSON.TTF")
 	PH_SETTING_INT2(setTextBoldness, textBoldness, 2)
+	PH_SETTING_BOOL(setTextDistanceField, textDistanceField)
 	PH_SETTING_BOOL(setStripTestMode, stripTestMode)
 	PH_SETTING_BOOL2(setDisplayNextText, displayNextText, true)
 	PH_SETTING_STRINGLIST(setSelectedPeopleNameList, selectedPeopleNameList)
@@ -73,12 +78,17 @@ public:
 	PH_SETTING_BOOL2(setDisplayBackground, displayBackground, true)
 	PH_SETTING_INT2(setBackgroundColorLight, backgroundColorLight, 0xe7dcb3)
 	PH_SETTING_INT2(setBackgroundColorDark, backgroundColorDark, 0x242e2c)
+	PH_SETTING_BOOL(setStripTileCache, stripTileCache)
 
 	// PhVideoSettings :
 
 	// Synchro Settings
 	PH_SETTING_INT(setSynchroProtocol, synchroProtocol)
 
+	// PhSynchronizerSettings:
+	PH_SETTING_INT2(setSynchroCorrectionThreshold, synchroCorrectionThreshold, 1000)
+	PH_SETTING_INT2(setSynchroJumpThreshold, synchroJumpThreshold, 10000)
+
 	// PhSonySettings:
 	PH_SETTING_BOOL2(setVideoSyncUp, videoSyncUp, true)
 	PH_SETTING_UCHAR2(setSonyDevice1, sonyDevice1, 0xF0)
@@ -102,6 +112,7 @@ public:
 	PH_SETTING_STRING(setLastVideoFolder, lastVideoFolder)
 	PH_SETTING_STRINGLIST2(setStripFileType, stripFileType, QStringList({"joker", "detx", "mos", "drb", "syn6"}))
 	PH_SETTING_STRINGLIST2(setVideoFileType, videoFileType, QStringList({"m4v", "mkv", "avi", "mov", "mxf"}))
+	PH_SETTING_BOOL2(setStripDocCache, stripDocCache, true)
 
 
 	PH_SETTING_INT2(setLogMask, logMask, 1)
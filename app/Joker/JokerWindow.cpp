@@ -32,6 +32,7 @@ JokerWindow::JokerWindow(JokerSettings *settings) :
 	_sonySlave(PhTimeCodeType25, settings),
 	_mtcReader(PhTimeCodeType25),
 	_ltcReader(settings),
+	_synchronizer(settings),
 	_mediaPanelAnimation(&_mediaPanel, "windowOpacity"),
 	_firstDoc(true),
 	_resizingStrip(false),
@@ -113,7 +114,9 @@ JokerWindow::JokerWindow(JokerSettings *settings) :
 	_mediaPanelTimer.start(3000);
 
 	this->connect(ui->videoStripView, &PhGraphicView::beforePaint, this, &JokerWindow::timeCounter);
-	this->connect(ui->videoStripView, &PhGraphicView::beforePaint, _strip.clock(), &PhClock::tick);
+	// The state written by the synchronization thread is sampled once per frame
+	this->connect(ui->videoStripView, &PhGraphicView::beforePaint, &_syncClock, &PhClock::sample);
+	this->connect(ui->videoStripView, &PhGraphicView::frameElapsed, _strip.clock(), &PhClock::elapse);
 
 	this->connect(ui->videoStripView, &PhGraphicView::paint, this, &JokerWindow::onPaint);
 
@@ -127,7 +130,7 @@ JokerWindow::~JokerWindow()
 
 void JokerWindow::setupSyncProtocol()
 {
-	PhClock* clock = NULL;
+	const PhClockState* state = NULL;
 
 	// Disable old protocol
 	_sonySlave.close();
@@ -140,7 +143,7 @@ void JokerWindow::setupSyncProtocol()
 	case PhSynchronizer::Sony:
 		// Initialize the sony module
 		if(_sonySlave.open()) {
-			clock = _sonySlave.clock();
+			state = _sonySlave.clockState();
 			_lastVideoSyncElapsed.start();
 		}
 		else {
@@ -152,7 +155,7 @@ void JokerWindow::setupSyncProtocol()
 		{
 			QString input = _settings->ltcInputDevice();
 			if(_ltcReader.init(input))
-				clock = _ltcReader.clock();
+				state = _ltcReader.clockState();
 			else {
 				QMessageBox::critical(this, tr("Error"), "Unable to open " + input);
 				type = PhSynchronizer::NoSync;
@@ -161,7 +164,7 @@ void JokerWindow::setupSyncProtocol()
 		}
 	case PhSynchronizer::MTC:
 		if(_mtcReader.open(_settings->midiTimeCodePortName()))
-			clock = _mtcReader.clock();
+			state = _mtcReader.clockState();
 		else {
 			QMessageBox::critical(this, tr("Error"), QString(tr("Unable to create \"%1\" midi port")).arg(_settings->midiTimeCodePortName()));
 			type = PhSynchronizer::NoSync;
@@ -170,10 +173,12 @@ void JokerWindow::setupSyncProtocol()
 		break;
 	}
 
-	_synchronizer.setSyncClock(clock, type);
+	_syncClock.setState(state);
+	_syncClock.sample();
+	_synchronizer.setSyncClock(state ? &_syncClock : NULL, type);
 
 	// Disable slide if Joker is sync to a protocol
-	_mediaPanel.setSliderEnable(clock == NULL);
+	_mediaPanel.setSliderEnable(state == NULL);
 
 	_settings->setSynchroProtocol(type);
 }
@@ -186,6 +191,7 @@ bool JokerWindow::openDocument(QString fileName)
 	else
 		_firstDoc = false;
 
+	_doc->setCacheEnabled(_settings->stripDocCache());
 	if(!_doc->openStripFile(fileName))
 		return false;
 
@@ -863,6 +869,9 @@ void JokerWindow::onPaint(int width, int height)
 
 			int videoX = (width - videoWidth) / 2;
 			_videoEngine.drawVideo(videoX, y + blackStripHeight, videoWidth, realVideoHeight);
+			ui->videoStripView->addInfo(QString("decode: %1 threads, %2 fps")
+			                            .arg(_videoEngine.decoderThreadCount())
+			                            .arg(_videoEngine.decodeRate()));
 
 			// adjust tc size
 			if(videoX > tcWidth)
@@ -251,6 +251,7 @@ private:
 	PhLtcReader _ltcReader;
 	PhMidiTimeCodeReader _mtcReader;
 	PhSynchronizer _synchronizer;
+	PhClock _syncClock;
 
 	PhFloatingMediaPanel _mediaPanel;
 	QTimer _mediaPanelTimer;
@@ -186,6 +186,7 @@ void LTCToolWindow::on_readCheckBox_clicked(bool checked)
 
 void LTCToolWindow::onAudioProcessed(int minLevel, int maxLevel)
 {
+	_ltcReader.clock()->sample();
 	ui->minMaxLevelLabel->setText(QString("%1 / %2").arg(minLevel).arg(maxLevel));
 }
 
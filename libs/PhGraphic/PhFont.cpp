@@ -12,11 +12,73 @@
 #include <glu.h>
 #endif
 
+#include <cstddef>
+#include <cstring>
+
+#include <QtMath>
+#include <QtConcurrent>
+#include <QSet>
+
 #include "PhFont.h"
 #include "PhTools/PhDebug.h"
 
-PhFont::PhFont() : _texture(-1), _glyphHeight(0), _boldness(0), _ready(false)
+QList<PhFont *> PhFont::_pendingFonts;
+
+// SDL_ttf shares a single FreeType library between all its fonts:
+// every SDL_ttf call of the process is serialized by this mutex.
+static QMutex ttfMutex(QMutex::Recursive);
+
+/** @brief The spread of the distance field in pixel at the regular glyph size */
+#define PHFONT_DISTANCE_SPREAD 12
+/** @brief The size of a glyph cell in pixel at the regular glyph size */
+#define PHFONT_CELL_SIZE 128
+/** @brief The size of a glyph cell in pixel in the distance field atlas */
+#define PHFONT_DISTANCE_CELL_SIZE 64
+/** @brief The maximum number of atlas page */
+#define PHFONT_MAX_PAGE_COUNT 4
+/** @brief The maximum number of cached text layout */
+#define PHFONT_MAX_LAYOUT_COUNT 4096
+
+static const char *distanceFieldVertexShader =
+        "void main()\n"
+        "{\n"
+        "	gl_TexCoord[0] = gl_MultiTexCoord0;\n"
+        "	gl_FrontColor = gl_Color;\n"
+        "	gl_Position = ftransform();\n"
+        "}\n";
+
+// The atlas stores 0.5 on the glyph outline, more inside and less outside
+static const char *distanceFieldFragmentShader =
+        "uniform sampler2D atlas;\n"
+        "uniform float threshold;\n"
+        "void main()\n"
+        "{\n"
+        "	float distance = texture2D(atlas, gl_TexCoord[0].st).a;\n"
+        "	float smoothing = max(0.7 * fwidth(distance), 0.01);\n"
+        "	float alpha = smoothstep(threshold - smoothing, threshold + smoothing, distance);\n"
+        "	gl_FragColor = vec4(gl_Color.rgb * alpha, gl_Color.a * alpha);\n"
+        "}\n";
+
+PhFont::PhFont() : _ttfFont(NULL),
+	_flushCount(0),
+	_generation(0),
+	_atlasSerial(0),
+	_glyphHeight(0), _boldness(0), _ready(false),
+	_distanceField(false),
+	_distanceFieldProgram(NULL),
+	_queuedGlyphCount(0),
+	_vertexBuffer(QGLBuffer::VertexBuffer),
+	_vertexBufferContext(NULL)
 {
+	_vertexBuffer.setUsagePattern(QGLBuffer::StreamDraw);
+}
+
+PhFont::~PhFont()
+{
+	_pendingFonts.removeAll(this);
+	_prepareFuture.waitForFinished();
+	closeFont();
+	delete _distanceFieldProgram;
 }
 
 void PhFont::setFontFile(QString fontFile)
@@ -24,6 +86,7 @@ void PhFont::setFontFile(QString fontFile)
 	if(fontFile != this->_fontFile) {
 		PHDEBUG << fontFile;
 		this->_fontFile = fontFile;
+		closeFont();
 		_ready = false;
 	}
 }
@@ -33,146 +96,519 @@ QString PhFont::getFontFile()
 	return _fontFile;
 }
 
+// Keep SDL_ttf initialized while a font handle is open.
+// TTF_Init() and TTF_Quit() are reference counted by SDL_ttf:
+// a font is never released under the feet of its owner.
+static bool acquireTtf()
+{
+	if(TTF_Init() != 0) {
+		PHDEBUG << "TTF error:" << TTF_GetError();
+		return false;
+	}
+	return true;
+}
+
+// The texture uploads must not be recorded into a display list
+static bool compilingList()
+{
+	GLint list = 0;
+	glGetIntegerv(GL_LIST_INDEX, &list);
+	return list != 0;
+}
+
+static int fontHeight(QString fileName, int size)
+{
+	TTF_Font * font = TTF_OpenFont(fileName.toStdString().c_str(), size);
+	if(!font)
+		return -1;
+	int height = TTF_FontHeight(font);
+	TTF_CloseFont(font);
+	return height;
+}
+
 int PhFont::computeMaxFontSize(QString fileName)
 {
+	QMutexLocker locker(&ttfMutex);
+	if(!acquireTtf())
+		return -1;
+
+	// Search the first size reaching the maximum height (or the size below it)
+	int maxHeight = 128;
 	int size = 25;
-	int fontHeight = 128;
 	int low = 0, high = 1000;
-	while (low < high) {
+	while(low < high) {
 		size = (low + high) / 2;
-		TTF_Font * font = TTF_OpenFont(fileName.toStdString().c_str(), size);
+		int height = fontHeight(fileName, size);
 		//Break in case of issue with the file
-		if(!font)
+		if(height < 0) {
+			TTF_Quit();
 			return -1;
+		}
 
-		if (fontHeight == TTF_FontHeight(font))
+		if(height == maxHeight)
 			break;
-		else if (fontHeight < TTF_FontHeight(font))
+		else if(maxHeight < height)
 			high = size - 1;
 		else
 			low = size + 1;
-		TTF_CloseFont(font);
 	}
-	TTF_Font * font = TTF_OpenFont(fileName.toStdString().c_str(), size);
-	if(fontHeight < TTF_FontHeight(font))
+	if(maxHeight < fontHeight(fileName, size))
 		size--;
-	TTF_CloseFont(font);
+	TTF_Quit();
 
 	return size;
 }
 
-// This will split the setting of the bolness and the fontfile, which allow to change the boldness without reloading a font
-bool PhFont::init()
+/**
+ * @brief The offset from a pixel to the nearest seed pixel
+ */
+struct PhFontSeed
 {
-	int size = computeMaxFontSize(_fontFile);
+	/** @brief The horizontal offset */
+	int dx;
+	/** @brief The vertical offset */
+	int dy;
+};
 
-	if(size < 0)
-		return false;
-	PHDEBUG << "Opening" << _fontFile << "at size" << size;
-	TTF_Font * font = TTF_OpenFont(_fontFile.toStdString().c_str(), size);
+static inline int squareLength(const PhFontSeed &seed)
+{
+	return seed.dx * seed.dx + seed.dy * seed.dy;
+}
+
+static inline void compareSeed(QVector<PhFontSeed> &grid, int size, int x, int y, int offsetX, int offsetY)
+{
+	int nx = x + offsetX;
+	int ny = y + offsetY;
+	if((nx < 0) || (ny < 0) || (nx >= size) || (ny >= size))
+		return;
+	PhFontSeed other = grid[ny * size + nx];
+	other.dx += offsetX;
+	other.dy += offsetY;
+	PhFontSeed &seed = grid[y * size + x];
+	if(squareLength(other) < squareLength(seed))
+		seed = other;
+}
+
+// Propagate the nearest seed offsets in two passes (8SSEDT)
+static void propagateSeeds(QVector<PhFontSeed> &grid, int size)
+{
+	for(int y = 0; y < size; y++) {
+		for(int x = 0; x < size; x++) {
+			compareSeed(grid, size, x, y, -1, 0);
+			compareSeed(grid, size, x, y, 0, -1);
+			compareSeed(grid, size, x, y, -1, -1);
+			compareSeed(grid, size, x, y, 1, -1);
+		}
+		for(int x = size - 1; x >= 0; x--)
+			compareSeed(grid, size, x, y, 1, 0);
+	}
+	for(int y = size - 1; y >= 0; y--) {
+		for(int x = size - 1; x >= 0; x--) {
+			compareSeed(grid, size, x, y, 1, 0);
+			compareSeed(grid, size, x, y, 0, 1);
+			compareSeed(grid, size, x, y, -1, 1);
+			compareSeed(grid, size, x, y, 1, 1);
+		}
+		for(int x = 0; x < size; x++)
+			compareSeed(grid, size, x, y, -1, 0);
+	}
+}
+
+PhFontBitmap PhFont::rasterize(TTF_Font *font, uint ch, int boldness, bool distanceField)
+{
+	PhFontBitmap bitmap;
+	bitmap.code = ch;
+	bitmap.advance = 0;
+	bitmap.serial = 0;
+
+	QMutexLocker locker(&ttfMutex);
+
+	// SDL_ttf only handles the basic multilingual plane
+	if((ch < 32) || (ch > 0xFFFF) || !TTF_GlyphIsProvided(font, ch))
+		return bitmap;
+
+	int minx, maxx, miny, maxy, advance;
+	if((TTF_GlyphMetrics(font, ch, &minx, &maxx, &miny, &maxy, &advance) != 0) || (advance <= 0))
+		return bitmap;
+	bitmap.advance = advance;
 
 	//Font foreground color is white
 	SDL_Color color = {255, 255, 255, 255};
+	int space = PHFONT_CELL_SIZE;
+
+	if(!distanceField) {
+		// used to set the base surface
+		Uint32 rmask = 0x000000ff;
+		Uint32 gmask = 0x0000ff00;
+		Uint32 bmask = 0x00ff0000;
+		Uint32 amask = 0xff000000;
+		SDL_Surface * cellSurface = SDL_CreateRGBSurface(0, space, space, 32, rmask, gmask, bmask, amask);
+		// Font background color is transparent
+		SDL_FillRect(cellSurface, NULL, 0x00000000);
+
+		// The boldness is created by blitting the outlines from 0 to the boldness
+		for(int boldIndex = 0; boldIndex <= boldness; boldIndex++) {
+			TTF_SetFontOutline(font, boldIndex);
+			SDL_Surface * glyphSurface = TTF_RenderGlyph_Blended(font, ch, color);
+			if(!glyphSurface) {
+				PHDEBUG << "Error during the Render Glyph of " << ch << SDL_GetError();
+				continue;
+			}
+			SDL_BlitSurface(glyphSurface, NULL, cellSurface, NULL);
+			SDL_FreeSurface(glyphSurface);
+		}
+		TTF_SetFontOutline(font, 0);
+
+		bitmap.pixels.resize(space * space * 4);
+		SDL_LockSurface(cellSurface);
+		for(int y = 0; y < space; y++)
+			memcpy(bitmap.pixels.data() + y * space * 4, (Uint8*)cellSurface->pixels + y * cellSurface->pitch, space * 4);
+		SDL_UnlockSurface(cellSurface);
+		SDL_FreeSurface(cellSurface);
+
+		return bitmap;
+	}
+
+	SDL_Surface * glyphSurface = TTF_RenderGlyph_Blended(font, ch, color);
+	if(!glyphSurface) {
+		PHDEBUG << "Error during the Render Glyph of " << ch << SDL_GetError();
+		return bitmap;
+	}
+
+	// Seed each pixel of the glyph cell with its nearest inside and outside pixel
+	PhFontSeed none = {0, 0};
+	PhFontSeed unknown = {space * 2, space * 2};
+	QVector<PhFontSeed> inside(space * space);
+	QVector<PhFontSeed> outside(space * space);
+	SDL_LockSurface(glyphSurface);
+	SDL_PixelFormat *format = glyphSurface->format;
+	for(int y = 0; y < space; y++) {
+		for(int x = 0; x < space; x++) {
+			bool in = false;
+			if((x < glyphSurface->w) && (y < glyphSurface->h)) {
+				Uint32 pixel = ((Uint32*)((Uint8*)glyphSurface->pixels + y * glyphSurface->pitch))[x];
+				in = ((pixel & format->Amask) >> format->Ashift) >= 128;
+			}
+			inside[y * space + x] = in ? none : unknown;
+			outside[y * space + x] = in ? unknown : none;
+		}
+	}
+	SDL_UnlockSurface(glyphSurface);
+	SDL_FreeSurface(glyphSurface);
+
+	// The distance computation does not involve SDL_ttf
+	locker.unlock();
+
+	propagateSeeds(inside, space);
+	propagateSeeds(outside, space);
 
-	// used to set the base surface
-	Uint32 rmask = 0x000000ff;
-	Uint32 gmask = 0x0000ff00;
-	Uint32 bmask = 0x00ff0000;
-	Uint32 amask = 0xff000000;
-	SDL_Surface * matrixSurface = SDL_CreateRGBSurface(0, 2048, 2048, 32, rmask, gmask, bmask, amask);
-
-	// Font background color is transparent
-	Uint32 backgroundColor = 0x00000000;
-	SDL_FillRect(matrixSurface, NULL, backgroundColor);
-
-	// Space between glyph
-	int space = 128;
-	_glyphHeight = 0;
-
-	for(Uint16 ch = 0; ch < 32; ++ch) {
-		_glyphAdvance[ch] = 0;
-	}
-
-	//set the boldness
-	PHDEBUG << "Setting the font boldness to :" << _boldness;
-	for(int boldIndex = 0; boldIndex <= _boldness; boldIndex++) {
-		TTF_SetFontOutline(font, boldIndex);
-		// We get rid of the 32 first useless char
-		for(Uint16 charIndex = 32; charIndex < 256; ++charIndex) {
-			if(TTF_GlyphIsProvided(font, charIndex) or charIndex == 153) {
-				int minx, maxx, miny, maxy, advance;
-				Uint16 charCode = charIndex;
-				if(charCode == 153) {
-					charCode = 339;
-				}
-				TTF_GlyphMetrics(font, charCode, &minx, &maxx, &miny, &maxy, &advance);
-				if(advance > 0) {
-					// First render the glyph to a surface
-					SDL_Surface * glyphSurface = TTF_RenderGlyph_Blended(font, charCode, color);
-					if (glyphSurface) {
-						SDL_Rect glyphRect;
-						glyphRect.x = (charIndex % 16) * space;
-						glyphRect.y = (charIndex / 16) * space;
-						glyphRect.w = glyphSurface->w;
-						glyphRect.h = glyphSurface->h;
-						if(glyphRect.h > _glyphHeight)
-							_glyphHeight = glyphRect.h;
-						//PHDEBUG << ch << (char) ch << minx << maxx << miny << maxy << advance << _glyphHeight;
-						// Then blit it to the matrix
-						SDL_BlitSurface( glyphSurface, NULL, matrixSurface, &glyphRect );
-
-						// Store information about the glyph
-						_glyphAdvance[charIndex] = advance;
-					}
-					else {
-						_glyphAdvance[charIndex] = 0;
-						PHDEBUG << "Error during the Render Glyph of " << (char) charIndex << SDL_GetError();
-					}
-					SDL_FreeSurface(glyphSurface);
-				}
-				else {
-					PHDEBUG <<" Error with Glyph of char:" << charIndex << (char) charIndex << minx << maxx << miny << maxy << advance;
-					_glyphAdvance[charIndex] = 0;
-				}
+	// Average the signed distance of each 2x2 block
+	int cell = PHFONT_DISTANCE_CELL_SIZE;
+	bitmap.pixels.resize(cell * cell);
+	for(int y = 0; y < cell; y++) {
+		for(int x = 0; x < cell; x++) {
+			float distance = 0;
+			for(int i = 0; i < 4; i++) {
+				int index = (2 * y + i / 2) * space + 2 * x + i % 2;
+				distance += qSqrt(squareLength(inside[index])) - qSqrt(squareLength(outside[index]));
 			}
-			else
-				_glyphAdvance[charIndex] = 0;
+			float value = 0.5f - distance / (4 * 2 * PHFONT_DISTANCE_SPREAD);
+			bitmap.pixels[y * cell + x] = (char)(qBound(0.0f, value, 1.0f) * 255);
 		}
 	}
 
-	glEnable( GL_TEXTURE_2D );
-	// Have OpenGL generate a texture object handle for us
-	glGenTextures( 1, &_texture );
+	return bitmap;
+}
+
+bool PhFont::openFont()
+{
+	if(_ttfFont)
+		return true;
+
+	QMutexLocker locker(&ttfMutex);
+	if(!acquireTtf())
+		return false;
+
+	int size = computeMaxFontSize(_fontFile);
+	if(size >= 0) {
+		PHDEBUG << "Opening" << _fontFile << "at size" << size;
+		_ttfFont = TTF_OpenFont(_fontFile.toStdString().c_str(), size);
+	}
+	if(_ttfFont == NULL)
+		TTF_Quit();
+	return _ttfFont != NULL;
+}
+
+void PhFont::closeFont()
+{
+	if(_ttfFont) {
+		QMutexLocker locker(&ttfMutex);
+		TTF_CloseFont(_ttfFont);
+		TTF_Quit();
+		_ttfFont = NULL;
+	}
+	_glyphAdvances.clear();
+	_layouts.clear();
+}
+
+void PhFont::clearAtlas()
+{
+	if(!_pages.isEmpty())
+		glDeleteTextures(_pages.count(), _pages.constData());
+	_pages.clear();
+	_glyphSlots.clear();
+	_slotCodes.clear();
+	_slotLastUse.clear();
+	_freeSlots.clear();
+	_layouts.clear();
 
-	// Bind the texture object
-	glBindTexture( GL_TEXTURE_2D, _texture );
+	// The queued glyphs refer to the deleted pages
+	_pendingFonts.removeAll(this);
+	_pageVertices.clear();
+	_queuedGlyphCount = 0;
 
+	_generation++;
+	_atlasSerial++;
+}
 
-	// Edit the texture object's image data using the information SDL_Surface gives us
-	glTexImage2D( GL_TEXTURE_2D, 0, matrixSurface->format->BytesPerPixel, matrixSurface->w, matrixSurface->h, 0,
-	              GL_RGBA, GL_UNSIGNED_BYTE, matrixSurface->pixels);
+bool PhFont::addPage()
+{
+	Q_ASSERT(!compilingList());
 
+	int cell = _distanceField ? PHFONT_DISTANCE_CELL_SIZE : PHFONT_CELL_SIZE;
+	int pageSize = 16 * cell;
+	int bytesPerPixel = _distanceField ? 1 : 4;
+	// The empty cells must be transparent since the linear filtering reads the cell borders
+	QByteArray pixels(pageSize * pageSize * bytesPerPixel, 0);
+
+	GLuint texture = 0;
+	glGenTextures(1, &texture);
+	if(texture == 0) {
+		PHDEBUG << "glGenTextures() errored: is opengl context ready?";
+		return false;
+	}
+
+	glBindTexture(GL_TEXTURE_2D, texture);
+	if(_distanceField)
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_ALPHA8, pageSize, pageSize, 0, GL_ALPHA, GL_UNSIGNED_BYTE, pixels.constData());
+	else
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, pageSize, pageSize, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels.constData());
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
 
-	// Once the texture is created, the surface is no longer needed.
-	SDL_FreeSurface(matrixSurface);
-	TTF_CloseFont(font);
+	int page = _pages.count();
+	_pages.append(texture);
+	for(int cellIndex = 0; cellIndex < 256; cellIndex++) {
+		_freeSlots.append(page * 256 + cellIndex);
+		_slotCodes.append(0);
+		_slotLastUse.append(0);
+	}
+
+	return true;
+}
+
+int PhFont::allocateSlot()
+{
+	if(_freeSlots.isEmpty() && (_pages.count() < PHFONT_MAX_PAGE_COUNT))
+		addPage();
+	if(!_freeSlots.isEmpty())
+		return _freeSlots.takeFirst();
+
+	// All the pages are full: evict the least recently used glyph
+	int slot = 0;
+	for(int i = 1; i < _slotLastUse.count(); i++) {
+		if(_slotLastUse[i] < _slotLastUse[slot])
+			slot = i;
+	}
+	// The evicted glyph may still be queued
+	if(_slotLastUse[slot] == _flushCount)
+		flush();
+	_glyphSlots.remove(_slotCodes[slot]);
+	_generation++;
+
+	return slot;
+}
+
+int PhFont::storeGlyph(const PhFontBitmap &bitmap)
+{
+	if(!_glyphAdvances.contains(bitmap.code))
+		_glyphAdvances[bitmap.code] = bitmap.advance;
+	if(bitmap.pixels.isEmpty())
+		return -1;
 
-	_ready = true;
+	Q_ASSERT(!compilingList());
+	int slot = allocateSlot();
+	int cell = _distanceField ? PHFONT_DISTANCE_CELL_SIZE : PHFONT_CELL_SIZE;
+	int cellIndex = slot % 256;
+
+	glBindTexture(GL_TEXTURE_2D, _pages[slot / 256]);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	glTexSubImage2D(GL_TEXTURE_2D, 0, (cellIndex % 16) * cell, (cellIndex / 16) * cell, cell, cell,
+	                _distanceField ? GL_ALPHA : GL_RGBA, GL_UNSIGNED_BYTE, bitmap.pixels.constData());
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+	_glyphSlots[bitmap.code] = slot;
+	_slotCodes[slot] = bitmap.code;
+	_slotLastUse[slot] = _flushCount;
+
+	return slot;
+}
+
+int PhFont::glyphSlot(uint ch)
+{
+	QHash<uint, int>::const_iterator it = _glyphSlots.constFind(ch);
+	if(it != _glyphSlots.constEnd()) {
+		_slotLastUse[it.value()] = _flushCount;
+		return it.value();
+	}
+
+	if(!_ready || (getAdvance(ch) == 0))
+		return -1;
+
+	// The glyphs of a display list are loaded with loadText() beforehand
+	if(compilingList()) {
+		PHDEBUG << "Glyph" << ch << "not loaded before compiling a display list";
+		return -1;
+	}
+
+	return storeGlyph(rasterize(_ttfFont, ch, _boldness, _distanceField));
+}
+
+void PhFont::storePreparedGlyphs()
+{
+	QList<PhFontBitmap> bitmaps;
+	{
+		QMutexLocker locker(&_preparedMutex);
+		if(_preparedBitmaps.isEmpty())
+			return;
+		// The prepared glyphs are stored on the next select() outside of the list
+		if(compilingList())
+			return;
+		bitmaps.swap(_preparedBitmaps);
+	}
+
+	foreach(const PhFontBitmap &bitmap, bitmaps) {
+		// The bitmaps rasterized for a previous atlas are dropped
+		if((bitmap.serial == _atlasSerial) && !_glyphSlots.contains(bitmap.code))
+			storeGlyph(bitmap);
+	}
+}
+
+void PhFont::prepare(QString characters)
+{
+	_preparedCharacters = characters;
+	// The rasterization is started once the atlas is ready
+	if(_ready)
+		startPrepare();
+}
+
+void PhFont::startPrepare()
+{
+	QSet<uint> codeSet;
+	QVector<uint> codes;
+	foreach(uint ch, _preparedCharacters.toUcs4()) {
+		if(!codeSet.contains(ch) && !_glyphSlots.contains(ch) && (getAdvance(ch) > 0)) {
+			codeSet.insert(ch);
+			codes.append(ch);
+		}
+	}
+	if(codes.isEmpty())
+		return;
+
+	_prepareFuture.waitForFinished();
+
+	QString fileName = _fontFile;
+	int boldness = _boldness;
+	bool distanceField = _distanceField;
+	int serial = _atlasSerial;
+	PHDEBUG << "Preparing" << codes.count() << "glyphs of" << fileName;
+	// The worker uses its own font handle since a TTF_Font is not thread safe.
+	// It holds its own SDL_ttf reference so that the library survives the views.
+	_prepareFuture = QtConcurrent::run([=]() {
+		TTF_Font * font = NULL;
+		{
+			QMutexLocker ttfLocker(&ttfMutex);
+			if(!acquireTtf())
+				return;
+			int size = computeMaxFontSize(fileName);
+			if(size >= 0)
+				font = TTF_OpenFont(fileName.toStdString().c_str(), size);
+			if(!font) {
+				TTF_Quit();
+				return;
+			}
+		}
+		foreach(uint ch, codes) {
+			PhFontBitmap bitmap = rasterize(font, ch, boldness, distanceField);
+			bitmap.serial = serial;
+			QMutexLocker locker(&_preparedMutex);
+			_preparedBitmaps.append(bitmap);
+		}
+		QMutexLocker ttfLocker(&ttfMutex);
+		TTF_CloseFont(font);
+		TTF_Quit();
+	});
+}
+
+bool PhFont::init()
+{
+	clearAtlas();
+	_ready = false;
+
+	if(!openFont())
+		return false;
+
+	// The outlines enlarge the glyph surfaces on each side
+	{
+		QMutexLocker locker(&ttfMutex);
+		_glyphHeight = TTF_FontHeight(_ttfFont);
+	}
+	if(!_distanceField)
+		_glyphHeight += 2 * _boldness;
+
+	if(_distanceField) {
+		if(_distanceFieldProgram == NULL)
+			_distanceFieldProgram = new QGLShaderProgram();
+		if(!_distanceFieldProgram->isLinked()
+		   && (!_distanceFieldProgram->addShaderFromSourceCode(QGLShader::Vertex, distanceFieldVertexShader)
+		       || !_distanceFieldProgram->addShaderFromSourceCode(QGLShader::Fragment, distanceFieldFragmentShader)
+		       || !_distanceFieldProgram->link())) {
+			PHDEBUG << "Unable to build the distance field shader:" << _distanceFieldProgram->log();
+			return false;
+		}
+	}
+
+	_ready = addPage();
+	if(_ready)
+		startPrepare();
 	return _ready;
 }
 
-int PhFont::getAdvance(unsigned char ch)
+int PhFont::getAdvance(uint ch)
 {
-	return _glyphAdvance[ch];
+	QHash<uint, int>::const_iterator it = _glyphAdvances.constFind(ch);
+	if(it != _glyphAdvances.constEnd())
+		return it.value();
+
+	int advance = 0;
+	QMutexLocker locker(&ttfMutex);
+	if((ch >= 32) && (ch <= 0xFFFF) && openFont() && TTF_GlyphIsProvided(_ttfFont, ch)) {
+		int minx, maxx, miny, maxy;
+		if((TTF_GlyphMetrics(_ttfFont, ch, &minx, &maxx, &miny, &maxy, &advance) != 0) || (advance < 0))
+			advance = 0;
+	}
+	_glyphAdvances[ch] = advance;
+	return advance;
 }
 
 void PhFont::select()
 {
-	if(!_ready)
+	if(!_ready && !compilingList())
 		this->init();
-	glBindTexture(GL_TEXTURE_2D, (GLuint)_texture);
+	if(_ready) {
+		storePreparedGlyphs();
+		glBindTexture(GL_TEXTURE_2D, _pages.first());
+	}
 }
 
 int PhFont::getBoldness() const
@@ -182,18 +618,230 @@ int PhFont::getBoldness() const
 
 int PhFont::getNominalWidth(QString string)
 {
-	int width = 0;
-	foreach(QChar c, string) {
-		width += getAdvance(c.toLatin1());
-	}
-	return width;
+	return textLayout(string).totalAdvance;
 }
 
 void PhFont::setBoldness(int value)
 {
 	if(_boldness != value) {
 		_boldness = value;
+		// The distance field atlas does not depend on the boldness
+		if(!_distanceField)
+			_ready = false;
+	}
+}
+
+void PhFont::setDistanceField(bool distanceField)
+{
+	if(_distanceField != distanceField) {
+		_distanceField = distanceField;
 		_ready = false;
 	}
 }
 
+PhFontLayout &PhFont::textLayout(const QString &content)
+{
+	QHash<QString, PhFontLayout>::iterator it = _layouts.find(content);
+	if(it != _layouts.end())
+		return it.value();
+
+	if(_layouts.count() >= PHFONT_MAX_LAYOUT_COUNT)
+		_layouts.clear();
+
+	PhFontLayout layout;
+	layout.slotGeneration = -1;
+	layout.totalAdvance = 0;
+	foreach(uint ch, content.toUcs4()) {
+		int advance = getAdvance(ch);
+		if(advance > 0) {
+			layout.codes.append(ch);
+			layout.offsets.append(layout.totalAdvance);
+			layout.totalAdvance += advance;
+		}
+	}
+	layout.slots.fill(-1, layout.codes.count());
+
+	return _layouts.insert(content, layout).value();
+}
+
+void PhFont::addGlyph(uint ch, int x, int y, int z, int w, int h, QColor color)
+{
+	int slot = glyphSlot(ch);
+	if(slot >= 0)
+		queueGlyph(slot, x, y, z, w, h, color);
+}
+
+void PhFont::resolveSlots(PhFontLayout &layout)
+{
+	// The slots are resolved again once a glyph has been evicted
+	if(layout.slotGeneration != _generation) {
+		int generation = _generation;
+		for(int i = 0; i < layout.codes.count(); i++)
+			layout.slots[i] = glyphSlot(layout.codes[i]);
+		// The glyphs missing from a display list are looked for again later
+		layout.slotGeneration = compilingList() ? -1 : generation;
+	}
+	else {
+		foreach(int slot, layout.slots) {
+			if(slot >= 0)
+				_slotLastUse[slot] = _flushCount;
+		}
+	}
+}
+
+void PhFont::loadText(const QString &content)
+{
+	select();
+	if(_ready)
+		resolveSlots(textLayout(content));
+}
+
+void PhFont::addText(const QString &content, int x, int y, int z, int w, int h, QColor color)
+{
+	if(_glyphHeight == 0)
+		return;
+
+	PhFontLayout &layout = textLayout(content);
+	if(layout.totalAdvance == 0)
+		return;
+
+	resolveSlots(layout);
+
+	// computing quads coordinate;
+	int glyphHeight = h * PHFONT_CELL_SIZE / _glyphHeight;
+	int glyphWidth = w * PHFONT_CELL_SIZE / layout.totalAdvance;
+	for(int i = 0; i < layout.codes.count(); i++) {
+		if(layout.slots[i] >= 0) {
+			int offset = x + layout.offsets[i] * w / layout.totalAdvance;
+			queueGlyph(layout.slots[i], offset, y, z, glyphWidth, glyphHeight, color);
+		}
+	}
+}
+
+void PhFont::queueGlyph(int slot, int x, int y, int z, int w, int h, QColor color)
+{
+	if(_queuedGlyphCount == 0)
+		_pendingFonts.append(this);
+	_queuedGlyphCount++;
+
+	int page = slot / 256;
+	int cellIndex = slot % 256;
+	if(_pageVertices.count() <= page)
+		_pageVertices.resize(page + 1);
+
+	// all glyph are in a 1/16 x 1/16 box
+	float space = 0.0625f;
+	GLfloat tu1 = (cellIndex % 16) * space;
+	GLfloat tv1 = (cellIndex / 16) * space;
+	GLfloat tu2 = tu1 + space;
+	GLfloat tv2 = tv1 + space;
+	GLubyte r = color.red();
+	GLubyte g = color.green();
+	GLubyte b = color.blue();
+
+	//        (tu1, tv1) --- (tu2, tv1)
+	//            |              |
+	//            |              |
+	//        (tu1, tv2) --- (tu2, tv2)
+	PhFontVertex quad[4] = {
+		{(GLfloat)x,       (GLfloat)y,       (GLfloat)z, tu1, tv1, r, g, b, 255},
+		{(GLfloat)(x + w), (GLfloat)y,       (GLfloat)z, tu2, tv1, r, g, b, 255},
+		{(GLfloat)(x + w), (GLfloat)(y + h), (GLfloat)z, tu2, tv2, r, g, b, 255},
+		{(GLfloat)x,       (GLfloat)(y + h), (GLfloat)z, tu1, tv2, r, g, b, 255},
+	};
+	QVector<PhFontVertex> &vertices = _pageVertices[page];
+	for(int i = 0; i < 4; i++)
+		vertices.append(quad[i]);
+}
+
+void PhFont::flush()
+{
+	_pendingFonts.removeAll(this);
+	_queuedGlyphCount = 0;
+	_flushCount++;
+
+	// Gather the glyphs of all the pages in a single array
+	_vertices.resize(0);
+	QVector<int> pageOffsets;
+	for(int page = 0; page < _pageVertices.count(); page++) {
+		pageOffsets.append(_vertices.count());
+		_vertices += _pageVertices[page];
+		// Keep the allocated memory for the next frame
+		_pageVertices[page].resize(0);
+	}
+	pageOffsets.append(_vertices.count());
+
+	if(_vertices.isEmpty())
+		return;
+
+	// When compiling a display list, the vertices are read from the client memory
+	GLint list = 0;
+	glGetIntegerv(GL_LIST_INDEX, &list);
+	const char *base = NULL;
+	if(list) {
+		base = (const char*)_vertices.constData();
+	}
+	else {
+		// The buffer belongs to the context it was created in (renderPixmap() uses its own)
+		if(!_vertexBuffer.isCreated() || (_vertexBufferContext != QGLContext::currentContext())) {
+			_vertexBuffer.destroy();
+			if(!_vertexBuffer.create()) {
+				PHDEBUG << "Unable to create the vertex buffer";
+				_vertices.resize(0);
+				return;
+			}
+			_vertexBufferContext = QGLContext::currentContext();
+		}
+
+		_vertexBuffer.bind();
+		_vertexBuffer.allocate(_vertices.constData(), _vertices.count() * sizeof(PhFontVertex));
+	}
+
+	glEnable(GL_TEXTURE_2D);
+	glEnable(GL_BLEND);
+	glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+
+	// The outline passes are replaced by a lower threshold on the distance
+	bool useProgram = _distanceField && _distanceFieldProgram && _distanceFieldProgram->isLinked();
+	if(useProgram) {
+		_distanceFieldProgram->bind();
+		_distanceFieldProgram->setUniformValue("atlas", 0);
+		_distanceFieldProgram->setUniformValue("threshold", 0.5f - (float)_boldness / (2 * PHFONT_DISTANCE_SPREAD));
+	}
+
+	glEnableClientState(GL_VERTEX_ARRAY);
+	glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+	glEnableClientState(GL_COLOR_ARRAY);
+	glVertexPointer(3, GL_FLOAT, sizeof(PhFontVertex), base + offsetof(PhFontVertex, x));
+	glTexCoordPointer(2, GL_FLOAT, sizeof(PhFontVertex), base + offsetof(PhFontVertex, u));
+	glColorPointer(4, GL_UNSIGNED_BYTE, sizeof(PhFontVertex), base + offsetof(PhFontVertex, r));
+
+	// One call per atlas page
+	for(int page = 0; page < pageOffsets.count() - 1; page++) {
+		int count = pageOffsets[page + 1] - pageOffsets[page];
+		if(count > 0) {
+			glBindTexture(GL_TEXTURE_2D, _pages[page]);
+			glDrawArrays(GL_QUADS, pageOffsets[page], count);
+		}
+	}
+
+	glDisableClientState(GL_COLOR_ARRAY);
+	glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+	glDisableClientState(GL_VERTEX_ARRAY);
+	if(!list)
+		_vertexBuffer.release();
+	if(useProgram)
+		_distanceFieldProgram->release();
+
+	glDisable(GL_BLEND);
+	glDisable(GL_TEXTURE_2D);
+
+	_vertices.resize(0);
+}
+
+void PhFont::flushAll()
+{
+	// flush() removes the font from the pending list
+	while(!_pendingFonts.isEmpty())
+		_pendingFonts.first()->flush();
+}
@@ -8,6 +8,14 @@
 #define PHFONT_H
 
 #include <QString>
+#include <QList>
+#include <QVector>
+#include <QHash>
+#include <QColor>
+#include <QMutex>
+#include <QFuture>
+#include <QGLBuffer>
+#include <QGLShaderProgram>
 
 #include <QtGlobal>
 #if defined(Q_OS_MAC)
@@ -16,11 +24,74 @@
 #include <SDL2/SDL_ttf.h>
 #endif
 
+/**
+ * @brief A vertex of a glyph quad
+ */
+struct PhFontVertex
+{
+	/** @brief The position */
+	GLfloat x, y, z;
+	/** @brief The texture coordinate */
+	GLfloat u, v;
+	/** @brief The color */
+	GLubyte r, g, b, a;
+};
+
+/**
+ * @brief A glyph rasterized in an atlas cell
+ */
+struct PhFontBitmap
+{
+	/** @brief The unicode code point */
+	uint code;
+	/** @brief The regular advance */
+	int advance;
+	/** @brief The cell pixels (RGBA or a single distance channel), empty if the glyph is not provided */
+	QByteArray pixels;
+	/** @brief The atlas the glyph was rasterized for */
+	int serial;
+};
+
+/**
+ * @brief The cached glyph layout of a text
+ */
+struct PhFontLayout
+{
+	/** @brief The code points of the glyphs having an advance */
+	QVector<uint> codes;
+	/** @brief The regular advance preceding each glyph */
+	QVector<int> offsets;
+	/** @brief The atlas slot of each glyph (-1 if not rasterized) */
+	QVector<int> slots;
+	/** @brief The font generation the slots are valid for */
+	int slotGeneration;
+	/** @brief The regular advance of the whole text */
+	int totalAdvance;
+};
+
 /**
  * @brief Describe the font appearance for PhGraphicText
  *
  * The PhFont instance are initialized with a true type font file.
  * The boldness can be configured.
+ *
+ * The glyphs drawn with a font are queued and uploaded to a single
+ * vertex buffer which is drawn once the paint is over by flushAll().
+ *
+ * The glyphs are identified by their unicode code point and rasterized
+ * on demand into the cells of atlas pages of 16x16 glyphs. When all
+ * the pages are full, the least recently used glyph is evicted.
+ * The glyphs of a known character set can be rasterized ahead in
+ * a background thread with prepare().
+ *
+ * SDL_ttf is initialized by each open font handle and all the SDL_ttf
+ * calls of the process are serialized, the font can thus outlive
+ * the graphic views and be rasterized from the background thread.
+ *
+ * In distance field mode, the atlas stores the signed distance to the
+ * glyph outline in a single channel at half the regular resolution.
+ * The boldness is then applied by the fragment shader and changing it
+ * does not require to render the atlas again.
  */
 class PhFont
 {
@@ -30,6 +101,8 @@ public:
 	 */
 	PhFont();
 
+	~PhFont();
+
 	/**
 	 * @brief Set the source font file.
 	 * @param fontFile Path to the new font file
@@ -48,10 +121,10 @@ public:
 	 *
 	 * The returned value is correspond to the amount of pixel the character at a regular text size (100).
 	 * This value must be converted proportionaly if the text width is scaled.
-	 * @param ch ASCII index of the character.
+	 * @param ch The unicode code point of the character.
 	 * @return A value in pixel.
 	 */
-	int getAdvance(unsigned char ch);
+	int getAdvance(uint ch);
 
 	/**
 	 * @brief Get the regular height of the font.
@@ -83,6 +156,20 @@ public:
 	 */
 	int getBoldness() const;
 
+	/**
+	 * @brief Render the glyphs from a signed distance field atlas
+	 * @param distanceField True to use the distance field mode, false for the regular atlas
+	 */
+	void setDistanceField(bool distanceField);
+
+	/**
+	 * @brief Check if the font uses a signed distance field atlas
+	 * @return True if the distance field mode is on, false otherwise
+	 */
+	bool distanceField() const {
+		return _distanceField;
+	}
+
 	/**
 	 * @brief Get the nominal width of a given string
 	 * @param string to be measured
@@ -99,19 +186,119 @@ public:
 	 * @return A font size.
 	 */
 	static int computeMaxFontSize(QString fileName);
-private:
+
 	/**
-	 * @brief _texture
-	 * The texture reference
+	 * @brief Rasterize the glyphs of a character set in a background thread
+	 *
+	 * The glyphs are stored in the atlas on the next select().
+	 * @param characters The characters which will be drawn
 	 */
-	unsigned int _texture;
+	void prepare(QString characters);
 
+	/**
+	 * @brief The atlas generation
+	 *
+	 * It changes each time an atlas cell is reused for another glyph,
+	 * the display lists compiled with the font must then be compiled again.
+	 * @return An integer value
+	 */
+	int generation() const {
+		return _generation;
+	}
+
+	/**
+	 * @brief Queue a glyph quad for the next flush()
+	 * @param ch The unicode code point of the character
+	 * @param x The x coordinate
+	 * @param y The y coordinate
+	 * @param z The z coordinate
+	 * @param w The quad width
+	 * @param h The quad height
+	 * @param color The glyph color
+	 */
+	void addGlyph(uint ch, int x, int y, int z, int w, int h, QColor color);
+
+	/**
+	 * @brief Queue the glyph quads of a text for the next flush()
+	 *
+	 * The glyphs are stretched so that the text fills the rectangle.
+	 * The layout of the text is computed once and kept in a cache
+	 * which is cleared when the font file or the atlas change.
+	 * @param content The text
+	 * @param x The x coordinate
+	 * @param y The y coordinate
+	 * @param z The z coordinate
+	 * @param w The text width
+	 * @param h The text height
+	 * @param color The text color
+	 */
+	void addText(const QString &content, int x, int y, int z, int w, int h, QColor color);
+
+	/**
+	 * @brief Rasterize and store the glyphs of a text in the atlas
+	 *
+	 * The atlas textures cannot be updated while a display list is
+	 * compiled (the upload would be recorded and run on each call of the list):
+	 * the texts drawn in a display list must be loaded beforehand.
+	 * @param content The text
+	 */
+	void loadText(const QString &content);
+
+	/**
+	 * @brief Draw the queued glyphs with a single call
+	 */
+	void flush();
+
+	/**
+	 * @brief Flush all the fonts having queued glyphs
+	 *
+	 * It is called by PhGraphicView at the end of the paint.
+	 */
+	static void flushAll();
+private:
 	bool init();
+	bool openFont();
+	void closeFont();
+	void clearAtlas();
+	bool addPage();
+	int allocateSlot();
+	int glyphSlot(uint ch);
+	void queueGlyph(int slot, int x, int y, int z, int w, int h, QColor color);
+	PhFontLayout &textLayout(const QString &content);
+	void resolveSlots(PhFontLayout &layout);
+	int storeGlyph(const PhFontBitmap &bitmap);
+	void storePreparedGlyphs();
+	void startPrepare();
+
+	static PhFontBitmap rasterize(TTF_Font *font, uint ch, int boldness, bool distanceField);
+
+	TTF_Font *_ttfFont;
 
 	/**
 	 * @brief Store the regular advance of each glyph.
 	 */
-	int _glyphAdvance[256];
+	QHash<uint, int> _glyphAdvances;
+
+	/** @brief The layout of the recently drawn texts */
+	QHash<QString, PhFontLayout> _layouts;
+
+	/** @brief The atlas textures */
+	QVector<GLuint> _pages;
+	/** @brief The atlas slot (page * 256 + cell) of each rasterized glyph */
+	QHash<uint, int> _glyphSlots;
+	/** @brief The code point stored in each slot */
+	QVector<uint> _slotCodes;
+	/** @brief The flush count when each slot was last used */
+	QVector<quint64> _slotLastUse;
+	QList<int> _freeSlots;
+	quint64 _flushCount;
+	int _generation;
+	int _atlasSerial;
+
+	QString _preparedCharacters;
+	QFuture<void> _prepareFuture;
+	QMutex _preparedMutex;
+	QList<PhFontBitmap> _preparedBitmaps;
 
 	/**
 	 * @brief Store the regular advance of the font.
@@ -123,6 +310,17 @@ private:
 	int _boldness;
 
 	bool _ready;
+
+	bool _distanceField;
+	QGLShaderProgram *_distanceFieldProgram;
+
+	QVector<QVector<PhFontVertex> > _pageVertices;
+	int _queuedGlyphCount;
+	QVector<PhFontVertex> _vertices;
+	QGLBuffer _vertexBuffer;
+	const QGLContext *_vertexBufferContext;
+
+	static QList<PhFont *> _pendingFonts;
 };
 
 #endif // PHFONT_H
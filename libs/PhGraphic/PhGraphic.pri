@@ -3,7 +3,7 @@
 # License: http://www.gnu.org/licenses/gpl.html GPL version 2 or higher
 #
 
-QT		+= opengl
+QT		+= opengl concurrent
 
 HEADERS += \
 	$$TOP_ROOT/libs/PhGraphic/PhGraphicSettings.h \
@@ -11,7 +11,9 @@ HEADERS += \
 	$$TOP_ROOT/libs/PhGraphic/PhGraphicImage.h \
 	$$TOP_ROOT/libs/PhGraphic/PhGraphicText.h \
 	$$TOP_ROOT/libs/PhGraphic/PhGraphicTexturedRect.h \
+	$$TOP_ROOT/libs/PhGraphic/PhGraphicYUVRect.h \
 	$$TOP_ROOT/libs/PhGraphic/PhFont.h \
+	$$TOP_ROOT/libs/PhGraphic/PhGraphicBatch.h \
 	$$TOP_ROOT/libs/PhGraphic/PhGraphicObject.h \
 	$$TOP_ROOT/libs/PhGraphic/PhGraphicRect.h \
 	$$TOP_ROOT/libs/PhGraphic/PhGraphicSolidRect.h \
@@ -25,7 +27,9 @@ SOURCES += \
 	$$TOP_ROOT/libs/PhGraphic/PhGraphicImage.cpp \
 	$$TOP_ROOT/libs/PhGraphic/PhGraphicText.cpp \
 	$$TOP_ROOT/libs/PhGraphic/PhGraphicTexturedRect.cpp \
+	$$TOP_ROOT/libs/PhGraphic/PhGraphicYUVRect.cpp \
 	$$TOP_ROOT/libs/PhGraphic/PhFont.cpp \
+	$$TOP_ROOT/libs/PhGraphic/PhGraphicBatch.cpp \
 	$$TOP_ROOT/libs/PhGraphic/PhGraphicObject.cpp \
 	$$TOP_ROOT/libs/PhGraphic/PhGraphicRect.cpp \
 	$$TOP_ROOT/libs/PhGraphic/PhGraphicSolidRect.cpp \
@@ -1,3 +1,4 @@
+#include "PhGraphicBatch.h"
 #include "PhGraphicArrow.h"
 
 PhGraphicArrow::PhGraphicArrow(PhGraphicArrow::PhGraphicArrowDirection direction, int x, int y, int w, int h)
@@ -14,46 +15,33 @@ void PhGraphicArrow::setDirection(PhGraphicArrow::PhGraphicArrowDirection direct
 
 void PhGraphicArrow::draw()
 {
-	PhGraphicObject::draw();
-
-	int thickness = this->height() / 10;
-	int nose = this->height() / 3;
+	int x = this->x();
+	int y = this->y();
+	int z = this->z();
+	int w = this->width();
+	int h = this->height();
+	QColor color = this->color();
+	int thickness = h / 10;
+	int nose = h / 3;
 
 	switch (_direction) {
 	case DownLeftToUpRight:
-		glBegin(GL_QUADS);
-		{
-			glVertex3i(this->x(),      this->y() + thickness, this->z());
-			glVertex3i(this->x()+ thickness,      this->y(), this->z());
-			glVertex3i(this->x() + this->width(), this->y() + this->height()- thickness,  this->z());
-			glVertex3i(this->x() + this->width() - thickness, this->y() + this->height(),  this->z());
-		}
-		glEnd();
-
-		glBegin(GL_TRIANGLES);
-		{
-			glVertex3i(this->x() + this->width(), this->y() + this->height(),  this->z());
-			glVertex3i(this->x() + this->width() - nose, this->y() + this->height(),  this->z());
-			glVertex3i(this->x() + this->width(), this->y() + this->height()- nose,  this->z());
-		}
-		glEnd();
+		PhGraphicBatch::addQuad(x, y + thickness,
+		                        x + thickness, y,
+		                        x + w, y + h - thickness,
+		                        x + w - thickness, y + h, z, color);
+		PhGraphicBatch::addTriangle(x + w, y + h,
+		                            x + w - nose, y + h,
+		                            x + w, y + h - nose, z, color);
 		break;
 	case UpLefToDownRight:
-		glBegin(GL_QUADS);
-		{
-			glVertex3i(this->x() + this->width() -thickness, this->y(), this->z());
-			glVertex3i(this->x(),      this->y() + this->height()-thickness,  this->z());
-			glVertex3i(this->x()+thickness,      this->y() + this->height(),  this->z());
-			glVertex3i(this->x() + this->width(), this->y()+thickness, this->z());
-		}
-		glEnd();
-		glBegin(GL_TRIANGLES);
-		{
-			glVertex3i(this->x() + this->width(), this->y(),  this->z());
-			glVertex3i(this->x() + this->width() - nose, this->y(),  this->z());
-			glVertex3i(this->x() + this->width(), this->y() + nose,  this->z());
-		}
-		glEnd();
+		PhGraphicBatch::addQuad(x + w - thickness, y,
+		                        x, y + h - thickness,
+		                        x + thickness, y + h,
+		                        x + w, y + thickness, z, color);
+		PhGraphicBatch::addTriangle(x + w, y,
+		                            x + w - nose, y,
+		                            x + w, y + nose, z, color);
 		break;
 	}
 }
@@ -0,0 +1,138 @@
+/**
+ * @file
+ * @copyright (C) 2012-2014 Phonations
+ * @license http://www.gnu.org/licenses/gpl.html GPL version 2 or higher
+ */
+
+#include <cstddef>
+
+#include <QtMath>
+
+#include "PhTools/PhDebug.h"
+#include "PhGraphicBatch.h"
+
+QMap<int, QVector<PhGraphicVertex> > PhGraphicBatch::_layers;
+QVector<PhGraphicVertex> PhGraphicBatch::_vertices;
+QMap<int, QVector<GLfloat> > PhGraphicBatch::_unitCircles;
+QGLBuffer *PhGraphicBatch::_vertexBuffer = NULL;
+const QGLContext *PhGraphicBatch::_vertexBufferContext = NULL;
+
+static inline void appendVertex(QVector<PhGraphicVertex> &vertices, float x, float y, int z, const QColor &color)
+{
+	PhGraphicVertex vertex;
+	vertex.x = x;
+	vertex.y = y;
+	vertex.z = z;
+	vertex.r = color.red();
+	vertex.g = color.green();
+	vertex.b = color.blue();
+	vertex.a = color.alpha();
+	vertices.append(vertex);
+}
+
+void PhGraphicBatch::addTriangle(float x1, float y1, float x2, float y2, float x3, float y3, int z, QColor color)
+{
+	QVector<PhGraphicVertex> &vertices = _layers[z];
+	appendVertex(vertices, x1, y1, z, color);
+	appendVertex(vertices, x2, y2, z, color);
+	appendVertex(vertices, x3, y3, z, color);
+}
+
+void PhGraphicBatch::addQuad(float x1, float y1, float x2, float y2, float x3, float y3, float x4, float y4, int z, QColor color)
+{
+	QVector<PhGraphicVertex> &vertices = _layers[z];
+	appendVertex(vertices, x1, y1, z, color);
+	appendVertex(vertices, x2, y2, z, color);
+	appendVertex(vertices, x3, y3, z, color);
+	appendVertex(vertices, x1, y1, z, color);
+	appendVertex(vertices, x3, y3, z, color);
+	appendVertex(vertices, x4, y4, z, color);
+}
+
+void PhGraphicBatch::addRect(float x, float y, float w, float h, int z, QColor color)
+{
+	addQuad(x, y, x + w, y, x + w, y + h, x, y + h, z, color);
+}
+
+void PhGraphicBatch::addDisc(float x, float y, float radius, int resolution, int z, QColor color)
+{
+	if(resolution < 3)
+		return;
+
+	const QVector<GLfloat> &circle = unitCircle(resolution);
+	QVector<PhGraphicVertex> &vertices = _layers[z];
+	vertices.reserve(vertices.count() + 3 * resolution);
+	for(int i = 0; i < resolution; i++) {
+		appendVertex(vertices, x, y, z, color);
+		appendVertex(vertices, x + circle[2 * i] * radius, y + circle[2 * i + 1] * radius, z, color);
+		appendVertex(vertices, x + circle[2 * i + 2] * radius, y + circle[2 * i + 3] * radius, z, color);
+	}
+}
+
+const QVector<GLfloat> &PhGraphicBatch::unitCircle(int resolution)
+{
+	QMap<int, QVector<GLfloat> >::iterator it = _unitCircles.find(resolution);
+	if(it == _unitCircles.end()) {
+		// The first point is repeated at the end to close the circle
+		QVector<GLfloat> circle(2 * (resolution + 1));
+		for(int i = 0; i <= resolution; i++) {
+			float angle = i * 2 * M_PI / resolution;
+			circle[2 * i] = qSin(angle);
+			circle[2 * i + 1] = qCos(angle);
+		}
+		it = _unitCircles.insert(resolution, circle);
+	}
+	return it.value();
+}
+
+void PhGraphicBatch::flush()
+{
+	// Concatenate the layers from the farthest to the nearest
+	_vertices.resize(0);
+	for(QMap<int, QVector<PhGraphicVertex> >::iterator it = _layers.begin(); it != _layers.end(); ++it) {
+		_vertices += it.value();
+		// Keep the allocated memory for the next frame
+		it.value().resize(0);
+	}
+
+	if(_vertices.isEmpty())
+		return;
+
+	// When compiling a display list, the vertices are read from the client memory
+	GLint list = 0;
+	glGetIntegerv(GL_LIST_INDEX, &list);
+	const char *base = NULL;
+	if(list) {
+		base = (const char*)_vertices.constData();
+	}
+	else {
+		if(_vertexBuffer == NULL) {
+			_vertexBuffer = new QGLBuffer(QGLBuffer::VertexBuffer);
+			_vertexBuffer->setUsagePattern(QGLBuffer::StreamDraw);
+		}
+		// The buffer belongs to the context it was created in (renderPixmap() uses its own)
+		if(!_vertexBuffer->isCreated() || (_vertexBufferContext != QGLContext::currentContext())) {
+			_vertexBuffer->destroy();
+			if(!_vertexBuffer->create()) {
+				PHDEBUG << "Unable to create the vertex buffer";
+				return;
+			}
+			_vertexBufferContext = QGLContext::currentContext();
+		}
+
+		_vertexBuffer->bind();
+		_vertexBuffer->allocate(_vertices.constData(), _vertices.count() * sizeof(PhGraphicVertex));
+	}
+
+	glEnableClientState(GL_VERTEX_ARRAY);
+	glEnableClientState(GL_COLOR_ARRAY);
+	glVertexPointer(3, GL_FLOAT, sizeof(PhGraphicVertex), base + offsetof(PhGraphicVertex, x));
+	glColorPointer(4, GL_UNSIGNED_BYTE, sizeof(PhGraphicVertex), base + offsetof(PhGraphicVertex, r));
+
+	glDrawArrays(GL_TRIANGLES, 0, _vertices.count());
+
+	glDisableClientState(GL_COLOR_ARRAY);
+	glDisableClientState(GL_VERTEX_ARRAY);
+	if(!list)
+		_vertexBuffer->release();
+}
@@ -0,0 +1,114 @@
+/**
+ * @file
+ * @copyright (C) 2012-2014 Phonations
+ * @license http://www.gnu.org/licenses/gpl.html GPL version 2 or higher
+ */
+
+#ifndef PHGRAPHICBATCH_H
+#define PHGRAPHICBATCH_H
+
+#include <QColor>
+#include <QGLBuffer>
+#include <QMap>
+#include <QVector>
+
+/**
+ * @brief A vertex of a colored primitive
+ */
+struct PhGraphicVertex
+{
+	/** @brief The position */
+	GLfloat x, y, z;
+	/** @brief The color */
+	GLubyte r, g, b, a;
+};
+
+/**
+ * @brief Collect the colored primitives of a frame
+ *
+ * The solid graphic objects (rectangles, loops, arrows, dashed lines
+ * and discs) do not draw themselves immediately: they add their
+ * triangles to the batch which uploads them to a single interleaved
+ * vertex buffer and draws them in one call, sorted by Z, once flush()
+ * is called.
+ *
+ * The batch must be flushed before the frame buffer is swapped or
+ * changed, and around a display list compilation.
+ */
+class PhGraphicBatch
+{
+public:
+	/**
+	 * @brief Add a triangle
+	 * @param x1 The first point x coordinate
+	 * @param y1 The first point y coordinate
+	 * @param x2 The second point x coordinate
+	 * @param y2 The second point y coordinate
+	 * @param x3 The third point x coordinate
+	 * @param y3 The third point y coordinate
+	 * @param z The z coordinate
+	 * @param color The color
+	 */
+	static void addTriangle(float x1, float y1, float x2, float y2, float x3, float y3, int z, QColor color);
+
+	/**
+	 * @brief Add a convex quadrilateral
+	 *
+	 * The points are given clockwise or counterclockwise.
+	 * @param x1 The first point x coordinate
+	 * @param y1 The first point y coordinate
+	 * @param x2 The second point x coordinate
+	 * @param y2 The second point y coordinate
+	 * @param x3 The third point x coordinate
+	 * @param y3 The third point y coordinate
+	 * @param x4 The fourth point x coordinate
+	 * @param y4 The fourth point y coordinate
+	 * @param z The z coordinate
+	 * @param color The color
+	 */
+	static void addQuad(float x1, float y1, float x2, float y2, float x3, float y3, float x4, float y4, int z, QColor color);
+
+	/**
+	 * @brief Add an axis aligned rectangle
+	 * @param x The x coordinate
+	 * @param y The y coordinate
+	 * @param w The width
+	 * @param h The height
+	 * @param z The z coordinate
+	 * @param color The color
+	 */
+	static void addRect(float x, float y, float w, float h, int z, QColor color);
+
+	/**
+	 * @brief Add a disc
+	 *
+	 * The disc vertices are computed from a unit circle table
+	 * which is built once per resolution.
+	 * @param x The center x coordinate
+	 * @param y The center y coordinate
+	 * @param radius The radius
+	 * @param resolution The number of triangle
+	 * @param z The z coordinate
+	 * @param color The color
+	 */
+	static void addDisc(float x, float y, float radius, int resolution, int z, QColor color);
+
+	/**
+	 * @brief Draw the queued primitives and empty the batch
+	 *
+	 * When a display list is being compiled, the vertices are read
+	 * from the client memory so that they are recorded into the list.
+	 */
+	static void flush();
+
+private:
+	static const QVector<GLfloat> &unitCircle(int resolution);
+
+	static QMap<int, QVector<PhGraphicVertex> > _layers;
+	static QVector<PhGraphicVertex> _vertices;
+	static QMap<int, QVector<GLfloat> > _unitCircles;
+	static QGLBuffer *_vertexBuffer;
+	static const QGLContext *_vertexBufferContext;
+};
+
+#endif // PHGRAPHICBATCH_H
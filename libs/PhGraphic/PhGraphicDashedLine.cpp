@@ -1,3 +1,4 @@
+#include "PhGraphicBatch.h"
 #include "PhGraphicDashedLine.h"
 
 PhGraphicDashedLine::PhGraphicDashedLine(int dashCount, int x, int y, int w, int h) :
@@ -15,19 +16,13 @@ void PhGraphicDashedLine::setDashCount(int dashCount)
 
 void PhGraphicDashedLine::draw()
 {
-	PhGraphicRect::draw();
+	if(_dashCount <= 0)
+		return;
 
 	int width = this->width() / (2 * _dashCount - 1);
 	int x = this->x();
 	for(int i = 0; i < _dashCount; i++) {
-		glBegin(GL_QUADS);
-		{
-			glVertex3i(x,      this->y(), this->z());
-			glVertex3i(x + width, this->y(), this->z());
-			glVertex3i(x + width, this->y() + this->height(),  this->z());
-			glVertex3i(x,      this->y() + this->height(),  this->z());
-		}
+		PhGraphicBatch::addRect(x, this->y(), width, this->height(), this->z(), this->color());
 		x += 2 * width;
 	}
-	glEnd();
 }
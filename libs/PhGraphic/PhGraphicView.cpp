@@ -6,20 +6,26 @@
 
 #include <QtGlobal>
 #include <SDL2/SDL.h>
-#if defined(Q_OS_MAC)
-#include <SDL2_ttf/SDL_ttf.h>
-#else
-#include <SDL2/SDL_ttf.h>
-#endif
 #include <QtGui>
 #include "PhGraphicText.h"
+#include "PhGraphicBatch.h"
 
 #include "PhTools/PhDebug.h"
 #include "PhGraphicView.h"
 
+// The buffer swap waits for the vertical blank
+static QGLFormat swapIntervalFormat()
+{
+	QGLFormat format = QGLFormat::defaultFormat();
+	format.setSwapInterval(1);
+	return format;
+}
+
 PhGraphicView::PhGraphicView( QWidget *parent)
-	: QGLWidget(parent),
+	: QGLWidget(swapIntervalFormat(), parent),
 	_settings(NULL),
+	_lastSwapTime(0),
+	_lastPaintSwapTime(0),
 	_dropDetected(0),
 	_maxRefreshRate(0),
 	_maxPaintDuration(0),
@@ -28,8 +34,6 @@ PhGraphicView::PhGraphicView( QWidget *parent)
 {
 	if (SDL_Init(SDL_INIT_VIDEO) != 0)
 		PHDEBUG << "SDL error:" << SDL_GetError();
-	if (TTF_Init() != 0)
-		PHDEBUG << "TTF error:" << TTF_GetError();
 
 	_refreshTimer = new QTimer(this);
 	connect(_refreshTimer, SIGNAL(timeout()), this, SLOT(onRefresh()));
@@ -42,9 +46,12 @@ PhGraphicView::PhGraphicView( QWidget *parent)
 	else
 		PHDEBUG << "Unable to get the screen";
 
+	// The refresh is paced by the blocking buffer swap. The timer only bounds
+	// the refresh rate when the swap does not block (vertical synchronization
+	// forced off by the driver, hidden window...): with a blocking swap,
+	// it is always overdue when the swap returns.
 	int timerInterval = 500 / _screenFrequency;
-	_refreshTimer->start( timerInterval);
-	//PHDEBUG << "Refresh rate set to " << _screenFrequency << "hz, timer restart every" << timerInterval << "ms";
+	_refreshTimer->start(timerInterval);
 	_dropTimer.start();
 }
 
@@ -58,7 +65,6 @@ PhGraphicView::PhGraphicView(int width, int height, QWidget *parent)
 PhGraphicView::~PhGraphicView()
 {
 	_refreshTimer->stop();
-	TTF_Quit();
 	SDL_Quit();
 }
 
@@ -104,11 +110,18 @@ void PhGraphicView::onRefresh()
 	_lastUpdateDuration = t.elapsed();
 	if(_lastUpdateDuration > _maxUpdateDuration)
 		_maxUpdateDuration = _lastUpdateDuration;
-	if(_lastUpdateDuration > 1500 / _screenFrequency) {
+
+	// The frame has been displayed once the buffers are swapped:
+	// the absolute swap time is kept to avoid accumulating rounding errors
+	if(!_swapTimer.isValid())
+		_swapTimer.start();
+	PhTime swapTime = _swapTimer.nsecsElapsed() * 24 / 1000000;
+	PhTime frameDuration = swapTime - _lastSwapTime;
+	_lastSwapTime = swapTime;
+	if(frameDuration * _screenFrequency > 36000) {
 		_dropTimer.restart();
 		_dropDetected++;
 	}
-
 }
 
 void PhGraphicView::paintGL()
@@ -116,6 +129,10 @@ void PhGraphicView::paintGL()
 	//PHDEBUG << "PhGraphicView::paintGL" ;
 	emit beforePaint(_screenFrequency);
 
+	// The elapsed time is only given to the first paint following a swap
+	emit frameElapsed(_lastSwapTime - _lastPaintSwapTime);
+	_lastPaintSwapTime = _lastSwapTime;
+
 	glClear( GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
 	QTime timer;
@@ -123,6 +140,8 @@ void PhGraphicView::paintGL()
 
 	int ratio = this->windowHandle()->devicePixelRatio();
 	emit paint(this->width() * ratio, this->height() * ratio);
+	PhGraphicBatch::flush();
+	PhFont::flushAll();
 
 	if(timer.elapsed() > _maxPaintDuration)
 		_maxPaintDuration = timer.elapsed();
@@ -145,6 +164,7 @@ void PhGraphicView::paintGL()
 				gInfo.draw();
 				y += gInfo.height();
 			}
+			PhFont::flushAll();
 		}
 	}
 	// Once the informations have been displayed
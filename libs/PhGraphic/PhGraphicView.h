@@ -9,6 +9,7 @@
 
 #include <QGLWidget>
 #include <QTimer>
+#include <QElapsedTimer>
 
 #include "PhSync/PhTime.h"
 #include "PhTools/PhTickCounter.h"
@@ -23,6 +24,13 @@
  * paint them with paint(), and clear them with dispose().
  * These methods are called automatically after the view creation and during all
  * its lifetime.
+ *
+ * The view requests a swap interval of 1 so that the refresh loop is paced
+ * by the vertical blank of the screen: each refresh paints a single frame
+ * and the swap timestamps give the time elapsed between two displayed frames.
+ * The refresh timer runs at twice the screen frequency: it is overdue
+ * when a blocking swap returns and bounds the refresh rate when the swap
+ * does not block.
  */
 class PhGraphicView : public QGLWidget
 {
@@ -80,6 +88,12 @@ signals:
 	 */
 	void beforePaint(PhTimeScale frequency);
 
+	/**
+	 * @brief emit a signal just before the paint with the measured frame duration
+	 * @param elapsed The time elapsed between the two last displayed frames
+	 */
+	void frameElapsed(PhTime elapsed);
+
 	/**
 	 * @brief paint event, every class have to re-implement it.
 	 * @param width Width of the paint area
@@ -109,6 +123,8 @@ private:
 	 * used to draw
 	 */
 	QTimer *_refreshTimer;
+	QElapsedTimer _swapTimer;
+	PhTime _lastSwapTime, _lastPaintSwapTime;
 	PhTickCounter _frameTickCounter;
 	QStringList _infos;
 	PhFont _infoFont;
@@ -0,0 +1,164 @@
+/**
+ * @file
+ * @copyright (C) 2012-2014 Phonations
+ * @license http://www.gnu.org/licenses/gpl.html GPL version 2 or higher
+ */
+
+#include "PhTools/PhDebug.h"
+#include "PhGraphicYUVRect.h"
+
+static const char *yuvVertexShader =
+        "void main()\n"
+        "{\n"
+        "	gl_TexCoord[0] = gl_MultiTexCoord0;\n"
+        "	gl_Position = ftransform();\n"
+        "}\n";
+
+// ITU-R BT.601 limited range conversion, the swscale default
+static const char *yuvFragmentShader =
+        "uniform sampler2D yTexture;\n"
+        "uniform sampler2D uTexture;\n"
+        "uniform sampler2D vTexture;\n"
+        "void main()\n"
+        "{\n"
+        "	float y = 1.164383 * (texture2D(yTexture, gl_TexCoord[0].st).r - 0.0625);\n"
+        "	float u = texture2D(uTexture, gl_TexCoord[0].st).r - 0.5;\n"
+        "	float v = texture2D(vTexture, gl_TexCoord[0].st).r - 0.5;\n"
+        "	gl_FragColor = vec4(y + 1.596027 * v,\n"
+        "	                    y - 0.391762 * u - 0.812968 * v,\n"
+        "	                    y + 2.017232 * u,\n"
+        "	                    1.0);\n"
+        "}\n";
+
+PhGraphicYUVRect::PhGraphicYUVRect(int x, int y, int w, int h)
+	: PhGraphicRect(x, y, w, h),
+	_program(NULL),
+	_bilinearFiltering(true)
+{
+	for(int i = 0; i < 3; i++) {
+		_textures[i] = 0;
+		_planeWidth[i] = 0;
+		_planeHeight[i] = 0;
+	}
+}
+
+PhGraphicYUVRect::~PhGraphicYUVRect()
+{
+	delete _program;
+}
+
+bool PhGraphicYUVRect::init()
+{
+	_glFunctions.initializeGLFunctions(QGLContext::currentContext());
+
+	if(_textures[0] == 0)
+		glGenTextures(3, _textures);
+	if(_textures[0] == 0) {
+		PHDEBUG << "glGenTextures() errored: is opengl context ready?";
+		return false;
+	}
+
+	if(_program == NULL)
+		_program = new QGLShaderProgram();
+	if(!_program->isLinked() && (!_program->addShaderFromSourceCode(QGLShader::Vertex, yuvVertexShader)
+	   || !_program->addShaderFromSourceCode(QGLShader::Fragment, yuvFragmentShader)
+	   || !_program->link())) {
+		PHDEBUG << "Unable to build the YUV shader:" << _program->log();
+		return false;
+	}
+
+	return PhGraphicRect::init();
+}
+
+void PhGraphicYUVRect::uploadPlane(int plane, const uint8_t *data, int width, int height)
+{
+	glBindTexture(GL_TEXTURE_2D, _textures[plane]);
+
+	// The planes are tightly packed and their width are not always a multiple of 4
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	if((width != _planeWidth[plane]) || (height != _planeHeight[plane])) {
+		_planeWidth[plane] = width;
+		_planeHeight[plane] = height;
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_LUMINANCE8, width, height, 0,
+		             GL_LUMINANCE, GL_UNSIGNED_BYTE, data);
+		applyTextureSettings();
+	}
+	else
+		glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width, height, GL_LUMINANCE, GL_UNSIGNED_BYTE, data);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+}
+
+bool PhGraphicYUVRect::createTextureFromYUVPlanes(const uint8_t *y, const uint8_t *u, const uint8_t *v,
+                                                  int width, int height, int chromaWidth, int chromaHeight)
+{
+	if(!this->ready() && !this->init())
+		return false;
+
+	glEnable(GL_TEXTURE_2D);
+	uploadPlane(0, y, width, height);
+	uploadPlane(1, u, chromaWidth, chromaHeight);
+	uploadPlane(2, v, chromaWidth, chromaHeight);
+	glDisable(GL_TEXTURE_2D);
+
+	return true;
+}
+
+void PhGraphicYUVRect::draw()
+{
+	if(!this->ready())
+		return;
+
+	PhGraphicRect::draw();
+
+	for(int i = 2; i >= 0; i--) {
+		_glFunctions.glActiveTexture(GL_TEXTURE0 + i);
+		glBindTexture(GL_TEXTURE_2D, _textures[i]);
+	}
+
+	_program->bind();
+	_program->setUniformValue("yTexture", 0);
+	_program->setUniformValue("uTexture", 1);
+	_program->setUniformValue("vTexture", 2);
+
+	glEnable(GL_TEXTURE_2D);
+
+	glBegin(GL_QUADS);
+	{
+		glTexCoord2f(0, 0);  glVertex3i(this->x(),      this->y(), this->z());
+		glTexCoord2f(1, 0);  glVertex3i(this->x() + this->width(), this->y(), this->z());
+		glTexCoord2f(1, 1);  glVertex3i(this->x() + this->width(), this->y() + this->height(),  this->z());
+		glTexCoord2f(0, 1);  glVertex3i(this->x(),      this->y() + this->height(),  this->z());
+	}
+	glEnd();
+
+	glDisable(GL_TEXTURE_2D);
+
+	_program->release();
+}
+
+void PhGraphicYUVRect::setBilinearFiltering(bool bilinear)
+{
+	_bilinearFiltering = bilinear;
+
+	if(this->ready()) {
+		for(int i = 0; i < 3; i++) {
+			glBindTexture(GL_TEXTURE_2D, _textures[i]);
+			applyTextureSettings();
+		}
+	}
+}
+
+bool PhGraphicYUVRect::bilinearFiltering()
+{
+	return _bilinearFiltering;
+}
+
+void PhGraphicYUVRect::applyTextureSettings()
+{
+	int filterSetting = _bilinearFiltering ? GL_LINEAR : GL_NEAREST;
+
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, filterSetting);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, filterSetting);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+}
@@ -0,0 +1,86 @@
+/**
+ * @file
+ * @copyright (C) 2012-2014 Phonations
+ * @license http://www.gnu.org/licenses/gpl.html GPL version 2 or higher
+ */
+
+#ifndef PHGRAPHICYUVRECT_H
+#define PHGRAPHICYUVRECT_H
+
+#include <QGLFunctions>
+#include <QGLShaderProgram>
+
+#include "PhGraphicRect.h"
+
+/**
+ * @brief Draw a tetragon filled with a planar YUV picture
+ *
+ * The Y, U and V planes are uploaded as three single channel textures
+ * and converted to RGB by a fragment shader at draw time.
+ */
+class PhGraphicYUVRect : public PhGraphicRect
+{
+public:
+	/**
+	 * @brief PhGraphicYUVRect constructor
+	 * @param x Upper left corner coordinate
+	 * @param y Upper left corner coordinate
+	 * @param w Desired width
+	 * @param h Desired heigth
+	 */
+	PhGraphicYUVRect(int x = 0, int y = 0, int w = 0, int h = 0);
+	~PhGraphicYUVRect();
+
+	/**
+	 * @brief draw
+	 * draw the picture converted to RGB
+	 */
+	void draw();
+
+	/**
+	 * @brief Create the textures from tightly packed YUV planes
+	 * @param y The luma plane
+	 * @param u The blue difference chroma plane
+	 * @param v The red difference chroma plane
+	 * @param width The luma plane width
+	 * @param height The luma plane height
+	 * @param chromaWidth The chroma planes width
+	 * @param chromaHeight The chroma planes height
+	 * @return True if succeed, false otherwise
+	 */
+	bool createTextureFromYUVPlanes(const uint8_t *y, const uint8_t *u, const uint8_t *v,
+	                                int width, int height, int chromaWidth, int chromaHeight);
+
+	/**
+	 * @brief Enable or disable the texture bilinear filtering
+	 * Texture bilinear filtering is enabled by default.
+	 * @param bilinear True to enable bilinear filtering
+	 */
+	void setBilinearFiltering(bool bilinear);
+
+	/**
+	 * @brief Retrieve the texture filtering
+	 * @return True if bilinear filtering is enabled
+	 */
+	bool bilinearFiltering();
+
+protected:
+	/**
+	 * @brief Initialize the textures and compile the conversion shader
+	 * @return True if succeed, false otherwise
+	 */
+	bool init();
+
+private:
+	void uploadPlane(int plane, const uint8_t *data, int width, int height);
+	void applyTextureSettings();
+
+	QGLFunctions _glFunctions;
+	QGLShaderProgram *_program;
+	GLuint _textures[3];
+	int _planeWidth[3];
+	int _planeHeight[3];
+	bool _bilinearFiltering;
+};
+
+#endif // PHGRAPHICYUVRECT_H
@@ -13,11 +13,28 @@
 #include "PhGraphic/PhGraphicDisc.h"
 #include "PhGraphic/PhGraphicDashedLine.h"
 #include "PhGraphic/PhGraphicArrow.h"
+#include "PhGraphic/PhGraphicBatch.h"
 #include "PhGraphicStrip.h"
 
 PhGraphicStrip::PhGraphicStrip(PhGraphicStripSettings *settings) :
 	_settings(settings),
-	_maxDrawElapsed(0)
+	_maxDrawElapsed(0),
+	_sceneDirty(true),
+	_sceneContext(NULL),
+	_sceneHeight(0),
+	_sceneTimePerPixel(0),
+	_sceneInvertedColor(false),
+	_sceneDisplayCuts(false),
+	_sceneCutWidth(0),
+	_sceneTextBoldness(0),
+	_sceneTextDistanceField(false),
+	_sceneTextFontGeneration(0),
+	_sceneHudFontGeneration(0),
+	_sceneMaxDuration(0),
+	_sceneMaxNameWidth(0),
+	_sceneDisplayBackground(false),
+	_sceneBackgroundColor(0),
+	_tiles(TILE_CACHE_SIZE)
 {
 	// update the  content when the doc changes :
 	this->connect(&_doc, SIGNAL(changed()), this, SLOT(onDocChanged()));
@@ -27,6 +44,27 @@ PhGraphicStrip::PhGraphicStrip(PhGraphicStripSettings *settings) :
 
 }
 
+PhGraphicStrip::~PhGraphicStrip()
+{
+	// The resources of a destroyed context are already freed with it
+	if(_sceneContextHandle) {
+		QOpenGLContext *currentContext = QOpenGLContext::currentContext();
+		QSurface *currentSurface = currentContext ? currentContext->surface() : NULL;
+		if((currentContext == _sceneContextHandle) || _sceneContextHandle->makeCurrent(_sceneContextHandle->surface())) {
+			foreach(GLuint list, _segmentLists)
+				glDeleteLists(list, 1);
+			_tiles.clear();
+
+			if(currentContext && (currentContext != _sceneContextHandle))
+				currentContext->makeCurrent(currentSurface);
+			else if(currentContext == NULL)
+				_sceneContextHandle->doneCurrent();
+		}
+	}
+	_segmentLists.clear();
+	_tiles.clear();
+}
+
 PhStripDoc *PhGraphicStrip::doc()
 {
 	return &_doc;
@@ -39,7 +77,438 @@ PhClock *PhGraphicStrip::clock()
 
 void PhGraphicStrip::onDocChanged()
 {
+	// The display lists are deleted on the next draw, when the OpenGL context is current
+	_sceneDirty = true;
+
+	// Rasterize the glyphs of the document in advance
+	QString textCharacters;
+	foreach(PhStripText *text, _doc.texts())
+		textCharacters += text->content();
+	foreach(PhStripText *text, _doc.texts(true))
+		textCharacters += text->content();
+	_textFont.prepare(textCharacters);
+
+	QString hudCharacters = "0123456789???";
+	foreach(PhPeople *people, _doc.peoples())
+		hudCharacters += people->name();
+	foreach(PhStripLoop *loop, _doc.loops())
+		hudCharacters += loop->label();
+	_hudFont.prepare(hudCharacters);
+}
+
+qint64 PhGraphicStrip::floorDivide(PhTime time, PhTime duration)
+{
+	if(time >= 0)
+		return time / duration;
+	return -((-time + duration - 1) / duration);
+}
+
+void PhGraphicStrip::updateScene(int height, int timePerPixel, bool invertedColor, QList<PhPeople *> selectedPeoples)
+{
+	const QGLContext *context = QGLContext::currentContext();
+	if(!_sceneDirty
+	   && (context == _sceneContext)
+	   && (height == _sceneHeight)
+	   && (timePerPixel == _sceneTimePerPixel)
+	   && (invertedColor == _sceneInvertedColor)
+	   && (selectedPeoples == _sceneSelectedPeoples)
+	   && (_settings->displayCuts() == _sceneDisplayCuts)
+	   && (_settings->cutWidth() == _sceneCutWidth)
+	   && (_settings->textFontFile() == _sceneTextFontFile)
+	   && (_settings->textBoldness() == _sceneTextBoldness)
+	   && (_settings->textDistanceField() == _sceneTextDistanceField)
+	   && (_textFont.generation() == _sceneTextFontGeneration)
+	   && (_hudFont.generation() == _sceneHudFontGeneration)
+	   && (_settings->hudFontFile() == _sceneHudFontFile)
+	   && (_settings->displayBackground() == _sceneDisplayBackground)
+	   && (backgroundImage(invertedColor)->fileName() == _sceneBackgroundImage)
+	   && (backgroundColor(invertedColor) == _sceneBackgroundColor))
+		return;
+
+	// The tiles are rendered from the segments
+	_tiles.clear();
+
+	// The lists of another context are no longer reachable
+	if(context == _sceneContext) {
+		foreach(GLuint list, _segmentLists)
+			glDeleteLists(list, 1);
+	}
+	_segmentLists.clear();
+
+	_sceneDirty = false;
+	_sceneContext = context;
+	_sceneContextHandle = context ? context->contextHandle() : NULL;
+	_sceneHeight = height;
+	_sceneTimePerPixel = timePerPixel;
+	_sceneInvertedColor = invertedColor;
+	_sceneSelectedPeoples = selectedPeoples;
+	_sceneDisplayCuts = _settings->displayCuts();
+	_sceneCutWidth = _settings->cutWidth();
+	_sceneTextFontFile = _settings->textFontFile();
+	_sceneTextBoldness = _settings->textBoldness();
+	_sceneTextDistanceField = _settings->textDistanceField();
+	_sceneTextFontGeneration = _textFont.generation();
+	_sceneHudFontGeneration = _hudFont.generation();
+	_sceneHudFontFile = _settings->hudFontFile();
+	_sceneDisplayBackground = _settings->displayBackground();
+	_sceneBackgroundImage = backgroundImage(invertedColor)->fileName();
+	_sceneBackgroundColor = backgroundColor(invertedColor);
+
+	// Display the people name only if one of the following condition is true:
+	// - it is the first text of the track
+	// - it is a different people
+	// - the distance between the latest text and the current is superior to a limit
+	int minTimeBetweenPeople = 48000;
+	QMap<float, PhStripText * > lastTextList;
+	_namedTexts.clear();
+	_sceneMaxDuration = 0;
+	foreach(PhStripText * text, _doc.texts()) {
+		PhStripText * lastText = lastTextList.value(text->y(), NULL);
+		if((lastText == NULL)
+		   || (lastText->people() != text->people())
+		   || (text->timeIn() - lastText->timeOut() > minTimeBetweenPeople))
+			_namedTexts.insert(text);
+		lastTextList[text->y()] = text;
+		_sceneMaxDuration = qMax(_sceneMaxDuration, text->timeOut() - text->timeIn());
+	}
+	foreach(PhStripDetect * detect, _doc.detects())
+		_sceneMaxDuration = qMax(_sceneMaxDuration, detect->timeOut() - detect->timeIn());
+
+	_sceneMaxNameWidth = 3 * 12;
+	foreach(PhPeople * people, _doc.peoples()) {
+		if(people)
+			_sceneMaxNameWidth = qMax(_sceneMaxNameWidth, people->name().length() * 12);
+	}
+}
+
+GLuint PhGraphicStrip::segmentList(qint64 segment, int height, int timePerPixel, QList<PhPeople *> selectedPeoples, bool invertedColor)
+{
+	if(_segmentLists.contains(segment))
+		return _segmentLists.value(segment);
+
+	// The objects are drawn relatively to the segment starting time and the top of the strip
+	PhTime segmentDuration = SEGMENT_WIDTH * timePerPixel;
+	PhTime segmentTimeIn = segment * segmentDuration;
+	PhTime segmentTimeOut = segmentTimeIn + segmentDuration - 1;
+	int timeBetweenPeopleAndText = 4000;
+
+	// The glyphs are stored in the font atlas before compiling the list
+	foreach(PhStripText * text, _doc.visibleTexts(segmentTimeIn, segmentTimeOut)) {
+		if(text->timeIn() < segmentTimeIn)
+			continue;
+		_textFont.loadText(text->content());
+		if(_namedTexts.contains(text))
+			_hudFont.loadText(text->people() ? text->people()->name() : "???");
+	}
+	foreach(PhStripLoop * loop, _doc.visibleLoops(segmentTimeIn, segmentTimeOut))
+		_hudFont.loadText(loop->label());
+
+	// Draw the primitives and glyphs queued so far before compiling the list
+	PhGraphicBatch::flush();
+	_textFont.flush();
+	_hudFont.flush();
+
+	GLuint list = glGenLists(1);
+	if(list == 0) {
+		PHDEBUG << "Unable to create a display list";
+		return 0;
+	}
+
+	glNewList(list, GL_COMPILE);
+
+	foreach(PhStripText * text, _doc.visibleTexts(segmentTimeIn, segmentTimeOut)) {
+		if(text->timeIn() < segmentTimeIn)
+			continue;
+
+		PhGraphicText gText(&_textFont, text->content());
+		gText.setX((text->timeIn() - segmentTimeIn) / timePerPixel);
+		gText.setWidth((text->timeOut() - text->timeIn()) / timePerPixel);
+		gText.setY(text->y() * height);
+		gText.setHeight(text->height() * height);
+		gText.setZ(-1);
+		gText.setColor(computeColor(text->people(), selectedPeoples, invertedColor));
+
+		gText.draw();
+
+		if(_namedTexts.contains(text)) {
+			PhPeople * people = text->people();
+			QString name = people ? people->name() : "???";
+			PhGraphicText gPeople(&_hudFont, name);
+			gPeople.setWidth(name.length() * 12);
+			gPeople.setHeight(text->height() * height / 2);
+			gPeople.setX((text->timeIn() - timeBetweenPeopleAndText - segmentTimeIn) / timePerPixel - gPeople.width());
+			gPeople.setY(text->y() * height);
+			gPeople.setZ(-1);
+
+			gPeople.setColor(computeColor(people, selectedPeoples, invertedColor));
+
+			gPeople.draw();
+		}
+	}
+
+	if(_sceneDisplayCuts) {
+		foreach(PhStripCut * cut, _doc.visibleCuts(segmentTimeIn, segmentTimeOut)) {
+			PhGraphicSolidRect gCut;
+			gCut.setZ(-1);
+			gCut.setWidth(_sceneCutWidth);
+
+			if(invertedColor)
+				gCut.setColor(QColor(255, 255, 255));
+			else
+				gCut.setColor(QColor(0, 0, 0));
+			gCut.setHeight(height);
+			gCut.setX((cut->timeIn() - segmentTimeIn) / timePerPixel);
+			gCut.setY(0);
+
+			gCut.draw();
+		}
+	}
+
+	foreach(PhStripLoop * loop, _doc.visibleLoops(segmentTimeIn, segmentTimeOut)) {
+		PhGraphicLoop gLoop;
+		if(!invertedColor)
+			gLoop.setColor(Qt::black);
+		else
+			gLoop.setColor(Qt::white);
+
+		int xLoop = (loop->timeIn() - segmentTimeIn) / timePerPixel;
+		gLoop.setX(xLoop);
+		gLoop.setY(0);
+		gLoop.setZ(-1);
+		gLoop.setThickness(height / 40);
+		gLoop.setHeight(height);
+		gLoop.setCrossSize(height / 4);
+		gLoop.setWidth(height / 4);
+
+		gLoop.draw();
+
+		PhGraphicText gLabel(&_hudFont, loop->label(), xLoop + 10, height * 3 / 4, -1);
+		gLabel.setWidth(_hudFont.getNominalWidth(loop->label()));
+		gLabel.setHeight(height / 4);
+		gLabel.setColor(Qt::gray);
+		gLabel.draw();
+	}
+
+	foreach(PhStripDetect * detect, _doc.visibleDetects(segmentTimeIn, segmentTimeOut)) {
+		if(detect->timeIn() < segmentTimeIn)
+			continue;
+
+		PhGraphicRect *gDetect = NULL;
+		switch (detect->type()) {
+		case PhStripDetect::Off:
+			gDetect = new PhGraphicSolidRect();
+			gDetect->setY(detect->y() * height + detect->height() * height * 0.9);
+			gDetect->setHeight(detect->height() * height / 10);
+			break;
+		case PhStripDetect::SemiOff:
+			gDetect = new PhGraphicDashedLine((detect->timeOut() - detect->timeIn()) / 1200);
+			gDetect->setY(detect->y() * height + detect->height() * height * 0.9);
+			gDetect->setHeight(detect->height() * height / 10);
+			break;
+		case PhStripDetect::ArrowUp:
+			gDetect = new PhGraphicArrow(PhGraphicArrow::DownLeftToUpRight);
+			gDetect->setY(detect->y() * height);
+			gDetect->setHeight(detect->height() * height);
+			break;
+		case PhStripDetect::ArrowDown:
+			gDetect = new PhGraphicArrow(PhGraphicArrow::UpLefToDownRight);
+			gDetect->setY(detect->y() * height);
+			gDetect->setHeight(detect->height() * height);
+			break;
+		default:
+			break;
+		}
+
+		if(gDetect) {
+			gDetect->setColor(computeColor(detect->people(), selectedPeoples, invertedColor));
+
+			gDetect->setX((detect->timeIn() - segmentTimeIn) / timePerPixel);
+			gDetect->setZ(-1);
+			gDetect->setWidth((detect->timeOut() - detect->timeIn()) / timePerPixel);
+			gDetect->draw();
+			delete gDetect;
+		}
+	}
+
+	// The queued primitives and glyphs are compiled into the list too
+	PhGraphicBatch::flush();
+	_textFont.flush();
+	_hudFont.flush();
+
+	glEndList();
+
+	_segmentLists[segment] = list;
+	return list;
+}
+
+PhGraphicImage *PhGraphicStrip::backgroundImage(bool invertedColor)
+{
+	if(invertedColor)
+		return &_backgroundImageDark;
+	return &_backgroundImageLight;
+}
 
+int PhGraphicStrip::backgroundColor(bool invertedColor)
+{
+	if(invertedColor)
+		return _settings->backgroundColorDark();
+	return _settings->backgroundColorLight();
+}
+
+void PhGraphicStrip::drawBackground(int x, int y, int width, int height, long offset, bool invertedColor)
+{
+	if(_settings->displayBackground()) {
+		//Draw backgroung picture
+		int n = width / height + 2; // compute how much background repetition do we need
+		long leftBG = 0;
+		if(offset >= 0)
+			leftBG -= offset % height;
+		else
+			leftBG -= height - ((-offset) % height);
+
+		PhGraphicTexturedRect* image = backgroundImage(invertedColor);
+
+		image->setX(x + leftBG);
+		image->setY(y);
+		image->setSize(height * n, height);
+		image->setZ(-2);
+		image->setTextureCoordinate(n, 1);
+		image->draw();
+	}
+	else {
+		PhGraphicSolidRect backgroundRect(x, y, width, height);
+		backgroundRect.setColor(QColor(backgroundColor(invertedColor)));
+		backgroundRect.setZ(-2);
+		backgroundRect.draw();
+	}
+}
+
+int PhGraphicStrip::drawSegments(int x, int y, int height, long offset, PhTime timeIn, PhTime timeOut, int timePerPixel, QList<PhPeople *> selectedPeoples, bool invertedColor)
+{
+	int counter = 0;
+
+	// Draw the scene segments intersecting the visible range
+	PhTime segmentDuration = SEGMENT_WIDTH * timePerPixel;
+	// An object is stored in the segment of its time in but it can overlap
+	// the following ones (text, detect, loop label) or the previous ones (people name)
+	PhTime lookBehind = _sceneMaxDuration + height * timePerPixel;
+	PhTime lookAhead = 4000 + (_sceneMaxNameWidth + height) * timePerPixel;
+	qint64 firstSegment = floorDivide(timeIn - lookBehind, segmentDuration);
+	qint64 lastSegment = floorDivide(timeOut + lookAhead, segmentDuration);
+	for(qint64 segment = firstSegment; segment <= lastSegment; segment++) {
+		GLuint list = segmentList(segment, height, timePerPixel, selectedPeoples, invertedColor);
+		if(list) {
+			counter++;
+			glPushMatrix();
+			glTranslatef(x + segment * SEGMENT_WIDTH - offset, y, 0);
+			glCallList(list);
+			glPopMatrix();
+		}
+	}
+
+	return counter;
+}
+
+long PhGraphicStrip::tileLeft(qint64 index, int timePerPixel)
+{
+	return floorDivide(index * TILE_DURATION, timePerPixel);
+}
+
+QGLFramebufferObject *PhGraphicStrip::tile(qint64 index, int height, int timePerPixel, QList<PhPeople *> selectedPeoples, bool invertedColor)
+{
+	QGLFramebufferObject *fbo = _tiles.object(index);
+	if(fbo)
+		return fbo;
+
+	long left = tileLeft(index, timePerPixel);
+	int width = tileLeft(index + 1, timePerPixel) - left;
+
+	fbo = new QGLFramebufferObject(width, height, QGLFramebufferObject::Depth);
+	if(!fbo->isValid()) {
+		PHDEBUG << "Unable to create a strip tile" << width << height;
+		delete fbo;
+		return NULL;
+	}
+
+	// Draw the primitives and glyphs queued so far in the current frame buffer
+	PhGraphicBatch::flush();
+	PhFont::flushAll();
+
+	GLint viewport[4];
+	glGetIntegerv(GL_VIEWPORT, viewport);
+	GLfloat clearColor[4];
+	glGetFloatv(GL_COLOR_CLEAR_VALUE, clearColor);
+
+	fbo->bind();
+	glViewport(0, 0, width, height);
+	glMatrixMode(GL_PROJECTION);
+	glPushMatrix();
+	glLoadIdentity();
+	glOrtho(0, width, height, 0, -10, 10);
+	glMatrixMode(GL_MODELVIEW);
+	glPushMatrix();
+	glLoadIdentity();
+
+	glClearColor(0, 0, 0, 0);
+	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+	drawBackground(0, 0, width, height, left, invertedColor);
+	drawSegments(0, 0, height, left, index * TILE_DURATION, (index + 1) * TILE_DURATION, timePerPixel, selectedPeoples, invertedColor);
+	PhGraphicBatch::flush();
+	PhFont::flushAll();
+
+	glMatrixMode(GL_PROJECTION);
+	glPopMatrix();
+	glMatrixMode(GL_MODELVIEW);
+	glPopMatrix();
+	fbo->release();
+
+	glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+	glClearColor(clearColor[0], clearColor[1], clearColor[2], clearColor[3]);
+
+	_tiles.insert(index, fbo);
+	return fbo;
+}
+
+int PhGraphicStrip::drawTiles(int x, int y, int height, long offset, PhTime timeIn, PhTime timeOut, int timePerPixel, QList<PhPeople *> selectedPeoples, bool invertedColor)
+{
+	int counter = 0;
+	qint64 firstTile = floorDivide(timeIn, TILE_DURATION);
+	qint64 lastTile = floorDivide(timeOut, TILE_DURATION);
+
+	for(qint64 index = firstTile; index <= lastTile; index++) {
+		QGLFramebufferObject *fbo = tile(index, height, timePerPixel, selectedPeoples, invertedColor);
+		if(!fbo)
+			continue;
+		counter++;
+
+		int left = x + tileLeft(index, timePerPixel) - offset;
+		int right = x + tileLeft(index + 1, timePerPixel) - offset;
+
+		glColor3f(1, 1, 1);
+		glBindTexture(GL_TEXTURE_2D, fbo->texture());
+		glEnable(GL_TEXTURE_2D);
+
+		// The frame buffer texture origin is the bottom left corner
+		glBegin(GL_QUADS);
+		{
+			glTexCoord2f(0, 1);  glVertex3i(left,  y,          -2);
+			glTexCoord2f(1, 1);  glVertex3i(right, y,          -2);
+			glTexCoord2f(1, 0);  glVertex3i(right, y + height, -2);
+			glTexCoord2f(0, 0);  glVertex3i(left,  y + height, -2);
+		}
+		glEnd();
+
+		glDisable(GL_TEXTURE_2D);
+	}
+
+	// Prepare the next tile in the playing direction, at most one per frame
+	if(_clock.rate() > 0)
+		tile(lastTile + 1, height, timePerPixel, selectedPeoples, invertedColor);
+	else if(_clock.rate() < 0)
+		tile(firstTile - 1, height, timePerPixel, selectedPeoples, invertedColor);
+
+	return counter;
 }
 
 PhFont *PhGraphicStrip::getTextFont()
@@ -95,8 +564,10 @@ void PhGraphicStrip::draw(int x, int y, int width, int height, int tcOffset, QLi
 
 	_textFont.setFontFile(_settings->textFontFile());
 	_textFont.setBoldness(_settings->textBoldness());
+	_textFont.setDistanceField(_settings->textDistanceField());
 
 	_hudFont.setFontFile(_settings->hudFontFile());
+	_hudFont.setDistanceField(_settings->textDistanceField());
 
 	// Just to preload the font in order to avoid font loading during playback
 	_textFont.select();
@@ -125,7 +596,7 @@ void PhGraphicStrip::draw(int x, int y, int width, int height, int tcOffset, QLi
 
 
 		if(_settings->stripTestMode()) {
-			foreach(PhStripCut * cut, _doc.cuts()) {
+			foreach(PhStripCut * cut, _doc.visibleCuts(clockTime, clockTime)) {
 				counter++;
 				if(cut->timeIn() == clockTime) {
 					PhGraphicSolidRect white(x, y, width, height);
@@ -143,35 +614,16 @@ void PhGraphicStrip::draw(int x, int y, int width, int height, int tcOffset, QLi
 		PhTime timeOut = timeIn + stripDuration;
 
 
-		if(_settings->displayBackground()) {
-			//Draw backgroung picture
-			int n = width / height + 2; // compute how much background repetition do we need
-			long leftBG = 0;
-			if(offset >= 0)
-				leftBG -= offset % height;
-			else
-				leftBG -= height - ((-offset) % height);
+		bool tiled = _settings->stripTileCache() && QGLFramebufferObject::hasOpenGLFramebufferObjects();
 
-			PhGraphicTexturedRect* backgroundImage = &_backgroundImageLight;
-			if(invertedColor)
-				backgroundImage = &_backgroundImageDark;
-
-			backgroundImage->setX(x + leftBG);
-			backgroundImage->setY(y);
-			backgroundImage->setSize(height * n, height);
-			backgroundImage->setZ(-2);
-			backgroundImage->setTextureCoordinate(n, 1);
-			backgroundImage->draw();
-		}
-		else {
-			PhGraphicSolidRect backgroundRect(x, y, width, height);
-			if(_settings->invertColor())
-				backgroundRect.setColor(QColor(_settings->backgroundColorDark()));
-			else
-				backgroundRect.setColor(QColor(_settings->backgroundColorLight()));
+		// Rebuild the retained scene if its geometry is no longer valid
+		updateScene(height, timePerPixel, invertedColor, selectedPeoples);
 
-			backgroundRect.setZ(-2);
-			backgroundRect.draw();
+		if(tiled)
+			counter += drawTiles(x, y, height, offset, timeIn, timeOut, timePerPixel, selectedPeoples, invertedColor);
+		else {
+			drawBackground(x, y, width, height, offset, invertedColor);
+			counter += drawSegments(x, y, height, offset, timeIn, timeOut, timePerPixel, selectedPeoples, invertedColor);
 		}
 
 		PhGraphicSolidRect syncBarRect;
@@ -242,223 +694,73 @@ void PhGraphicStrip::draw(int x, int y, int width, int height, int tcOffset, QLi
 			}
 		}
 
-		int minTimeBetweenPeople = 48000;
-		int timeBetweenPeopleAndText = 4000;
-		QMap<float, PhStripText * > lastTextList;
-
-
 		int verticalTimePerPixel = _settings->verticalTimePerPixel();
 		bool displayNextText = _settings->displayNextText();
-		PhTime maxTimeIn = timeOut;
-		if(displayNextText)
-			maxTimeIn += y * verticalTimePerPixel;
 
-		foreach(PhStripText * text, _doc.texts()) {
-
-			if( !((text->timeOut() < timeIn) || (text->timeIn() > timeOut)) ) {
-				counter++;
-				PhGraphicText gText(&_textFont, text->content());
-				gText.setZ(-1);
+		// The vertical prediction depends on the clock: it is drawn every frame
+		if(displayNextText) {
+			PhTime maxTimeIn = timeOut + y * verticalTimePerPixel;
+			foreach(PhStripText * text, _doc.visibleTexts(timeIn, maxTimeIn)) {
+				if(!_namedTexts.contains(text))
+					continue;
 
-				gText.setX(x + text->timeIn() / timePerPixel - offset);
-				gText.setWidth((text->timeOut() - text->timeIn()) / timePerPixel);
-				gText.setY(y + text->y() * height);
-				gText.setHeight(text->height() * height);
-				gText.setZ(-1);
-				gText.setColor(computeColor(text->people(), selectedPeoples, invertedColor));
-
-				gText.draw();
-			}
-
-			PhPeople * people = text->people();
-			QString name = people ? people->name() : "???";
-			PhGraphicText gPeople(&_hudFont, name);
-			gPeople.setWidth(name.length() * 12);
-			gPeople.setHeight(text->height() * height / 2);
-			int x0 = x + (text->timeIn() - timeBetweenPeopleAndText) / timePerPixel - offset - gPeople.width();
-
-			PhStripText * lastText = lastTextList[text->y()];
-			// Display the people name only if one of the following condition is true:
-			// - it is the first text
-			// - it is a different people
-			// - the distance between the latest text and the current is superior to a limit
-			if( x0 < width
-			    && x0 + gPeople.width() > 0
-			    && (
-			        (lastText == NULL)
-			        || (lastText->people() != text->people())
-			        || (text->timeIn() - lastText->timeOut() > minTimeBetweenPeople))
-			    ) {
-
-				gPeople.setX(x0);
-				gPeople.setY(y + text->y() * height);
-				gPeople.setZ(-1);
-
-				gPeople.setColor(computeColor(people, selectedPeoples, invertedColor));
-
-				gPeople.draw();
-			}
-
-			int howFarIsText = (text->timeIn() - clockTime) / verticalTimePerPixel;
-			PhTime timePerPeopleHeight = gPeople.height() * verticalTimePerPixel;
-			int y0 = y - howFarIsText - gPeople.height();
-
-			if(displayNextText
-			   && y0 < y
-			   && y0 > tcOffset
-			   && (timeIn < text->timeIn() + timePerPeopleHeight)
-			   && ((lastText == NULL)
-			       || (lastText->people() != text->people())
-			       || (text->timeIn() - lastText->timeOut() > minTimeBetweenPeople))) {
 				PhPeople * people = text->people();
-
-				//This line is used to see which text's name will be displayed
-				gPeople.setX(width - gPeople.width());
-				gPeople.setY(y0);
-				gPeople.setZ(-3);
+				QString name = people ? people->name() : "???";
+				PhGraphicText gPeople(&_hudFont, name);
+				gPeople.setWidth(name.length() * 12);
 				gPeople.setHeight(text->height() * height / 2);
 
-				gPeople.setColor(computeColor(people, selectedPeoples, invertedColor));
-
-				PhGraphicSolidRect background(gPeople.x(), gPeople.y() - 2, gPeople.width(), gPeople.height() + 3);
-				if(selectedPeoples.size() && !selectedPeoples.contains(people))
-					background.setColor(QColor(90, 90, 90));
-				else
-					background.setColor(QColor(180, 180, 180));
-
-				background.setZ(gPeople.z() - 1);
+				int howFarIsText = (text->timeIn() - clockTime) / verticalTimePerPixel;
+				PhTime timePerPeopleHeight = gPeople.height() * verticalTimePerPixel;
+				int y0 = y - howFarIsText - gPeople.height();
 
-				if(!invertedColor)
-					background.draw();
+				if(y0 < y
+				   && y0 > tcOffset
+				   && (timeIn < text->timeIn() + timePerPeopleHeight)) {
+					//This line is used to see which text's name will be displayed
+					gPeople.setX(width - gPeople.width());
+					gPeople.setY(y0);
+					gPeople.setZ(-3);
 
-				gPeople.draw();
-			}
+					gPeople.setColor(computeColor(people, selectedPeoples, invertedColor));
 
-			lastTextList[text->y()] = text;
+					PhGraphicSolidRect background(gPeople.x(), gPeople.y() - 2, gPeople.width(), gPeople.height() + 3);
+					if(selectedPeoples.size() && !selectedPeoples.contains(people))
+						background.setColor(QColor(90, 90, 90));
+					else
+						background.setColor(QColor(180, 180, 180));
 
-			if(text->timeIn() > maxTimeIn)
-				break;
-		}
+					background.setZ(gPeople.z() - 1);
 
-		if(_settings->displayCuts()) {
-			int cutWidth = _settings->cutWidth();
-			foreach(PhStripCut * cut, _doc.cuts()) {
-				//_counter++;
-				if( (timeIn < cut->timeIn()) && (cut->timeIn() < timeOut)) {
-					PhGraphicSolidRect gCut;
-					gCut.setZ(-1);
-					gCut.setWidth(cutWidth);
-
-					if(invertedColor)
-						gCut.setColor(QColor(255, 255, 255));
-					else
-						gCut.setColor(QColor(0, 0, 0));
-					gCut.setHeight(height);
-					gCut.setX(x + cut->timeIn() / timePerPixel - offset);
-					gCut.setY(y);
+					if(!invertedColor)
+						background.draw();
 
-					gCut.draw();
+					gPeople.draw();
 				}
-				//Doesn't need to process undisplayed content
-				if(cut->timeIn() > timeOut)
-					break;
-			}
-		}
-
-		foreach(PhStripLoop * loop, _doc.loops()) {
-			//_counter++;
-			// This calcul allow the cross to come smoothly on the screen (height * timePerPixel / 8)
-			if( ((loop->timeIn() + height * timePerPixel / 8) > timeIn) && ((loop->timeIn() - height * timePerPixel / 8 ) < timeOut)) {
-				PhGraphicLoop gLoop;
-				if(!invertedColor)
-					gLoop.setColor(Qt::black);
-				else
-					gLoop.setColor(Qt::white);
-
-				int xLoop = x + loop->timeIn() / timePerPixel - offset;
-				gLoop.setX(xLoop);
-				gLoop.setY(y);
-				gLoop.setZ(-1);
-				gLoop.setThickness(height / 40);
-				gLoop.setHeight(height);
-				gLoop.setCrossSize(height / 4);
-				gLoop.setWidth(height / 4);
-
-				gLoop.draw();
-
-				PhGraphicText gLabel(&_hudFont, loop->label(), xLoop + 10, y + height * 3 / 4, -1);
-				gLabel.setWidth(_hudFont.getNominalWidth(loop->label()));
-				gLabel.setHeight(height / 4);
-				gLabel.setColor(Qt::gray);
-				gLabel.draw();
 			}
 
-			if(displayNextText && ((loop->timeIn() + height * timePerPixel / 8) > timeIn)) {
-				PhGraphicLoop gLoopPred;
-
-				int howFarIsLoop = (loop->timeIn() - clockTime) / verticalTimePerPixel;
-				gLoopPred.setColor(Qt::white);
-
-				gLoopPred.setHorizontalLoop(true);
-				gLoopPred.setZ(-3);
-
-				gLoopPred.setX(width - width / 10);
-				gLoopPred.setY(y - howFarIsLoop);
-				gLoopPred.setHeight(30);
-
-				gLoopPred.setThickness(3);
-				gLoopPred.setCrossSize(20);
-				gLoopPred.setWidth(width / 10);
+			PhTime loopMargin = height * timePerPixel / 8;
+			foreach(PhStripLoop * loop, _doc.visibleLoops(timeIn - loopMargin, timeOut + 25 * 30 + loopMargin)) {
+				if((loop->timeIn() + loopMargin) > timeIn) {
+					PhGraphicLoop gLoopPred;
 
-				gLoopPred.draw();
-			}
-			if((loop->timeIn() - height * timePerPixel / 8) > timeOut + 25 * 30)
-				break;
-		}
+					int howFarIsLoop = (loop->timeIn() - clockTime) / verticalTimePerPixel;
+					gLoopPred.setColor(Qt::white);
 
-		foreach(PhStripDetect * detect, _doc.detects()) {
-			//_counter++;
+					gLoopPred.setHorizontalLoop(true);
+					gLoopPred.setZ(-3);
 
-			if((timeIn < detect->timeOut()) && (detect->timeIn() < timeOut) ) {
-				PhGraphicRect *gDetect = NULL;
-				switch (detect->type()) {
-				case PhStripDetect::Off:
-					gDetect = new PhGraphicSolidRect();
-					gDetect->setY(y + detect->y() * height + detect->height() * height * 0.9);
-					gDetect->setHeight(detect->height() * height / 10);
-					break;
-				case PhStripDetect::SemiOff:
-					gDetect = new PhGraphicDashedLine((detect->timeOut() - detect->timeIn()) / 1200);
-					gDetect->setY(y + detect->y() * height + detect->height() * height * 0.9);
-					gDetect->setHeight(detect->height() * height / 10);
-					break;
-				case PhStripDetect::ArrowUp:
-					gDetect = new PhGraphicArrow(PhGraphicArrow::DownLeftToUpRight);
-					gDetect->setY(y + detect->y() * height);
-					gDetect->setHeight(detect->height() * height);
-					break;
-				case PhStripDetect::ArrowDown:
-					gDetect = new PhGraphicArrow(PhGraphicArrow::UpLefToDownRight);
-					gDetect->setY(y + detect->y() * height);
-					gDetect->setHeight(detect->height() * height);
-					break;
-				default:
-					break;
-				}
+					gLoopPred.setX(width - width / 10);
+					gLoopPred.setY(y - howFarIsLoop);
+					gLoopPred.setHeight(30);
 
-				if(gDetect) {
-					gDetect->setColor(computeColor(detect->people(), selectedPeoples, invertedColor));
+					gLoopPred.setThickness(3);
+					gLoopPred.setCrossSize(20);
+					gLoopPred.setWidth(width / 10);
 
-					gDetect->setX(x + detect->timeIn() / timePerPixel - offset);
-					gDetect->setZ(-1);
-					gDetect->setWidth((detect->timeOut() - detect->timeIn()) / timePerPixel);
-					gDetect->draw();
-					delete gDetect;
+					gLoopPred.draw();
 				}
 			}
-			//Doesn't need to process undisplayed content
-			if(detect->timeIn() > timeOut)
-				break;
 		}
 	}
 
@@ -9,6 +9,13 @@
 
 #include <QObject>
 #include <QTime>
+#include <QMap>
+#include <QSet>
+#include <QGLContext>
+#include <QGLFramebufferObject>
+#include <QOpenGLContext>
+#include <QPointer>
+#include <QCache>
 
 #include "PhGraphicStripSettings.h"
 
@@ -45,17 +52,42 @@
  * The portion of strip band scroll smoothly according to the current rate.
  *
  * The font used by the text is customisable.
+ *
+ * The strip objects are compiled once into display lists, one per segment
+ * of SEGMENT_WIDTH pixels, so that each frame only translates and calls the
+ * visible segments. The lists are rebuilt when the document or a setting
+ * affecting the geometry changes.
+ *
+ * For the weak graphic cards, the strip band can also be rendered into
+ * off-screen tiles of TILE_DURATION (see PhGraphicStripSettings::stripTileCache()).
+ * The tiles around the current time are kept in a LRU cache and only
+ * the two or three tiles intersecting the view are composited each frame.
  */
 class PhGraphicStrip : public QObject
 {
 	Q_OBJECT
 public:
+	/** @brief The width of a scene segment in pixel */
+	static const int SEGMENT_WIDTH = 1024;
+	/** @brief The duration of a strip tile (2 seconds) */
+	static const PhTime TILE_DURATION = 48000;
+	/** @brief The maximum number of tile kept in the cache */
+	static const int TILE_CACHE_SIZE = 8;
+
 	/**
 	 * PhGraphicStrip constructor
 	 * @param settings The settings
 	 */
 	explicit PhGraphicStrip(PhGraphicStripSettings * settings);
 
+	/**
+	 * PhGraphicStrip destructor
+	 *
+	 * The display lists and the tiles are freed in the context
+	 * they were created in, if it still exists.
+	 */
+	~PhGraphicStrip();
+
 	/**
 	 * Get the PhStripDoc attached to the .
 	 * @return A PhStripDoc instance.
@@ -159,6 +191,55 @@ private:
 
 	QColor computeColor(PhPeople *people, QList<PhPeople *> selectedPeoples, bool invertColor);
 
+	static qint64 floorDivide(PhTime time, PhTime duration);
+	void updateScene(int height, int timePerPixel, bool invertedColor, QList<PhPeople *> selectedPeoples);
+	GLuint segmentList(qint64 segment, int height, int timePerPixel, QList<PhPeople *> selectedPeoples, bool invertedColor);
+	PhGraphicImage *backgroundImage(bool invertedColor);
+	int backgroundColor(bool invertedColor);
+	void drawBackground(int x, int y, int width, int height, long offset, bool invertedColor);
+	int drawSegments(int x, int y, int height, long offset, PhTime timeIn, PhTime timeOut, int timePerPixel, QList<PhPeople *> selectedPeoples, bool invertedColor);
+	long tileLeft(qint64 index, int timePerPixel);
+	QGLFramebufferObject *tile(qint64 index, int height, int timePerPixel, QList<PhPeople *> selectedPeoples, bool invertedColor);
+	int drawTiles(int x, int y, int height, long offset, PhTime timeIn, PhTime timeOut, int timePerPixel, QList<PhPeople *> selectedPeoples, bool invertedColor);
+
+	/**
+	 * @brief The display list of each segment already built
+	 */
+	QMap<qint64, GLuint> _segmentLists;
+	/**
+	 * @brief The texts preceded by their people name
+	 */
+	QSet<PhStripText *> _namedTexts;
+
+	bool _sceneDirty;
+	const QGLContext *_sceneContext;
+	/**
+	 * @brief The context of the scene, cleared when it is destroyed
+	 */
+	QPointer<QOpenGLContext> _sceneContextHandle;
+	int _sceneHeight;
+	int _sceneTimePerPixel;
+	bool _sceneInvertedColor;
+	QList<PhPeople *> _sceneSelectedPeoples;
+	bool _sceneDisplayCuts;
+	int _sceneCutWidth;
+	QString _sceneTextFontFile;
+	int _sceneTextBoldness;
+	bool _sceneTextDistanceField;
+	int _sceneTextFontGeneration;
+	int _sceneHudFontGeneration;
+	QString _sceneHudFontFile;
+	PhTime _sceneMaxDuration;
+	int _sceneMaxNameWidth;
+	bool _sceneDisplayBackground;
+	QString _sceneBackgroundImage;
+	int _sceneBackgroundColor;
+
+	/**
+	 * @brief The pre-rendered tiles indexed by their time divided by TILE_DURATION
+	 */
+	QCache<qint64, QGLFramebufferObject> _tiles;
+
 	QStringList _infos;
 };
 
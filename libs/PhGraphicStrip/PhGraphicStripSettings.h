@@ -57,6 +57,14 @@ public:
 	 * @return A integer value from 0 to 5
 	 */
 	virtual int textBoldness() = 0;
+	/**
+	 * @brief Render the strip fonts from a signed distance field atlas
+	 *
+	 * The boldness is then applied when drawing and changing it
+	 * does not require to render the font atlas again.
+	 * @return True if the distance field mode is used, false otherwise
+	 */
+	virtual bool textDistanceField() = 0;
 	/**
 	 * @brief Display the strip in test mode
 	 *
@@ -126,6 +134,15 @@ public:
 	 * @return An integer value
 	 */
 	virtual int backgroundColorDark() = 0;
+
+	/**
+	 * @brief Draw the strip from pre-rendered tiles
+	 *
+	 * The strip band is rendered in off-screen textures of a fixed duration
+	 * which are composited every frame instead of drawing each element.
+	 * @return True if the tile cache is used, false otherwise
+	 */
+	virtual bool stripTileCache() = 0;
 };
 
 #endif // PHGRAPHICSTRIPSETTINGS_H
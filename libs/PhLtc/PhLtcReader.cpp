@@ -19,6 +19,7 @@ PhLtcReader::PhLtcReader(PhLtcReaderSettings *settings) :
 {
 #warning /// @todo autodetect tc type
 	_decoder = ltc_decoder_create(1920, 1920 * 2);
+	_clock.setState(&_state);
 	PHDBG(21) << "LTC Reader created";
 }
 
@@ -38,7 +39,9 @@ int PhLtcReader::processAudio(const void *inputBuffer, void *, unsigned long fra
 	LTCFrameExt ltcFrame;
 	unsigned int hhmmssff[4];
 	SMPTETimecode stime;
-	PhTime oldTime = _clock.time();
+	// This is called by the audio callback thread:
+	// the decoded time is only written to the reader state.
+	PhTime oldTime = _state.time();
 	while(ltc_decoder_read(_decoder, &ltcFrame)) {
 		ltc_frame_to_time(&stime, &ltcFrame.ltc, 1);
 		hhmmssff[0] = stime.hours;
@@ -83,21 +86,20 @@ int PhLtcReader::processAudio(const void *inputBuffer, void *, unsigned long fra
 		PhTime newTime = PhTimeCode::timeFromHhMmSsFf(hhmmssff, _tcType);
 		PHDBG(20) << hhmmssff[0] << hhmmssff[1] << hhmmssff[2] << hhmmssff[3];
 
+		PhRate rate = 0;
 		if(newTime > oldTime)
-			_clock.setRate(1);
+			rate = 1;
 		else if(newTime < oldTime )
-			_clock.setRate(-1);
-		else
-			_clock.setRate(0);
-		_clock.setTime(newTime);
+			rate = -1;
+		_state.write(newTime, rate);
 		_noFrameCounter = 0;
 	}
 
 	_position += framesPerBuffer;
 
 	_noFrameCounter++;
-	if(_noFrameCounter > 20)
-		_clock.setRate(0);
+	if((_noFrameCounter > 20) && (_state.rate() != 0))
+		_state.writeRate(0);
 
 	return PhAudioInput::processAudio(inputBuffer, NULL, framesPerBuffer);
 }
@@ -37,10 +37,22 @@ public:
 
 	/**
 	 * @brief Get the reader clock
+	 *
+	 * The clock is slaved to the reader state and is updated by PhClock::sample().
 	 * @return The reader clock
 	 */
 	PhClock * clock();
 
+	/**
+	 * @brief Get the reader state
+	 *
+	 * It is written by the audio callback thread.
+	 * @return The reader state
+	 */
+	const PhClockState *clockState() const {
+		return &_state;
+	}
+
 	/**
 	 * @brief The decoded timecode type by the LTC reader
 	 * @return A timecode type value.
@@ -61,6 +73,7 @@ private:
 	PhLtcReaderSettings * _settings;
 
 	PhTimeCodeType _tcType;
+	PhClockState _state;
 	PhClock _clock;
 	ltc_off_t _position;
 	LTCDecoder * _decoder;
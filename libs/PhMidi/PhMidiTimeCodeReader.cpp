@@ -3,8 +3,6 @@
  * License: http://www.gnu.org/licenses/gpl.html GPL version 2 or higher
  */
 
-#include <QThread>
-
 #include "PhTools/PhDebug.h"
 
 #include "PhMidiTimeCodeReader.h"
@@ -13,18 +11,19 @@ PhMidiTimeCodeReader::PhMidiTimeCodeReader(PhTimeCodeType tcType) :
 	_tcType(tcType),
 	_pauseDetectionCounter(0)
 {
+	_clock.setState(&_state);
 	connect(&_pauseDetectionTimer, &QTimer::timeout, this, &PhMidiTimeCodeReader::checkPause);
 	_pauseDetectionTimer.start(10);
 }
 
 void PhMidiTimeCodeReader::onQuarterFrame(unsigned char data)
 {
-	this->moveToThread(QThread::currentThread());
-	_clock.setRate(1);
-	_clock.tick(4 * PhTimeCode::getFps(_tcType));
+	// This is called by the midi thread:
+	// the decoded time is only written to the reader state.
+	PhTime time = _state.time() + 24000 / (4 * PhTimeCode::getFps(_tcType));
 
 	unsigned int hhmmssff[4];
-	PhTimeCode::ComputeHhMmSsFfFromTime(hhmmssff, _clock.time(), _tcType);
+	PhTimeCode::ComputeHhMmSsFfFromTime(hhmmssff, time, _tcType);
 
 	// We apply correction only on the last sequence message
 	if ((data >> 4) == 7) {
@@ -37,10 +36,12 @@ void PhMidiTimeCodeReader::onQuarterFrame(unsigned char data)
 		   || (hhmmssff[1] != _mm)
 		   || (hhmmssff[0] != _hh)) {
 			PHDEBUG << _hh << _mm << _ss << _ff;
-			_clock.setTime(PhTimeCode::timeFromHhMmSsFf(_hh, _mm, _ss, _ff, _tcType));
+			time = PhTimeCode::timeFromHhMmSsFf(_hh, _mm, _ss, _ff, _tcType);
 		}
 	}
 
+	_state.write(time, 1);
+
 	_pauseDetectionCounter = 0;
 }
 
@@ -48,7 +49,7 @@ void PhMidiTimeCodeReader::onTimeCode(int hh, int mm, int ss, int ff, PhTimeCode
 {
 	PhTime time = PhTimeCode::timeFromHhMmSsFf(hh, mm, ss, ff, tcType);
 	_tcType = tcType;
-	_clock.setTime(time);
+	_state.writeTime(time);
 	emit timeCodeTypeChanged(_tcType);
 }
 
@@ -58,6 +59,6 @@ void PhMidiTimeCodeReader::checkPause()
 	_pauseDetectionCounter++;
 	if(_pauseDetectionCounter >= 4) {
 		PHDEBUG << "Pause detected";
-		_clock.setRate(0);
+		_state.writeRate(0);
 	}
 }
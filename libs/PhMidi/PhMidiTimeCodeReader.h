@@ -41,7 +41,8 @@ public:
 	 * @brief The PhMidiTimeCodeWriter clock
 	 *
 	 * Subscribe to this clock synchronized with the
-	 * incoming midi timecode message.
+	 * incoming midi timecode message. It is slaved to
+	 * the reader state and is updated by PhClock::sample().
 	 *
 	 * @return A clock instance.
 	 */
@@ -49,6 +50,16 @@ public:
 		return &_clock;
 	}
 
+	/**
+	 * @brief The reader state
+	 *
+	 * It is written by the midi thread.
+	 * @return A clock state.
+	 */
+	const PhClockState *clockState() const {
+		return &_state;
+	}
+
 signals:
 	/**
 	 * @brief Signal sent upon a different timecode type message
@@ -65,6 +76,7 @@ private slots:
 
 private:
 	PhTimeCodeType _tcType;
+	PhClockState _state;
 	PhClock _clock;
 	QTimer _pauseDetectionTimer;
 	int _pauseDetectionCounter;
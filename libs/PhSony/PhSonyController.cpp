@@ -80,6 +80,7 @@ void PhSonyController::checkVideoSync(int)
 			if(!_lastCTS && cts) {
 				PHDBG(24);
 				onVideoSync();
+				publishState();
 				emit videoSync();
 			}
 		}
@@ -87,6 +88,7 @@ void PhSonyController::checkVideoSync(int)
 			if(_lastCTS && !cts) {
 				PHDBG(24);
 				onVideoSync();
+				publishState();
 				emit videoSync();
 			}
 		}
@@ -98,6 +100,7 @@ void PhSonyController::run()
 {
 	_threadRunning = true;
 	while(_threadRunning) {
+		applyRequestedRate();
 		this->checkVideoSync(100);
 		if(_serial.waitForReadyRead(10))
 			onData();
@@ -185,6 +188,7 @@ QString PhSonyController::stringFromCommand(unsigned char cmd1, unsigned char cm
 
 void PhSonyController::onData()
 {
+	applyRequestedRate();
 	while(_serial.bytesAvailable()) {
 		//	PHDEBUG << _comSuffix;
 		// reading the cmd1 and cmd2
@@ -231,6 +235,27 @@ void PhSonyController::onData()
 			}
 		}
 	}
+	publishState();
+}
+
+void PhSonyController::publishState()
+{
+	_state.write(_clock.time(), _clock.rate());
+}
+
+void PhSonyController::applyRequestedRate()
+{
+	PhRate rate;
+	if(_state.takeRequestedRate(&rate)) {
+		PHDEBUG << _comSuffix << rate;
+		onRateRequested(rate);
+		publishState();
+	}
+}
+
+void PhSonyController::onRateRequested(PhRate rate)
+{
+	_clock.setRate(rate);
 }
 
 void PhSonyController::handleError(QSerialPort::SerialPortError error)
@@ -88,6 +88,17 @@ public:
 		return &_clock;
 	}
 
+	/**
+	 * @brief Get the state of the internal clock
+	 *
+	 * It is written by the serial port thread after each command
+	 * and video sync, and can be read by any thread (see PhClock::sample()).
+	 * @return A clock state.
+	 */
+	const PhClockState *clockState() const {
+		return &_state;
+	}
+
 	/**
 	 * @brief Compute the rate from the jog, varispeed and shuttle sony protocole
 	 * order data.
@@ -161,6 +172,15 @@ protected:
 	 */
 	virtual void processCommand(unsigned char cmd1, unsigned char cmd2, const unsigned char* dataIn) = 0;
 
+	/**
+	 * @brief Apply a rate requested by the application
+	 *
+	 * It is called in the thread of the controller when the rate of the
+	 * clock slaved to clockState() was changed (see PhClockState::requestRate()).
+	 * @param rate The requested rate
+	 */
+	virtual void onRateRequested(PhRate rate);
+
 	/**
 	 * @brief Extract the data size from the first command descriptor.
 	 * @param cmd1 First command descriptor.
@@ -240,6 +260,12 @@ private:
 	/** @brief Indicate if the thread is currently running */
 	bool _threadRunning;
 
+	/** @brief The internal clock state shared with the other threads. */
+	PhClockState _state;
+
+	void publishState();
+	void applyRequestedRate();
+
 private slots:
 	/** @brief Slot triggered when data are available on the serial port */
 	void onData();
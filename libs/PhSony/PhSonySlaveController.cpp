@@ -284,6 +284,17 @@ void PhSonySlaveController::processCommand(unsigned char cmd1, unsigned char cmd
 //	PHDEBUG << _comSuffix << stringFromCommand(cmd1, cmd2, dataIn) << " over";
 }
 
+void PhSonySlaveController::onRateRequested(PhRate rate)
+{
+	if(rate == 0)
+		_state = Pause;
+	else if(rate == 1)
+		_state = Play;
+	else
+		_state = Varispeed;
+	_clock.setRate(rate);
+}
+
 void PhSonySlaveController::onVideoSync()
 {
 	_clock.tick(PhTimeCode::getFps(_tcType));
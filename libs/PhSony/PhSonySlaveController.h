@@ -72,6 +72,14 @@ protected:
 	 */
 	void processCommand(unsigned char cmd1, unsigned char cmd2, const unsigned char *dataIn);
 
+	/**
+	 * @brief Apply a rate requested by the application
+	 *
+	 * The status sent to the master reflects the new rate.
+	 * @param rate The requested rate
+	 */
+	void onRateRequested(PhRate rate);
+
 private:
 	/**
 	 * @brief Send a command acknolegment.
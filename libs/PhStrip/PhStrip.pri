@@ -23,5 +23,6 @@ HEADERS += \
 	$$TOP_ROOT/libs/PhStrip/PhStripLoop.h \
 	$$TOP_ROOT/libs/PhStrip/PhPeople.h \
     $$TOP_ROOT/libs/PhStrip/PhStripPeopleObject.h \
-    $$TOP_ROOT/libs/PhStrip/PhStripDetect.h
+    $$TOP_ROOT/libs/PhStrip/PhStripDetect.h \
+	$$TOP_ROOT/libs/PhStrip/PhStripRange.h
 
@@ -10,21 +10,31 @@
 #include <QDomNodeList>
 #include <QtXml>
 #include <QXmlStreamWriter>
+#include <QSaveFile>
+#include <QDataStream>
+#include <QtEndian>
 #include <QSqlDatabase>
 #include <QSqlQuery>
 #include <QSqlError>
 
+#include <algorithm>
+#include <cstring>
+
 #include "PhTools/PhDebug.h"
-#include "PhTools/PhFileTool.h"
+#include "PhTools/PhBinaryReader.h"
 
 #include "PhStripDoc.h"
 
-PhStripDoc::PhStripDoc()
+PhStripDoc::PhStripDoc() :
+	_cacheEnabled(false)
 {
 	reset();
 }
 
 
+/** @brief The average size of a DetX body line used to reserve the lists */
+#define PHSTRIPDOC_DETX_LINE_SIZE 512
+
 bool PhStripDoc::importDetXFile(QString fileName)
 {
 	PHDEBUG << fileName;
@@ -42,208 +52,247 @@ bool PhStripDoc::importDetXFile(QString fileName)
 		return false;
 	}
 
-	// Loading the DOM (document object model)
-	QDomDocument *domDoc = new QDomDocument();
-	if (!domDoc->setContent(&xmlFile)) {
-		xmlFile.close();
-		PHDEBUG << "The XML document seems to be bad formed " << fileName;
+	// The document is read in a single pass without loading the DOM
+	QXmlStreamReader xml(&xmlFile);
+	if(!xml.readNextStartElement()) {
+		PHDEBUG << "The XML document seems to be bad formed " << fileName << xml.errorString();
 		return false;
 	}
 
-	reset();
-
-	QDomElement detX = domDoc->documentElement();
-
-	if(detX.tagName() != "detx") {
-		xmlFile.close();
-		PHDEBUG << "Bad root element :" << detX.tagName();
+	if(xml.name() != "detx") {
+		PHDEBUG << "Bad root element :" << xml.name();
 		return false;
 	}
 
+	reset();
+
 	_generator = "Cappella";
 	//With DetX files, fps is always 25 no drop
 	PhTimeCodeType tcType = PhTimeCodeType25;
 
-	// Reading the header
-	if(detX.elementsByTagName("header").count()) {
-		QDomElement header = detX.elementsByTagName("header").at(0).toElement();
+	// The body lines make most of the file
+	int lineCount = xmlFile.size() / PHSTRIPDOC_DETX_LINE_SIZE;
+	_texts1.reserve(lineCount);
+	_detects.reserve(lineCount);
 
-		// Read the Cappella version
-		if(header.elementsByTagName("cappella").count())
-			_generator += " v" + detX.elementsByTagName("cappella").at(0).toElement().attribute("version");
+	QMap<QString, PhPeople*> peopleMap;
+	// The objects read before the declaration of their role
+	QMultiMap<QString, PhStripPeopleObject*> pendingRoles;
+	int loopNumber = 1;
 
-		// Reading the title
-		if(header.elementsByTagName("title").count())
-			_title = header.elementsByTagName("title").at(0).toElement().text();
+	while(xml.readNextStartElement()) {
+		// Reading the header
+		if(xml.name() == "header")
+			readDetXHeader(xml, tcType);
+		// Reading the "role" lists
+		else if(xml.name() == "roles") {
+			while(xml.readNextStartElement()) {
+				if(xml.name() == "role") {
+					QXmlStreamAttributes attributes = xml.attributes();
+					PhPeople *people = new PhPeople(attributes.value("name").toString(), attributes.value("color").toString());
+
+					//Currently using id as key instead of name
+					peopleMap[attributes.value("id").toString()] = people;
+					_peoples.append(people);
+				}
+				xml.skipCurrentElement();
+			}
+		}
+		// Reading the strip body
+		else if(xml.name() == "body") {
+			while(xml.readNextStartElement()) {
+				PhTime timeIn = PhTimeCode::timeFromString(xml.attributes().value("timecode").toString(), tcType);
+				// Reading loops
+				if(xml.name() == "loop") {
+					_loops.append(new PhStripLoop(timeIn, QString::number(loopNumber++)));
+					xml.skipCurrentElement();
+				}
+				// Reading cuts
+				else if(xml.name() == "shot") {
+					_cuts.append(new PhStripCut(timeIn, PhStripCut::Simple));
+					xml.skipCurrentElement();
+				}
+				else if(xml.name() == "line")
+					readDetXLine(xml, tcType, peopleMap, pendingRoles);
+				else
+					xml.skipCurrentElement();
+			}
+		}
 		else
-			_title = QFileInfo(fileName).baseName();
+			xml.skipCurrentElement();
+	}
 
-		// Reading the translated title
-		if(header.elementsByTagName("title2").count())
-			_translatedTitle = header.elementsByTagName("title2").at(0).toElement().text();
+	if(xml.hasError()) {
+		PHDEBUG << "The XML document seems to be bad formed " << fileName << xml.errorString() << "at line" << xml.lineNumber();
+		reset();
+		return false;
+	}
+
+	// The roles may be declared after the body
+	for(QMultiMap<QString, PhStripPeopleObject*>::const_iterator it = pendingRoles.constBegin(); it != pendingRoles.constEnd(); ++it)
+		it.value()->setPeople(peopleMap.value(it.key()));
+
+	buildIndex();
+
+	emit this->changed();
 
+	return true;
+}
+
+void PhStripDoc::readDetXHeader(QXmlStreamReader &xml, PhTimeCodeType tcType)
+{
+	bool hasTitle = false;
+	while(xml.readNextStartElement()) {
+		QXmlStreamAttributes attributes = xml.attributes();
+		// Read the Cappella version
+		if(xml.name() == "cappella") {
+			_generator += " v" + attributes.value("version").toString();
+			xml.skipCurrentElement();
+		}
+		// Reading the title
+		else if(xml.name() == "title") {
+			_title = xml.readElementText(QXmlStreamReader::IncludeChildElements);
+			hasTitle = true;
+		}
+		// Reading the translated title
+		else if(xml.name() == "title2")
+			_translatedTitle = xml.readElementText(QXmlStreamReader::IncludeChildElements);
 		// Reading the episode info
-		if(header.elementsByTagName("episode").count()) {
-			QDomElement episodeElem = header.elementsByTagName("episode").at(0).toElement();
-			_episode = episodeElem.attribute("number");
-			_season = episodeElem.attribute("season");
+		else if(xml.name() == "episode") {
+			_episode = attributes.value("number").toString();
+			_season = attributes.value("season").toString();
+			xml.skipCurrentElement();
 		}
-
 		// Reading the video path
-		if(header.elementsByTagName("videofile").count()) {
-			QDomElement videoFile = header.elementsByTagName("videofile").at(0).toElement();
-			_videoPath = videoFile.text();
+		else if(xml.name() == "videofile") {
+			_videoPath = xml.readElementText(QXmlStreamReader::IncludeChildElements);
 			// Reading the video time in
-			_videoTimeIn = PhTimeCode::timeFromString(videoFile.attribute("timestamp"), tcType);
+			_videoTimeIn = PhTimeCode::timeFromString(attributes.value("timestamp").toString(), tcType);
 			_videoTimeCodeType = tcType;
 		}
-
 		// Reading the last position
-		if(header.elementsByTagName("last_position").count()) {
-			QDomElement lastPosition = header.elementsByTagName("last_position").at(0).toElement();
-			_lastTime = PhTimeCode::timeFromString(lastPosition.attribute("timecode"), tcType);
+		else if(xml.name() == "last_position") {
+			_lastTime = PhTimeCode::timeFromString(attributes.value("timecode").toString(), tcType);
+			xml.skipCurrentElement();
 		}
-
 		// Reading the author name
-		if(header.elementsByTagName("author").count()) {
-			QDomElement author = header.elementsByTagName("author").at(0).toElement();
-			_authorName = author.attribute("firstname") + " " + author.attribute("name");
+		else if(xml.name() == "author") {
+			_authorName = attributes.value("firstname").toString() + " " + attributes.value("name").toString();
+			xml.skipCurrentElement();
 		}
-
 		// Reading other meta informations
-		if(header.elementsByTagName("production").count()) {
-			QDomElement production = header.elementsByTagName("production").at(0).toElement();
-			_metaInformation["Producteur"] = production.attribute("producer");
-			_metaInformation["Année de production"] = production.attribute("year");
-			_metaInformation["Distributeur"] = production.attribute("distributor");
-			_metaInformation["Réalisateur"] = production.attribute("director");
-			_metaInformation["Diffuseur"] = production.attribute("diffuser");
-			_metaInformation["Pays d'origine"] = production.attribute("country");
-		}
-	}
-
-	QMap<QString, PhPeople*> peopleMap;
-
-	// Reading the "role" lists
-	if(detX.elementsByTagName("roles").count()) {
-		QDomElement roles = detX.elementsByTagName("roles").at(0).toElement();
-		QDomNodeList roleList = roles.elementsByTagName("role");
-		for (int i = 0; i < roleList.length(); i++) {
-			QDomElement role = roleList.at(i).toElement();
-			PhPeople *people = new PhPeople(role.attribute("name"), role.attribute("color"));
-
-			//Currently using id as key instead of name
-			peopleMap[role.attribute("id")] = people;
-			_peoples.append(people);
+		else if(xml.name() == "production") {
+			_metaInformation["Producteur"] = attributes.value("producer").toString();
+			_metaInformation["Année de production"] = attributes.value("year").toString();
+			_metaInformation["Distributeur"] = attributes.value("distributor").toString();
+			_metaInformation["Réalisateur"] = attributes.value("director").toString();
+			_metaInformation["Diffuseur"] = attributes.value("diffuser").toString();
+			_metaInformation["Pays d'origine"] = attributes.value("country").toString();
+			xml.skipCurrentElement();
 		}
+		else
+			xml.skipCurrentElement();
 	}
 
-	int loopNumber = 1;
+	if(!hasTitle)
+		_title = QFileInfo(_filePath).baseName();
+}
 
-	// Reading the strip body
-	if(detX.elementsByTagName("body").count()) {
-		QDomElement body = detX.elementsByTagName("body").at(0).toElement();
-		for(int i = 0; i < body.childNodes().length(); i++) {
-			if(body.childNodes().at(i).isElement()) {
-				QDomElement elem = body.childNodes().at(i).toElement();
+void PhStripDoc::readDetXLine(QXmlStreamReader &xml, PhTimeCodeType tcType, const QMap<QString, PhPeople *> &peopleMap, QMultiMap<QString, PhStripPeopleObject *> &pendingRoles)
+{
+	QXmlStreamAttributes attributes = xml.attributes();
+	PhTime timeIn = -1;
+	PhTime lastTime = -1;
+	PhTime lastLinkedTime = -1;
+	QString role = attributes.value("role").toString();
+	PhPeople *people = peopleMap.value(role);
+	bool pending = (people == NULL) && !role.isEmpty();
+	int firstText = _texts1.count();
+	float y = attributes.value("track").toInt() / 4.0;
+	PhStripDetect::PhDetectType type = PhStripDetect::On;
+	if(attributes.value("voice") == "off")
+		type = PhStripDetect::Off;
 
-				PhTime timeIn = PhTimeCode::timeFromString(elem.attribute("timecode"), tcType);
-				// Reading loops
-				if(elem.tagName() == "loop")
-					_loops.append(new PhStripLoop(timeIn, QString::number(loopNumber++)));
-				// Reading cuts
-				else if(elem.tagName() == "shot")
-					_cuts.append(new PhStripCut(timeIn, PhStripCut::Simple));
-				else if(elem.tagName() == "line") {
-					timeIn = -1;
-					PhTime lastTime = -1;
-					PhTime lastLinkedTime = -1;
-					PhPeople *people = peopleMap[elem.attribute("role")];
-					float y = elem.attribute("track").toInt() / 4.0;
-					QString currentText = "";
-					for(int j = 0; j < elem.childNodes().length(); j++) {
-						if(elem.childNodes().at(j).isElement()) {
-							QDomElement lineElem = elem.childNodes().at(j).toElement();
-							if(lineElem.tagName() == "lipsync") {
-								lastTime = PhTimeCode::timeFromString(lineElem.attribute("timecode"), tcType);
-								if(timeIn < 0)
-									timeIn = lastTime;
-								if(lineElem.attribute("link") != "off") {
-									if(currentText.length()) {
-										_texts1.append(new PhStripText(lastLinkedTime, people, lastTime, y, currentText, 0.25f));
-										currentText = "";
-									}
-									lastLinkedTime = lastTime;
-								}
-							}
-							else if(lineElem.tagName() == "text")
-								currentText += lineElem.text();
-						}
-					}
-					// Handling line with no lipsync out
-					if(currentText.length()) {
-						PhTime time = lastLinkedTime + currentText.length() * 1000;
-						PHDEBUG << currentText;
-						_texts1.append(new PhStripText(lastLinkedTime, people, time, y, currentText, 0.25f));
-						lastTime = lastLinkedTime = time;
-					}
-					PhStripDetect::PhDetectType type = PhStripDetect::On;
-					if(elem.attribute("voice") == "off")
-						type = PhStripDetect::Off;
-					_detects.append(new PhStripDetect(type, timeIn, people, lastTime, y));
+	QString currentText = "";
+	while(xml.readNextStartElement()) {
+		if(xml.name() == "lipsync") {
+			QXmlStreamAttributes lipsyncAttributes = xml.attributes();
+			lastTime = PhTimeCode::timeFromString(lipsyncAttributes.value("timecode").toString(), tcType);
+			if(timeIn < 0)
+				timeIn = lastTime;
+			if(lipsyncAttributes.value("link") != "off") {
+				if(currentText.length()) {
+					_texts1.append(new PhStripText(lastLinkedTime, people, lastTime, y, currentText, 0.25f));
+					currentText = "";
 				}
+				lastLinkedTime = lastTime;
 			}
+			xml.skipCurrentElement();
 		}
+		else if(xml.name() == "text")
+			currentText += xml.readElementText(QXmlStreamReader::IncludeChildElements);
+		else
+			xml.skipCurrentElement();
 	}
 
-	emit this->changed();
+	// Handling line with no lipsync out
+	if(currentText.length()) {
+		PhTime time = lastLinkedTime + currentText.length() * 1000;
+		PHDEBUG << currentText;
+		_texts1.append(new PhStripText(lastLinkedTime, people, time, y, currentText, 0.25f));
+		lastTime = lastLinkedTime = time;
+	}
+	_detects.append(new PhStripDetect(type, timeIn, people, lastTime, y));
 
-	return true;
+	// Resolved once the whole file is read
+	if(pending) {
+		for(int i = firstText; i < _texts1.count(); i++)
+			pendingRoles.insert(role, _texts1[i]);
+		pendingRoles.insert(role, _detects.last());
+	}
 }
 
-bool PhStripDoc::checkMosTag2(QFile &f, int level, QString expected)
+bool PhStripDoc::checkMosTag2(PhBinaryReader &reader, int level, const char *expected)
 {
-	QString name = PhFileTool::readString(f, level, expected);
+	QString name = reader.readString(level, expected);
 	if(name != expected) {
 		PHDEBUG << "!!!!!!!!!!!!!!!" << "Error reading " << expected << "!!!!!!!!!!!!!!!";
-		f.close();
 		return false;
 	}
 	return true;
 }
 
-bool PhStripDoc::checkMosTag(QFile &f, int level, MosTag expectedTag)
+bool PhStripDoc::checkMosTag(PhBinaryReader &reader, int level, MosTag expectedTag)
 {
-	MosTag tag = readMosTag(f, level, "checkMosTag");
+	MosTag tag = readMosTag(reader, level, "checkMosTag");
 
 	if(tag != expectedTag) {
 		PHDEBUG << "!!!!!!!!!!!!!!!" << "Error reading " << tag << "instead of" << expectedTag << "!!!!!!!!!!!!!!!";
-		f.close();
 		return false;
 	}
 	return true;
 }
 
-PhTime PhStripDoc::readMosTime(QFile &f, PhTimeCodeType tcType, int level)
+PhTime PhStripDoc::readMosTime(PhBinaryReader &reader, PhTimeCodeType tcType, int level)
 {
-	return PhFileTool::readInt(f, level, "time") * PhTimeCode::timePerFrame(tcType) / 12;
+	return reader.readInt(level, "time") * PhTimeCode::timePerFrame(tcType) / 12;
 }
 
-PhStripText* PhStripDoc::readMosText(QFile &f, PhTimeCodeType tcType, int textLevel, int internLevel)
+PhStripText* PhStripDoc::readMosText(PhBinaryReader &reader, PhTimeCodeType tcType, int textLevel, int internLevel)
 {
-	QString content = PhFileTool::readString(f, 2, "content");
+	QString content = reader.readString(2, "content");
 
-	PhTime timeIn = _videoTimeIn + readMosTime(f, tcType, internLevel);;
-	PhTime timeOut = _videoTimeIn + readMosTime(f, tcType, internLevel);;
+	PhTime timeIn = _videoTimeIn + readMosTime(reader, tcType, internLevel);;
+	PhTime timeOut = _videoTimeIn + readMosTime(reader, tcType, internLevel);;
 
 	PhStripText* text = new PhStripText(timeIn, NULL, timeOut, 0, content, 0.2f);
 
-	PhFileTool::readInt(f, internLevel, "text");
-	PhFileTool::readInt(f, internLevel, "text");
-	PhFileTool::readInt(f, internLevel, "text");
-	PhFileTool::readInt(f, internLevel, "text");
-	PhFileTool::readInt(f, internLevel, "text");
-	PhFileTool::readInt(f, internLevel, "text");
+	reader.readInt(internLevel, "text");
+	reader.readInt(internLevel, "text");
+	reader.readInt(internLevel, "text");
+	reader.readInt(internLevel, "text");
+	reader.readInt(internLevel, "text");
+	reader.readInt(internLevel, "text");
 
 	PHDBG(textLevel) << PHNQ(PhTimeCode::stringFromTime(timeIn, tcType))
 	                 << "->"
@@ -252,13 +301,13 @@ PhStripText* PhStripDoc::readMosText(QFile &f, PhTimeCodeType tcType, int textLe
 	return text;
 }
 
-PhStripDetect *PhStripDoc::readMosDetect(QFile &f, PhTimeCodeType tcType, int detectLevel, int internLevel)
+PhStripDetect *PhStripDoc::readMosDetect(PhBinaryReader &reader, PhTimeCodeType tcType, int detectLevel, int internLevel)
 {
-	PhTime timeIn = _videoTimeIn + readMosTime(f, tcType, internLevel);;
-	PhTime timeOut = _videoTimeIn + readMosTime(f, tcType, internLevel);;
-	PhFileTool::readInt(f, internLevel, "detect type 1");
-	int detectType2 = PhFileTool::readInt(f, internLevel, "detect type 2");
-	int detectType3 = PhFileTool::readInt(f, internLevel, "detect type 3");
+	PhTime timeIn = _videoTimeIn + readMosTime(reader, tcType, internLevel);;
+	PhTime timeOut = _videoTimeIn + readMosTime(reader, tcType, internLevel);;
+	reader.readInt(internLevel, "detect type 1");
+	int detectType2 = reader.readInt(internLevel, "detect type 2");
+	int detectType3 = reader.readInt(internLevel, "detect type 3");
 	PhStripDetect::PhDetectType type = PhStripDetect::Unknown;
 	switch(detectType3) {
 	case 9:
@@ -313,7 +362,7 @@ PhStripDetect *PhStripDoc::readMosDetect(QFile &f, PhTimeCodeType tcType, int de
 	}
 
 	for(int j = 0; j < 6; j++)
-		PhFileTool::readShort(f, internLevel);
+		reader.readShort(internLevel);
 	PHDBG(detectLevel) << "detect: "
 	                   << PhTimeCode::stringFromTime(timeIn, tcType)
 	                   << PhTimeCode::stringFromTime(timeOut, tcType)
@@ -326,11 +375,11 @@ PhStripDetect *PhStripDoc::readMosDetect(QFile &f, PhTimeCodeType tcType, int de
 	return new PhStripDetect(type, timeIn, NULL, timeOut, 0);
 }
 
-bool PhStripDoc::readMosProperties(QFile &f, int level)
+bool PhStripDoc::readMosProperties(PhBinaryReader &reader, int level)
 {
-	QString originalTitle = PhFileTool::readString(f, level, "Titre de la versio originale");
+	QString originalTitle = reader.readString(level, "Titre de la versio originale");
 
-	QString translatedTitle = PhFileTool::readString(f, level, "Titre de la version adaptée");
+	QString translatedTitle = reader.readString(level, "Titre de la version adaptée");
 
 	_metaInformation["Titre de la version originale"] = originalTitle;
 	_metaInformation["Titre de la version adaptée"] = translatedTitle;
@@ -340,31 +389,31 @@ bool PhStripDoc::readMosProperties(QFile &f, int level)
 	else if(translatedTitle.length())
 		_title = translatedTitle;
 
-	_season = PhFileTool::readString(f, level, "Saison");
-	_episode = PhFileTool::readString(f, level, "Episode/bobine");
-	PhFileTool::readString(f, level, "Titre vo episode");
-	PhFileTool::readString(f, level, "Titre adapté de l'épisode");
-	PhFileTool::readString(f, level, "Durée");
-	PhFileTool::readString(f, level, "Date");
-	PhFileTool::readString(f, level, "Client");
-	PhFileTool::readString(f, level, "Commentaires");
-	PhFileTool::readString(f, level, "Détecteur");
-	_authorName = PhFileTool::readString(f, level, "Auteur");
-	PhFileTool::readString(f, level, "Studio");
-	PhFileTool::readString(f, level, "D.A.");
-	PhFileTool::readString(f, level, "Ingénieur du son");
+	_season = reader.readString(level, "Saison");
+	_episode = reader.readString(level, "Episode/bobine");
+	reader.readString(level, "Titre vo episode");
+	reader.readString(level, "Titre adapté de l'épisode");
+	reader.readString(level, "Durée");
+	reader.readString(level, "Date");
+	reader.readString(level, "Client");
+	reader.readString(level, "Commentaires");
+	reader.readString(level, "Détecteur");
+	_authorName = reader.readString(level, "Auteur");
+	reader.readString(level, "Studio");
+	reader.readString(level, "D.A.");
+	reader.readString(level, "Ingénieur du son");
 
 	return true;
 }
 
-PhStripDoc::MosTag PhStripDoc::readMosTag(QFile &f, int level, QString name)
+PhStripDoc::MosTag PhStripDoc::readMosTag(PhBinaryReader &reader, int level, const char *name)
 {
-	unsigned short tag = PhFileTool::readShort(f, level, name);
+	unsigned short tag = reader.readShort(level, name);
 	if(tag != 0xffff)
 		return _mosTagMap[tag];
 
-	PhFileTool::readShort(f, level, name);
-	QString stringTag = PhFileTool::readString(f, level, name);
+	reader.readShort(level, name);
+	QString stringTag = reader.readString(level, name);
 
 	if(stringTag == "CDocDoublage")
 		return _mosTagMap[_mosNextTag++] = MosDub;
@@ -398,78 +447,96 @@ PhStripDoc::MosTag PhStripDoc::readMosTag(QFile &f, int level, QString name)
 		return _mosTagMap[_mosNextTag++] = MosBin;
 	else {
 		PHDEBUG << "!!!!!!!!!!!!!!! Unknown tag:" << stringTag << "!!!!!!!!!!!!!!!";
-		f.close();
 		return MosUnknown;
 	}
 }
 
-bool PhStripDoc::readMosTrack(QFile &f, PhTimeCodeType tcType, QMap<int, PhPeople *> peopleMap, QMap<int, int> peopleTrackMap, int blocLevel, int textLevel, int detectLevel, int labelLevel, int level, int internLevel)
+bool PhStripDoc::readMosTrack(PhBinaryReader &reader, PhTimeCodeType tcType, QMap<int, PhPeople *> peopleMap, QMap<int, int> peopleTrackMap, int blocLevel, int textLevel, int detectLevel, int labelLevel, int level, int internLevel)
 {
 	QList<PhStripDetect*> detectList;
 	QList<PhStripText*> textList1, textList2;
-	int detectCount = PhFileTool::readInt(f, detectLevel, "track CDocBlocDetection count");
+	// The objects read before a failure are not added to the document
+	auto fail = [&]() {
+		qDeleteAll(detectList);
+		qDeleteAll(textList1);
+		qDeleteAll(textList2);
+		return false;
+	};
+	int detectCount = reader.readInt(detectLevel, "track CDocBlocDetection count");
 
 	if(detectCount) {
-		if(!checkMosTag(f, blocLevel, MosDetect))
-			return false;
+		if(!checkMosTag(reader, blocLevel, MosDetect))
+			return fail();
 
 		for(int i = 0; i < detectCount; i++) {
+			if(reader.error())
+				return fail();
 			if(i > 0)
-				PhFileTool::readShort(f, level, "detect tag");
-			detectList.append(readMosDetect(f, tcType, detectLevel, internLevel));
+				reader.readShort(level, "detect tag");
+			detectList.append(readMosDetect(reader, tcType, detectLevel, internLevel));
 		}
 	}
 
-	int langCount = PhFileTool::readInt(f, blocLevel, "track CDocLangue count");
+	int langCount = reader.readInt(blocLevel, "track CDocLangue count");
 	if(langCount) {
-		if(!checkMosTag(f, blocLevel, MosLang))
-			return false;
+		if(!checkMosTag(reader, blocLevel, MosLang))
+			return fail();
 	}
 
-	int textCount = PhFileTool::readInt(f, blocLevel, "track CDocBlocTexte count");
+	int textCount = reader.readInt(blocLevel, "track CDocBlocTexte count");
 	if(textCount) {
-		if(!checkMosTag(f, blocLevel, MosText))
-			return false;
+		if(!checkMosTag(reader, blocLevel, MosText))
+			return fail();
 
 		for(int i = 0; i < textCount; i++) {
+			if(reader.error())
+				return fail();
 			if(i > 0)
-				PhFileTool::readShort(f, level, "text tag");
-			textList1.append(readMosText(f, tcType, textLevel, internLevel));
+				reader.readShort(level, "text tag");
+			textList1.append(readMosText(reader, tcType, textLevel, internLevel));
 		}
 	}
 
-	int peopleId = PhFileTool::readInt(f, level, "people id");
+	int peopleId = reader.readInt(level, "people id");
 
 	for(int k = 0; k < 2; k++) {
-		int count = PhFileTool::readInt(f, level, "track other count");
+		int count = reader.readInt(level, "track other count");
+		if(reader.error())
+			return fail();
 		if(count == 0)
 			continue;
-		MosTag tag = readMosTag(f, level, "track other tag");
+		MosTag tag = readMosTag(reader, level, "track other tag");
 		switch(tag) {
 		case MosText:
 			for(int i = 0; i < count; i++) {
+				if(reader.error())
+					return fail();
 				if(i > 0)
-					PhFileTool::readShort(f, level, "text tag");
-				textList2.append(readMosText(f, tcType, textLevel, internLevel));
+					reader.readShort(level, "text tag");
+				textList2.append(readMosText(reader, tcType, textLevel, internLevel));
 			}
 			break;
 		case MosLabel:
 			for(int i = 0; i < count; i++) {
+				if(reader.error())
+					return fail();
 				if(i > 0)
-					PhFileTool::readShort(f, level, "label tag");
-				PhTime labelTime = _videoTimeIn + readMosTime(f, tcType, internLevel);
+					reader.readShort(level, "label tag");
+				PhTime labelTime = _videoTimeIn + readMosTime(reader, tcType, internLevel);
 				for(int j = 0; j < 6; j++)
-					PhFileTool::readShort(f, internLevel);
+					reader.readShort(internLevel);
 				PHDBG(labelLevel) << "label" << PhTimeCode::stringFromTime(labelTime, tcType);
 			}
 			break;
 		default:
 			PHDEBUG << "!!!!!!!!!!!!!!! Unknown tag:" << PHNQ(QString::number(tag, 16)) << "!!!!!!!!!!!!!!!";
-			f.close();
-			return false;
+			return fail();
 		}
 	}
 
+	if(reader.error())
+		return fail();
+
 	PhPeople *people = peopleMap[peopleId];
 	int track = peopleTrackMap[peopleId];
 
@@ -510,13 +577,13 @@ bool PhStripDoc::importMosFile(const QString &fileName)
 {
 	PHDEBUG << "===============" << fileName << "===============";
 
-	QFile f(fileName);
-	if(!f.exists()) {
+	if(!QFile::exists(fileName)) {
 		PHDEBUG << "File doesn't exists : " << fileName;
 		return false;
 	}
 
-	if(!f.open(QFile::ReadOnly)) {
+	PhBinaryReader reader;
+	if(!reader.open(fileName)) {
 		PHDEBUG << "Unable to open : " << fileName;
 		return false;
 	}
@@ -526,6 +593,32 @@ bool PhStripDoc::importMosFile(const QString &fileName)
 	_filePath = fileName;
 	_title = QFileInfo(fileName).baseName();
 
+	// The document is left empty if the file cannot be read completely
+	if(!readMosFile(reader)) {
+		PHDEBUG << "Unable to read" << fileName;
+		this->reset();
+		return false;
+	}
+
+	PHDEBUG << "_______________" << "reading ok" << "_______________";
+
+	reader.close();
+
+	if((_texts1.count() == 0) && (_texts2.count())) {
+		PHDEBUG << "Switching primary and secondary text lists";
+		_texts1.append(_texts2);
+		_texts2.clear();
+	}
+
+	buildIndex();
+
+	emit this->changed();
+
+	return true;
+}
+
+bool PhStripDoc::readMosFile(PhBinaryReader &reader)
+{
 	int level = 1;
 	int ok = 0;
 	int propLevel = ok;
@@ -538,43 +631,45 @@ bool PhStripDoc::importMosFile(const QString &fileName)
 	int labelLevel = level;
 	int internLevel = 2;
 
-	if(!checkMosTag2(f, blocLevel, "NOBLURMOSAIC"))
+	if(!checkMosTag2(reader, blocLevel, "NOBLURMOSAIC"))
 		return false;
 
 	_generator = "Mosaic";
 
-	PhFileTool::readShort(f, blocLevel, "CMosaicDoc");
-	PhFileTool::readShort(f, blocLevel, "CMosaicDoc");
+	reader.readShort(blocLevel, "CMosaicDoc");
+	reader.readShort(blocLevel, "CMosaicDoc");
 
-	if(!checkMosTag2(f, blocLevel, "CMosaicDoc"))
+	if(!checkMosTag2(reader, blocLevel, "CMosaicDoc"))
 		return false;
 
-	PhFileTool::readShort(f, blocLevel, "CDocProjet");
-	PhFileTool::readShort(f, blocLevel, "CDocProjet");
+	reader.readShort(blocLevel, "CDocProjet");
+	reader.readShort(blocLevel, "CDocProjet");
 
-	if(!checkMosTag2(f, blocLevel, "CDocProjet"))
+	if(!checkMosTag2(reader, blocLevel, "CDocProjet"))
 		return false;
 
-	PhFileTool::readShort(f, blocLevel, "CDocProprietes");
-	PhFileTool::readShort(f, blocLevel, "CDocProprietes");
+	reader.readShort(blocLevel, "CDocProprietes");
+	reader.readShort(blocLevel, "CDocProprietes");
 
-	if(!checkMosTag2(f, blocLevel, "CDocProprietes"))
+	if(!checkMosTag2(reader, blocLevel, "CDocProprietes"))
 		return false;
 
-	readMosProperties(f, propLevel);
+	readMosProperties(reader, propLevel);
+	if(reader.error())
+		return false;
 
-	PhFileTool::readShort(f, blocLevel, "CDocOptionsProjet");
+	reader.readShort(blocLevel, "CDocOptionsProjet");
 
 	// read a number that makes a difference wether it's 3 or 4 later
-	unsigned short mosVersion = PhFileTool::readShort(f, blocLevel, "CDocOptionsProjet mosVersion");
+	unsigned short mosVersion = reader.readShort(blocLevel, "CDocOptionsProjet mosVersion");
 
 
-	if(!checkMosTag2(f, blocLevel, "CDocOptionsProjet"))
+	if(!checkMosTag2(reader, blocLevel, "CDocOptionsProjet"))
 		return false;
 
 	PhTimeCodeType tcType;
-	unsigned short type = PhFileTool::readInt(f, level, "type");
-	bool drop = PhFileTool::readInt(f, level, "drop") != 0;
+	unsigned short type = reader.readInt(level, "type");
+	bool drop = reader.readInt(level, "drop") != 0;
 	switch(type) {
 	case 0:
 		if(drop)
@@ -591,163 +686,158 @@ bool PhStripDoc::importMosFile(const QString &fileName)
 
 	if(mosVersion == 4) {
 		//		qDebug() << "reading extrasection ???";
-		//		PhFileTool::readInt(f, logLevel, "loop continuous numbering");
-		PhFileTool::readShort(f, level);
-		PhFileTool::readShort(f, level);
+		//		reader.readInt(logLevel, "loop continuous numbering");
+		reader.readShort(level);
+		reader.readShort(level);
 	}
 
 	for(int j = 0; j < 8; j++)
-		PhFileTool::readShort(f, level);
+		reader.readShort(level);
 
-	PhFileTool::readInt(f, blocLevel, "CDocFilm count");
-	PhFileTool::readShort(f, blocLevel, "CDocFilm");
-	PhFileTool::readShort(f, blocLevel, "CDocFilm");
+	reader.readInt(blocLevel, "CDocFilm count");
+	reader.readShort(blocLevel, "CDocFilm");
+	reader.readShort(blocLevel, "CDocFilm");
 
-	if(!checkMosTag2(f, blocLevel, "CDocFilm"))
+	if(!checkMosTag2(reader, blocLevel, "CDocFilm"))
 		return false;
 
-	unsigned short peopleCount = PhFileTool::readInt(f, blocLevel, "CDocPersonnage count");
+	unsigned short peopleCount = reader.readInt(blocLevel, "CDocPersonnage count");
 
-	PhFileTool::readShort(f, blocLevel, "CDocPersonnage");
-	int peopleType = PhFileTool::readShort(f, blocLevel, "CDocPersonnage");
+	reader.readShort(blocLevel, "CDocPersonnage");
+	int peopleType = reader.readShort(blocLevel, "CDocPersonnage");
 
-	if(!checkMosTag2(f, blocLevel, "CDocPersonnage"))
+	if(!checkMosTag2(reader, blocLevel, "CDocPersonnage"))
 		return false;
 
 	QMap<int, PhPeople*> peopleMap;
 	QMap<int, int> peopleTrackMap;
 	for(int i = 0; i < peopleCount; i++) {
+		if(reader.error())
+			return false;
 		if(i > 0)
-			PhFileTool::readShort(f, level, "people tag");
+			reader.readShort(level, "people tag");
 
-		int peopleId = PhFileTool::readInt(f, peopleLevel, "peopleId");
+		int peopleId = reader.readInt(peopleLevel, "peopleId");
 
-		QString name = PhFileTool::readString(f, peopleLevel, "people name");
+		QString name = reader.readString(peopleLevel, "people name");
 		PhPeople *people = new PhPeople(name, "#000000");
 		peopleMap[peopleId] = people;
 		_peoples.append(people);
 
-		peopleTrackMap[peopleId] = PhFileTool::readInt(f, peopleLevel, "people track") - 1;
+		peopleTrackMap[peopleId] = reader.readInt(peopleLevel, "people track") - 1;
 		for(int j = 0; j < 6; j++)
-			PhFileTool::readShort(f, level);
+			reader.readShort(level);
 
 
 		if(peopleType == 2)
-			PhFileTool::readString(f, peopleLevel, "date 1");
+			reader.readString(peopleLevel, "date 1");
 	}
 
-	int peopleCount2 = PhFileTool::readInt(f, blocLevel, "people count 2");
+	if(reader.error())
+		return false;
+
+	int peopleCount2 = reader.readInt(blocLevel, "people count 2");
 	if(peopleCount2 != peopleCount) {
 		PHDEBUG << "people count not corresponding:" << peopleCount << "/" << peopleCount2;
 		//		return false;
 	}
-	PhFileTool::readShort(f, blocLevel, "CDocVideo");
-	unsigned short videoType = PhFileTool::readShort(f, blocLevel, "CDocVideo");
+	reader.readShort(blocLevel, "CDocVideo");
+	unsigned short videoType = reader.readShort(blocLevel, "CDocVideo");
 
-	if(!checkMosTag2(f, blocLevel, "CDocVideo"))
+	if(!checkMosTag2(reader, blocLevel, "CDocVideo"))
 		return false;
 
-	QString videoFilePath = PhFileTool::readString(f, ok, "Video path");
+	QString videoFilePath = reader.readString(ok, "Video path");
 	this->setVideoFilePath(videoFilePath);
-	PhTime videoTimeIn = readMosTime(f, tcType, internLevel);
+	PhTime videoTimeIn = readMosTime(reader, tcType, internLevel);
 	this->setVideoTimeIn(videoTimeIn, tcType);
 	PHDBG(ok) << "Timestamp:" << PhTimeCode::stringFromTime(_videoTimeIn, tcType);
 
 	if(videoType == 3) {
-		PhFileTool::readShort(f, level, "videoType3");
-		PhFileTool::readShort(f, level, "videoType3");
+		reader.readShort(level, "videoType3");
+		reader.readShort(level, "videoType3");
 	}
 
-	PhFileTool::readShort(f, level);
-	PhFileTool::readShort(f, level);
+	reader.readShort(level);
+	reader.readShort(level);
 
-	unsigned short cutCount = PhFileTool::readInt(f, blocLevel, "cut count");
+	unsigned short cutCount = reader.readInt(blocLevel, "cut count");
 	if(cutCount) {
-		if(!checkMosTag(f, blocLevel, MosCut))
+		if(!checkMosTag(reader, blocLevel, MosCut))
 			return false;
 
 		for(int j = 0; j < cutCount; j++) {
-			if((j > 0) && !checkMosTag(f, level, MosCut))
+			if(reader.error())
+				return false;
+			if((j > 0) && !checkMosTag(reader, level, MosCut))
 				return false;
-			PhTime cutTime = _videoTimeIn + readMosTime(f, tcType, internLevel);
+			PhTime cutTime = _videoTimeIn + readMosTime(reader, tcType, internLevel);
 			PHDBG(cutLevel) << "cut:" << PhTimeCode::stringFromTime(cutTime, tcType);
 			_cuts.append(new PhStripCut(cutTime, PhStripCut::Simple));
 		}
 	}
 
-	QString script = PhFileTool::readString(f, ok, "script");
+	QString script = reader.readString(ok, "script");
+	if(reader.error())
+		return false;
 
-	PhFileTool::readInt(f, blocLevel, "dub count");
-	if(!checkMosTag(f, blocLevel, MosDub))
+	reader.readInt(blocLevel, "dub count");
+	if(!checkMosTag(reader, blocLevel, MosDub))
 		return false;
 
 	for(int j = 0; j < 8; j++)
-		PhFileTool::readShort(f, level, "CDocDoublage");
+		reader.readShort(level, "CDocDoublage");
 
-	int trackCount = PhFileTool::readInt(f, blocLevel, "track count");
-	if(!checkMosTag(f, blocLevel, MosTrack))
+	int trackCount = reader.readInt(blocLevel, "track count");
+	if(!checkMosTag(reader, blocLevel, MosTrack))
 		return false;
 
 	for(int track = 0; track < trackCount; track++) {
+		if(reader.error())
+			return false;
 		PHDBG(level) << "====== READING TRACK " << track << "======";
-		if((track > 0) && !checkMosTag(f, level, MosTrack))
+		if((track > 0) && !checkMosTag(reader, level, MosTrack))
 			return false;
-		if(!readMosTrack(f, tcType, peopleMap, peopleTrackMap, blocLevel, textLevel, detectLevel, labelLevel, level, internLevel))
+		if(!readMosTrack(reader, tcType, peopleMap, peopleTrackMap, blocLevel, textLevel, detectLevel, labelLevel, level, internLevel))
 			return false;
 	}
 
 	PHDBG(level) << "====== END OF TRACK ======";
 
 	for(int k = 0; k < 2; k++) {
-		int loopCount = PhFileTool::readInt(f, loopLevel, "loop count");
+		int loopCount = reader.readInt(loopLevel, "loop count");
 		if(loopCount == 0)
 			continue;
-		if(!checkMosTag(f, blocLevel, MosLoop))
+		if(!checkMosTag(reader, blocLevel, MosLoop))
 			return false;
 		for(int i = 0; i < loopCount; i++) {
-			if((i > 0) && !checkMosTag(f, level, MosLoop))
+			if(reader.error())
 				return false;
-			int number = PhFileTool::readInt(f, loopLevel, "loop number");
+			if((i > 0) && !checkMosTag(reader, level, MosLoop))
+				return false;
+			int number = reader.readInt(loopLevel, "loop number");
 
-			PhTime loopTime = _videoTimeIn + readMosTime(f, tcType, internLevel);;
-			PhFileTool::readString(f, loopLevel, "loop name");
+			PhTime loopTime = _videoTimeIn + readMosTime(reader, tcType, internLevel);;
+			reader.readString(loopLevel, "loop name");
 			_loops.append(new PhStripLoop(loopTime, QString::number(number)));
 		}
 	}
 
 	for(int j = 0; j < 4; j++)
-		PhFileTool::readShort(f, level, "after loop1");
+		reader.readShort(level, "after loop1");
 
 	//	if(strangeNumber2 == 1) {
 	//		for(int j = 0; j < 9; j++)
-	//			PhFileTool::readShort(f, level, "after loop2");
+	//			reader.readShort(level, "after loop2");
 	//	}
 
-	//	if(!checkMosTag(f, blocLevel, MosBin))
+	//	if(!checkMosTag(reader, blocLevel, MosBin))
 	//		return false;
 
 	//	for(int j = 0; j < 2; j++)
-	//		PhFileTool::readShort(f, level);
-
-	PHDEBUG << "_______________" << "reading ok" << "_______________";
-
-	f.close();
-
-	if((_texts1.count() == 0) && (_texts2.count())) {
-		PHDEBUG << "Switching primary and secondary text lists";
-		_texts1.append(_texts2);
-		_texts2.clear();
-	}
-
-	qSort(_texts1.begin(), _texts1.end(), PhStripObject::dtcomp);
-	qSort(_texts2.begin(), _texts2.end(), PhStripObject::dtcomp);
-	qSort(_detects.begin(), _detects.end(), PhStripObject::dtcomp);
-	qSort(_cuts.begin(), _cuts.end(), PhStripObject::dtcomp);
-	qSort(_loops.begin(), _loops.end(), PhStripObject::dtcomp);
-
-	emit this->changed();
+	//		reader.readShort(level);
 
-	return true;
+	return !reader.error();
 }
 
 PhTime PhStripDoc::ComputeDrbTime1(PhTime offset, PhTime value, PhTimeCodeType tcType)
@@ -919,14 +1009,32 @@ bool PhStripDoc::importDrbFile(const QString &fileName)
 		}
 	}
 
+	buildIndex();
+
+	emit this->changed();
+
 	return result;
 }
 
 bool PhStripDoc::importSyn6File(const QString &fileName)
 {
-	QSqlDatabase db;
-	db =  QSqlDatabase::addDatabase("QSQLITE");
-	db.setDatabaseName(fileName);
+	// Each document uses its own connection so that several documents
+	// can be imported at the same time from different threads.
+	QString connectionName = QString("PhStripDoc%1").arg(quintptr(this));
+	bool result;
+	{
+		QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", connectionName);
+		db.setDatabaseName(fileName);
+		result = readSyn6Database(db);
+		db.close();
+	}
+	QSqlDatabase::removeDatabase(connectionName);
+
+	return result;
+}
+
+bool PhStripDoc::readSyn6Database(QSqlDatabase &db)
+{
 	if(!db.open()) {
 		PHDEBUG << "Error opening the sqlite document:" << db.lastError().text();
 		return false;
@@ -1020,7 +1128,9 @@ bool PhStripDoc::importSyn6File(const QString &fileName)
 		}
 	}
 
-	db.close();
+	buildIndex();
+
+	emit this->changed();
 
 	return true;
 }
@@ -1076,10 +1186,8 @@ bool PhStripDoc::openStripFile(const QString &fileName)
 			QDomElement media = mediaList.at(i).toElement();
 			QString type = media.attribute("type");
 			PHDEBUG << "line" << type;
-			if(type == "detx")
-				result = importDetXFile(media.text());
-			else if(type == "mos")
-				result = importMosFile(media.text());
+			if((type == "detx") || (type == "mos"))
+				result = importCachedFile(media.text(), type);
 			else if(type == "video") {
 				_videoPath = media.text();
 
@@ -1194,6 +1302,398 @@ bool PhStripDoc::saveStripFile(const QString &fileName, PhTime lastTime)
 	return true;
 }
 
+/** @brief The binary cache file signature ("JKRC") */
+#define PHSTRIPDOC_CACHE_MAGIC 0x43524b4a
+/** @brief The binary cache format version, to increase each time the layout changes */
+#define PHSTRIPDOC_CACHE_VERSION 2
+
+bool PhStripDoc::importCachedFile(const QString &fileName, const QString &type)
+{
+	QString cachePath = cacheFileName(fileName);
+	if(_cacheEnabled && readCacheFile(cachePath, fileName))
+		return true;
+
+	bool result;
+	if(type == "detx")
+		result = importDetXFile(fileName);
+	else
+		result = importMosFile(fileName);
+
+	if(result && _cacheEnabled)
+		writeCacheFile(cachePath, fileName);
+
+	return result;
+}
+
+QString PhStripDoc::cacheFileName(const QString &sourceFileName)
+{
+	return sourceFileName + ".jokercache";
+}
+
+static quint32 cacheStringId(QHash<QString, quint32> &ids, QStringList &strings, const QString &string)
+{
+	QHash<QString, quint32>::const_iterator it = ids.constFind(string);
+	if(it != ids.constEnd())
+		return it.value();
+	quint32 id = strings.count();
+	ids.insert(string, id);
+	strings.append(string);
+	return id;
+}
+
+template <class T>
+static void writeCachePeopleObjects(QDataStream &stream, const QList<T *> &list, const QHash<PhPeople *, qint32> &peopleIds)
+{
+	stream << quint32(list.count());
+	foreach(T *object, list)
+		stream << qint64(object->timeIn());
+	foreach(T *object, list)
+		stream << qint64(object->timeOut());
+	foreach(T *object, list)
+		stream << peopleIds.value(object->people(), -1);
+	foreach(T *object, list)
+		stream << object->y();
+	foreach(T *object, list)
+		stream << object->height();
+}
+
+bool PhStripDoc::writeCacheFile(const QString &fileName, const QString &sourceFileName)
+{
+	QFileInfo source(sourceFileName);
+	if(!source.exists())
+		return false;
+
+	// Intern the strings and collect the columns referencing them
+	QHash<QString, quint32> ids;
+	QStringList strings;
+	QVector<quint32> docStrings;
+	docStrings << cacheStringId(ids, strings, _generator)
+	           << cacheStringId(ids, strings, _title)
+	           << cacheStringId(ids, strings, _translatedTitle)
+	           << cacheStringId(ids, strings, _episode)
+	           << cacheStringId(ids, strings, _season)
+	           << cacheStringId(ids, strings, _authorName)
+	           << cacheStringId(ids, strings, _videoPath);
+
+	QVector<quint32> metaKeys, metaValues;
+	for(QMap<QString, QString>::const_iterator it = _metaInformation.constBegin(); it != _metaInformation.constEnd(); ++it) {
+		metaKeys.append(cacheStringId(ids, strings, it.key()));
+		metaValues.append(cacheStringId(ids, strings, it.value()));
+	}
+
+	QHash<PhPeople *, qint32> peopleIds;
+	QVector<quint32> peopleNames, peopleColors;
+	foreach(PhPeople *people, _peoples) {
+		peopleIds.insert(people, peopleIds.count());
+		peopleNames.append(cacheStringId(ids, strings, people->name()));
+		peopleColors.append(cacheStringId(ids, strings, people->color()));
+	}
+
+	QVector<quint32> text1Contents, text2Contents, loopLabels;
+	foreach(PhStripText *text, _texts1)
+		text1Contents.append(cacheStringId(ids, strings, text->content()));
+	foreach(PhStripText *text, _texts2)
+		text2Contents.append(cacheStringId(ids, strings, text->content()));
+	foreach(PhStripLoop *loop, _loops)
+		loopLabels.append(cacheStringId(ids, strings, loop->label()));
+
+	QSaveFile file(fileName);
+	if(!file.open(QIODevice::WriteOnly)) {
+		PHDEBUG << "Unable to write the cache" << fileName << file.errorString();
+		return false;
+	}
+
+	QDataStream stream(&file);
+	stream.setByteOrder(QDataStream::LittleEndian);
+	stream.setFloatingPointPrecision(QDataStream::SinglePrecision);
+
+	stream << quint32(PHSTRIPDOC_CACHE_MAGIC) << quint32(PHSTRIPDOC_CACHE_VERSION);
+	stream << qint64(source.size()) << qint64(source.lastModified().toMSecsSinceEpoch());
+
+	// The string table: the offsets followed by the UTF-16 characters
+	stream << quint32(strings.count());
+	quint32 offset = 0;
+	foreach(const QString &string, strings) {
+		stream << offset;
+		offset += string.length();
+	}
+	stream << offset;
+	foreach(const QString &string, strings) {
+		const ushort *utf16 = string.utf16();
+		for(int i = 0; i < string.length(); i++)
+			stream << quint16(utf16[i]);
+	}
+
+	foreach(quint32 id, docStrings)
+		stream << id;
+	stream << qint64(_videoTimeIn) << qint64(_lastTime) << qint32(_videoTimeCodeType);
+	stream << qint32((_videoDeinterlace ? 1 : 0) | (_videoForceRatio169 ? 2 : 0));
+
+	stream << quint32(metaKeys.count());
+	foreach(quint32 id, metaKeys)
+		stream << id;
+	foreach(quint32 id, metaValues)
+		stream << id;
+
+	stream << quint32(peopleNames.count());
+	foreach(quint32 id, peopleNames)
+		stream << id;
+	foreach(quint32 id, peopleColors)
+		stream << id;
+
+	writeCachePeopleObjects(stream, _texts1, peopleIds);
+	foreach(quint32 id, text1Contents)
+		stream << id;
+
+	writeCachePeopleObjects(stream, _texts2, peopleIds);
+	foreach(quint32 id, text2Contents)
+		stream << id;
+
+	writeCachePeopleObjects(stream, _detects, peopleIds);
+	foreach(PhStripDetect *detect, _detects)
+		stream << qint32(detect->type());
+
+	stream << quint32(_cuts.count());
+	foreach(PhStripCut *cut, _cuts)
+		stream << qint64(cut->timeIn());
+	foreach(PhStripCut *cut, _cuts)
+		stream << qint32(cut->type());
+
+	stream << quint32(_loops.count());
+	foreach(PhStripLoop *loop, _loops)
+		stream << qint64(loop->timeIn());
+	foreach(quint32 id, loopLabels)
+		stream << id;
+
+	if(!file.commit()) {
+		PHDEBUG << "Unable to write the cache" << fileName << file.errorString();
+		return false;
+	}
+
+	PHDEBUG << fileName << strings.count() << "strings";
+	return true;
+}
+
+/**
+ * @brief The columns of the people objects stored in the cache file
+ */
+struct PhStripCachePeopleColumns
+{
+	/** @brief The object count */
+	quint32 count;
+	/** @brief The time in (qint64) */
+	const uchar *timeIns;
+	/** @brief The time out (qint64) */
+	const uchar *timeOuts;
+	/** @brief The people index (qint32, -1 if none) */
+	const uchar *peoples;
+	/** @brief The y position (float) */
+	const uchar *ys;
+	/** @brief The height (float) */
+	const uchar *heights;
+	/** @brief The content string id (quint32) or detect type (qint32) */
+	const uchar *values;
+};
+
+static void readCachePeopleColumns(PhBinaryReader &reader, PhStripCachePeopleColumns &columns, int level)
+{
+	columns.count = reader.readInt(level, "count");
+	qint64 count = columns.count;
+	columns.timeIns = reader.readData(count * 8, level, "time in");
+	columns.timeOuts = reader.readData(count * 8, level, "time out");
+	columns.peoples = reader.readData(count * 4, level, "people");
+	columns.ys = reader.readData(count * 4, level, "y");
+	columns.heights = reader.readData(count * 4, level, "height");
+	columns.values = reader.readData(count * 4, level, "value");
+}
+
+static inline qint64 cacheInt64(const uchar *column, int i)
+{
+	return qFromLittleEndian<qint64>(column + 8 * i);
+}
+
+static inline qint32 cacheInt32(const uchar *column, int i)
+{
+	return qFromLittleEndian<qint32>(column + 4 * i);
+}
+
+static inline float cacheFloat(const uchar *column, int i)
+{
+	quint32 bits = qFromLittleEndian<quint32>(column + 4 * i);
+	float result;
+	memcpy(&result, &bits, sizeof(result));
+	return result;
+}
+
+bool PhStripDoc::readCacheFile(const QString &fileName, const QString &sourceFileName)
+{
+	QFileInfo source(sourceFileName);
+	if(!source.exists() || !QFile::exists(fileName))
+		return false;
+
+	PhBinaryReader reader;
+	if(!reader.open(fileName))
+		return false;
+
+	int level = 4;
+	if((quint32(reader.readInt(level, "magic")) != PHSTRIPDOC_CACHE_MAGIC)
+	        || (reader.readInt(level, "version") != PHSTRIPDOC_CACHE_VERSION)) {
+		PHDEBUG << "Unknown cache format:" << fileName;
+		return false;
+	}
+
+	if((reader.readInt64(level, "source size") != source.size())
+	        || (reader.readInt64(level, "source time") != source.lastModified().toMSecsSinceEpoch())) {
+		PHDEBUG << "The cache is outdated:" << fileName;
+		return false;
+	}
+
+	// The string table
+	quint32 stringCount = reader.readInt(level, "string count");
+	const uchar *offsets = reader.readData((stringCount + qint64(1)) * 4, level, "string offsets");
+	if(offsets == NULL)
+		return false;
+	quint32 characterCount = qFromLittleEndian<quint32>(offsets + 4 * stringCount);
+	const uchar *characters = reader.readData(characterCount * qint64(2), level, "string characters");
+	if(characters == NULL)
+		return false;
+
+	QVector<QString> strings(stringCount);
+	quint32 begin = 0;
+	for(quint32 i = 0; i < stringCount; i++) {
+		quint32 end = qFromLittleEndian<quint32>(offsets + 4 * (i + 1));
+		if((end < begin) || (end > characterCount)) {
+			PHDEBUG << "Bad string table:" << fileName;
+			return false;
+		}
+#if Q_BYTE_ORDER == Q_LITTLE_ENDIAN
+		strings[i] = QString::fromUtf16(reinterpret_cast<const ushort *>(characters + 2 * begin), end - begin);
+#else
+		QString &string = strings[i];
+		string.resize(end - begin);
+		for(quint32 j = begin; j < end; j++)
+			string[j - begin] = QChar(qFromLittleEndian<quint16>(characters + 2 * j));
+#endif
+		begin = end;
+	}
+
+	// Every string id is checked before being used
+	bool valid = true;
+	auto stringAt = [&](const uchar *column, quint32 i) -> QString {
+		quint32 id = qFromLittleEndian<quint32>(column + 4 * i);
+		if(id < stringCount)
+			return strings[id];
+		valid = false;
+		return QString();
+	};
+
+	const uchar *docStrings = reader.readData(7 * 4, level, "document strings");
+	PhTime videoTimeIn = reader.readInt64(level, "video time in");
+	PhTime lastTime = reader.readInt64(level, "last time");
+	qint32 videoTimeCodeType = reader.readInt(level, "video timecode type");
+	qint32 videoFlags = reader.readInt(level, "video flags");
+
+	quint32 metaCount = reader.readInt(level, "meta count");
+	const uchar *metaKeys = reader.readData(metaCount * qint64(4), level, "meta keys");
+	const uchar *metaValues = reader.readData(metaCount * qint64(4), level, "meta values");
+
+	quint32 peopleCount = reader.readInt(level, "people count");
+	const uchar *peopleNames = reader.readData(peopleCount * qint64(4), level, "people names");
+	const uchar *peopleColors = reader.readData(peopleCount * qint64(4), level, "people colors");
+
+	PhStripCachePeopleColumns texts1, texts2, detects;
+	readCachePeopleColumns(reader, texts1, level);
+	readCachePeopleColumns(reader, texts2, level);
+	readCachePeopleColumns(reader, detects, level);
+
+	quint32 cutCount = reader.readInt(level, "cut count");
+	const uchar *cutTimes = reader.readData(cutCount * qint64(8), level, "cut times");
+	const uchar *cutTypes = reader.readData(cutCount * qint64(4), level, "cut types");
+
+	quint32 loopCount = reader.readInt(level, "loop count");
+	const uchar *loopTimes = reader.readData(loopCount * qint64(8), level, "loop times");
+	const uchar *loopLabels = reader.readData(loopCount * qint64(4), level, "loop labels");
+
+	if(reader.error() || !reader.atEnd()) {
+		PHDEBUG << "Bad cache file:" << fileName;
+		return false;
+	}
+
+	this->reset();
+
+	_filePath = sourceFileName;
+	_generator = stringAt(docStrings, 0);
+	_title = stringAt(docStrings, 1);
+	_translatedTitle = stringAt(docStrings, 2);
+	_episode = stringAt(docStrings, 3);
+	_season = stringAt(docStrings, 4);
+	_authorName = stringAt(docStrings, 5);
+	_videoPath = stringAt(docStrings, 6);
+	_videoTimeIn = videoTimeIn;
+	_lastTime = lastTime;
+	_videoTimeCodeType = (PhTimeCodeType)videoTimeCodeType;
+	_videoDeinterlace = videoFlags & 1;
+	_videoForceRatio169 = videoFlags & 2;
+
+	_metaInformation.clear();
+	for(quint32 i = 0; i < metaCount; i++)
+		_metaInformation[stringAt(metaKeys, i)] = stringAt(metaValues, i);
+
+	_peoples.reserve(peopleCount);
+	for(quint32 i = 0; i < peopleCount; i++)
+		_peoples.append(new PhPeople(stringAt(peopleNames, i), stringAt(peopleColors, i)));
+
+	PhStripCachePeopleColumns *textColumns[2] = {&texts1, &texts2};
+	QList<PhStripText *> *textLists[2] = {&_texts1, &_texts2};
+	for(int k = 0; k < 2; k++) {
+		PhStripCachePeopleColumns &columns = *textColumns[k];
+		textLists[k]->reserve(columns.count);
+		for(quint32 i = 0; i < columns.count; i++) {
+			qint32 peopleIndex = cacheInt32(columns.peoples, i);
+			textLists[k]->append(new PhStripText(cacheInt64(columns.timeIns, i),
+			                                     (peopleIndex >= 0) && (quint32(peopleIndex) < peopleCount) ? _peoples[peopleIndex] : NULL,
+			                                     cacheInt64(columns.timeOuts, i),
+			                                     cacheFloat(columns.ys, i),
+			                                     stringAt(columns.values, i),
+			                                     cacheFloat(columns.heights, i)));
+		}
+	}
+
+	_detects.reserve(detects.count);
+	for(quint32 i = 0; i < detects.count; i++) {
+		qint32 peopleIndex = cacheInt32(detects.peoples, i);
+		PhStripDetect *detect = new PhStripDetect((PhStripDetect::PhDetectType)cacheInt32(detects.values, i),
+		                                          cacheInt64(detects.timeIns, i),
+		                                          (peopleIndex >= 0) && (quint32(peopleIndex) < peopleCount) ? _peoples[peopleIndex] : NULL,
+		                                          cacheInt64(detects.timeOuts, i),
+		                                          cacheFloat(detects.ys, i));
+		detect->setHeight(cacheFloat(detects.heights, i));
+		_detects.append(detect);
+	}
+
+	_cuts.reserve(cutCount);
+	for(quint32 i = 0; i < cutCount; i++)
+		_cuts.append(new PhStripCut(cacheInt64(cutTimes, i), (PhStripCut::PhCutType)cacheInt32(cutTypes, i)));
+
+	_loops.reserve(loopCount);
+	for(quint32 i = 0; i < loopCount; i++)
+		_loops.append(new PhStripLoop(cacheInt64(loopTimes, i), stringAt(loopLabels, i)));
+
+	if(!valid) {
+		PHDEBUG << "Bad string id in the cache:" << fileName;
+		this->reset();
+		return false;
+	}
+
+	PHDEBUG << "Cache loaded:" << fileName;
+
+	buildIndex();
+
+	emit this->changed();
+
+	return true;
+}
+
 void PhStripDoc::generate(QString content, int loopCount, int peopleCount, PhTime spaceBetweenText, int textCount, int trackCount, PhTime videoTimeIn)
 {
 	this->reset();
@@ -1240,6 +1740,8 @@ void PhStripDoc::generate(QString content, int loopCount, int peopleCount, PhTim
 	for(int i = 0; i < loopCount; i++)
 		_loops.append(new PhStripLoop(_videoTimeIn + i * 24000 * 60, QString::number(i)));
 
+	buildIndex();
+
 	emit changed();
 }
 
@@ -1252,6 +1754,8 @@ void PhStripDoc::reset()
 	_loops.clear();
 	_texts1.clear();
 	_texts2.clear();
+	_maxText1Duration = _maxText2Duration = _maxDetectDuration = 0;
+	_peopleTexts.clear();
 	_title = "";
 	_translatedTitle = "";
 	_episode = "";
@@ -1269,22 +1773,100 @@ void PhStripDoc::reset()
 	emit this->changed();
 }
 
+template <class T>
+static void insertSorted(QList<T *> &list, T *object)
+{
+	// Insert after the objects with the same time in to keep the adding order
+	typename QList<T *>::iterator it = std::upper_bound(list.begin(), list.end(), object, PhStripObject::dtcomp);
+	list.insert(it, object);
+}
+
+template <class T>
+static PhTime maxDuration(const QList<T *> &list)
+{
+	PhTime result = 0;
+	foreach(T *object, list) {
+		if(object->timeOut() - object->timeIn() > result)
+			result = object->timeOut() - object->timeIn();
+	}
+	return result;
+}
+
+static bool timeInLowerThan(PhStripObject *object, PhTime time)
+{
+	return object->timeIn() < time;
+}
+
+static bool timeLowerThanTimeIn(PhTime time, PhStripObject *object)
+{
+	return time < object->timeIn();
+}
+
+template <class T>
+static T *nextObject(const QList<T *> &list, PhTime time)
+{
+	typename QList<T *>::const_iterator it = std::upper_bound(list.constBegin(), list.constEnd(), time, timeLowerThanTimeIn);
+	if(it == list.constEnd())
+		return NULL;
+	return *it;
+}
+
+template <class T>
+static T *previousObject(const QList<T *> &list, PhTime time)
+{
+	typename QList<T *>::const_iterator it = std::lower_bound(list.constBegin(), list.constEnd(), time, timeInLowerThan);
+	if(it == list.constBegin())
+		return NULL;
+	return *(it - 1);
+}
+
+template <class T>
+static PhStripRange<T> timeRange(const QList<T *> &list, PhTime timeIn, PhTime timeOut)
+{
+	typename QList<T *>::const_iterator begin = std::lower_bound(list.constBegin(), list.constEnd(), timeIn, timeInLowerThan);
+	typename QList<T *>::const_iterator end = std::upper_bound(begin, list.constEnd(), timeOut, timeLowerThanTimeIn);
+	return PhStripRange<T>(begin, end);
+}
+
+void PhStripDoc::buildIndex()
+{
+	// The stable sort keeps the file order of the objects with the same time in
+	std::stable_sort(_texts1.begin(), _texts1.end(), PhStripObject::dtcomp);
+	std::stable_sort(_texts2.begin(), _texts2.end(), PhStripObject::dtcomp);
+	std::stable_sort(_detects.begin(), _detects.end(), PhStripObject::dtcomp);
+	std::stable_sort(_cuts.begin(), _cuts.end(), PhStripObject::dtcomp);
+	std::stable_sort(_loops.begin(), _loops.end(), PhStripObject::dtcomp);
+
+	_maxText1Duration = maxDuration(_texts1);
+	_maxText2Duration = maxDuration(_texts2);
+	_maxDetectDuration = maxDuration(_detects);
+
+	_peopleTexts.clear();
+	foreach(PhStripText *text, _texts1)
+		_peopleTexts[text->people()].append(text);
+}
+
 void PhStripDoc::addObject(PhStripObject *object)
 {
 	if(dynamic_cast<PhStripCut*>(object)) {
-		this->_cuts.append(dynamic_cast<PhStripCut*>(object));
+		insertSorted(this->_cuts, dynamic_cast<PhStripCut*>(object));
 		PHDEBUG << "Added a cut";
 	}
 	else if(dynamic_cast<PhStripLoop*>(object)) {
-		this->_loops.append(dynamic_cast<PhStripLoop*>(object));
+		insertSorted(this->_loops, dynamic_cast<PhStripLoop*>(object));
 		PHDEBUG << "Added a loop";
 	}
 	else if(dynamic_cast<PhStripDetect*>(object)) {
-		this->_detects.append(dynamic_cast<PhStripDetect*>(object));
+		PhStripDetect *detect = dynamic_cast<PhStripDetect*>(object);
+		insertSorted(this->_detects, detect);
+		_maxDetectDuration = qMax(_maxDetectDuration, detect->timeOut() - detect->timeIn());
 		PHDEBUG << "Added a detect!";
 	}
 	else if(dynamic_cast<PhStripText*>(object)) {
-		this->_texts1.append(dynamic_cast<PhStripText*>(object));
+		PhStripText *text = dynamic_cast<PhStripText*>(object);
+		insertSorted(this->_texts1, text);
+		insertSorted(_peopleTexts[text->people()], text);
+		_maxText1Duration = qMax(_maxText1Duration, text->timeOut() - text->timeIn());
 		PHDEBUG << "Added a text!";
 	}
 	else {
@@ -1313,142 +1895,69 @@ PhPeople *PhStripDoc::peopleByName(QString name)
 
 PhStripText *PhStripDoc::nextText(PhTime time)
 {
-	PhStripText * result = NULL;
-	foreach(PhStripText* text, this->texts()) {
-		if(text->timeIn() > time) {
-			if(!result || (text->timeIn() < result->timeIn()) )
-				result = text;
-		}
-	}
-	return result;
+	return nextObject(_texts1, time);
 }
 
 PhStripText *PhStripDoc::nextText(PhPeople *people, PhTime time)
 {
-	PhStripText * result = NULL;
-	foreach(PhStripText* text, this->texts()) {
-		if((text->people() == people) && (text->timeIn() > time)) {
-			if(!result || (text->timeIn() < result->timeIn()) )
-				result = text;
-		}
-	}
-	return result;
+	return nextObject(_peopleTexts.value(people), time);
 }
 
 PhStripText *PhStripDoc::nextText(QList<PhPeople *> peopleList, PhTime time)
 {
 	PhStripText * result = NULL;
-	foreach(PhStripText* text, this->texts()) {
-		if(peopleList.contains(text->people()) && (text->timeIn() > time)) {
-			if(!result || (text->timeIn() < result->timeIn()) )
-				result = text;
-		}
+	foreach(PhPeople *people, peopleList) {
+		PhStripText *text = nextText(people, time);
+		if(text && (!result || (text->timeIn() < result->timeIn())))
+			result = text;
 	}
 	return result;
 }
 
 PhTime PhStripDoc::previousTextTime(PhTime time)
 {
-	PhTime previousTextTime = PHTIMEMIN;
-
-	foreach(PhStripText* text, this->texts()) {
-		if((text->timeIn() < time) && (text->timeIn() > previousTextTime) )
-			previousTextTime = text->timeIn();
-	}
-
-	return previousTextTime;
+	PhStripText *text = previousObject(_texts1, time);
+	return text ? text->timeIn() : PHTIMEMIN;
 }
 
 PhTime PhStripDoc::previousLoopTime(PhTime time)
 {
-	PhTime previousLoopTime = PHTIMEMIN;
-
-	foreach(PhStripLoop* loop, _loops) {
-		if((loop->timeIn() < time) && (loop->timeIn() > previousLoopTime) )
-			previousLoopTime = loop->timeIn();
-	}
-
-	return previousLoopTime;
+	PhStripLoop *loop = previousObject(_loops, time);
+	return loop ? loop->timeIn() : PHTIMEMIN;
 }
 
 PhTime PhStripDoc::previousCutTime(PhTime time)
 {
-	PhTime previousCutTime = PHTIMEMIN;
-
-	foreach(PhStripCut* cut, _cuts) {
-		if((cut->timeIn() < time) && (cut->timeIn() > previousCutTime) )
-			previousCutTime = cut->timeIn();
-	}
-
-	return previousCutTime;
+	PhStripCut *cut = previousObject(_cuts, time);
+	return cut ? cut->timeIn() : PHTIMEMIN;
 }
 
 PhTime PhStripDoc::previousElementTime(PhTime time)
 {
-	PhTime previousElementTime = previousCutTime(time);
-
-	if(previousLoopTime(time) > previousElementTime)
-		previousElementTime = previousLoopTime(time);
-
-	if(previousTextTime(time) > previousElementTime)
-		previousElementTime = previousTextTime(time);
-
-	return previousElementTime;
+	return qMax(previousCutTime(time), qMax(previousLoopTime(time), previousTextTime(time)));
 }
 
 PhTime PhStripDoc::nextTextTime(PhTime time)
 {
-	PhTime nextTextTime = PHTIMEMAX;
-
-	foreach(PhStripText* text, this->texts()) {
-		if((text->timeIn() > time) && (text->timeIn() < nextTextTime) )
-			nextTextTime = text->timeIn();
-		else if(text->timeIn() > nextTextTime)
-			return nextTextTime;
-	}
-
-	return nextTextTime;
+	PhStripText *text = nextObject(_texts1, time);
+	return text ? text->timeIn() : PHTIMEMAX;
 }
 
 PhTime PhStripDoc::nextLoopTime(PhTime time)
 {
-	PhTime nextLoopTime = PHTIMEMAX;
-
-	foreach(PhStripLoop* loop, _loops) {
-		if((loop->timeIn() > time) && (loop->timeIn() < nextLoopTime) )
-			nextLoopTime = loop->timeIn();
-		else if(loop->timeIn() > nextLoopTime)
-			return nextLoopTime;
-	}
-
-	return nextLoopTime;
+	PhStripLoop *loop = nextObject(_loops, time);
+	return loop ? loop->timeIn() : PHTIMEMAX;
 }
 
 PhTime PhStripDoc::nextCutTime(PhTime time)
 {
-	PhTime nextCutTime = PHTIMEMAX;
-
-	foreach(PhStripCut* cut, _cuts) {
-		if((cut->timeIn() > time) && (cut->timeIn() < nextCutTime) )
-			nextCutTime = cut->timeIn();
-		else if(cut->timeIn() > nextCutTime)
-			return nextCutTime;
-	}
-
-	return nextCutTime;
+	PhStripCut *cut = nextObject(_cuts, time);
+	return cut ? cut->timeIn() : PHTIMEMAX;
 }
 
 PhTime PhStripDoc::nextElementTime(PhTime time)
 {
-	PhTime nextElementTime = nextCutTime(time);
-
-	if(nextLoopTime(time) < nextElementTime)
-		nextElementTime = nextLoopTime(time);
-
-	if(nextTextTime(time) < nextElementTime)
-		nextElementTime = nextTextTime(time);
-
-	return nextElementTime;
+	return qMin(nextCutTime(time), qMin(nextLoopTime(time), nextTextTime(time)));
 }
 
 PhTime PhStripDoc::timeIn()
@@ -1463,22 +1972,12 @@ PhTime PhStripDoc::timeOut()
 
 PhStripLoop *PhStripDoc::nextLoop(PhTime time)
 {
-	foreach(PhStripLoop* loop, _loops) {
-		if(loop->timeIn() > time)
-			return loop;
-	}
-	return NULL;
+	return nextObject(_loops, time);
 }
 
 PhStripLoop *PhStripDoc::previousLoop(PhTime time)
 {
-	int i = _loops.count() - 1;
-	while(i >= 0) {
-		if(_loops.at(i)->timeIn() < time)
-			return _loops.at(i);
-		i--;
-	}
-	return NULL;
+	return previousObject(_loops, time);
 }
 
 QString PhStripDoc::filePath()
@@ -1566,12 +2065,7 @@ QList<PhStripText *> PhStripDoc::texts(bool alternate)
 
 QList<PhStripText *> PhStripDoc::texts(PhPeople *people)
 {
-	QList<PhStripText*> result;
-	foreach(PhStripText *text, this->texts()) {
-		if(text->people() == people)
-			result.append(text);
-	}
-	return result;
+	return _peopleTexts.value(people);
 }
 
 QList<PhStripLoop *> PhStripDoc::loops()
@@ -1581,9 +2075,12 @@ QList<PhStripLoop *> PhStripDoc::loops()
 
 QList<PhStripDetect *> PhStripDoc::detects(PhTime timeIn, PhTime timeOut)
 {
+	if((timeIn == PHTIMEMIN) && (timeOut == PHTIMEMAX))
+		return _detects;
+
 	QList<PhStripDetect*> result;
-	foreach(PhStripDetect *detect, this->_detects) {
-		if((detect->timeIn() >= timeIn) && (detect->timeOut() < timeOut))
+	foreach(PhStripDetect *detect, timeRange(_detects, timeIn, timeOut)) {
+		if(detect->timeOut() < timeOut)
 			result.append(detect);
 	}
 
@@ -1621,3 +2118,32 @@ QList<PhStripCut *> PhStripDoc::cuts()
 	return _cuts;
 }
 
+PhStripRange<PhStripText> PhStripDoc::visibleTexts(PhTime timeIn, PhTime timeOut, bool alternate)
+{
+	PhTime duration = alternate ? _maxText2Duration : _maxText1Duration;
+	// A text starting before timeIn - duration ends before timeIn
+	if(timeIn > PHTIMEMIN + duration)
+		timeIn -= duration;
+	else
+		timeIn = PHTIMEMIN;
+	return timeRange(alternate ? _texts2 : _texts1, timeIn, timeOut);
+}
+
+PhStripRange<PhStripCut> PhStripDoc::visibleCuts(PhTime timeIn, PhTime timeOut)
+{
+	return timeRange(_cuts, timeIn, timeOut);
+}
+
+PhStripRange<PhStripLoop> PhStripDoc::visibleLoops(PhTime timeIn, PhTime timeOut)
+{
+	return timeRange(_loops, timeIn, timeOut);
+}
+
+PhStripRange<PhStripDetect> PhStripDoc::visibleDetects(PhTime timeIn, PhTime timeOut)
+{
+	if(timeIn > PHTIMEMIN + _maxDetectDuration)
+		timeIn -= _maxDetectDuration;
+	else
+		timeIn = PHTIMEMIN;
+	return timeRange(_detects, timeIn, timeOut);
+}
@@ -10,7 +10,10 @@
 #include <QList>
 #include <QMap>
 #include <QFile>
+#include <QXmlStreamReader>
+#include <QSqlDatabase>
 
+#include "PhTools/PhBinaryReader.h"
 #include "PhSync/PhTimeCode.h"
 
 #include "PhPeople.h"
@@ -19,6 +22,7 @@
 #include "PhStripObject.h"
 #include "PhStripText.h"
 #include "PhStripDetect.h"
+#include "PhStripRange.h"
 
 /**
  * @brief The joker document class
@@ -26,6 +30,9 @@
  * It contains the script file with all the informations
  * such as the title, the authors, the characters (PhPeople), the lines,
  * the attach video file...
+ *
+ * The texts, cuts, loops and detects are kept sorted by time in so that
+ * the objects intersecting a time range are found with a binary search.
  */
 class PhStripDoc : public QObject
 {
@@ -183,6 +190,45 @@ public:
 	 */
 	QList<PhStripDetect *> peopleDetects(PhPeople *people, PhTime timeIn = PHTIMEMIN, PhTime timeOut = PHTIMEMAX);
 
+	/**
+	 * @brief Get the texts that may intersect a time range
+	 *
+	 * The range starts at the first text that can end after timeIn
+	 * and stops after the last text starting before timeOut: a few
+	 * texts of the range might not intersect it.
+	 * @param timeIn The range starting time
+	 * @param timeOut The range ending time
+	 * @param alternate True for the alternate text list
+	 * @return A range of texts sorted by time in
+	 */
+	PhStripRange<PhStripText> visibleTexts(PhTime timeIn, PhTime timeOut, bool alternate = false);
+
+	/**
+	 * @brief Get the cuts inside a time range
+	 * @param timeIn The range starting time
+	 * @param timeOut The range ending time
+	 * @return A range of cuts sorted by time in
+	 */
+	PhStripRange<PhStripCut> visibleCuts(PhTime timeIn, PhTime timeOut);
+
+	/**
+	 * @brief Get the loops inside a time range
+	 * @param timeIn The range starting time
+	 * @param timeOut The range ending time
+	 * @return A range of loops sorted by time in
+	 */
+	PhStripRange<PhStripLoop> visibleLoops(PhTime timeIn, PhTime timeOut);
+
+	/**
+	 * @brief Get the detects that may intersect a time range
+	 *
+	 * As for visibleTexts(), a few detects of the range might not intersect it.
+	 * @param timeIn The range starting time
+	 * @param timeOut The range ending time
+	 * @return A range of detects sorted by time in
+	 */
+	PhStripRange<PhStripDetect> visibleDetects(PhTime timeIn, PhTime timeOut);
+
 	/**
 	 * @brief Set the title property
 	 * @param title A string
@@ -244,6 +290,50 @@ public:
 	 * @return True if the strip opened well, false otherwise
 	 */
 	bool openStripFile(const QString &fileName);
+	/**
+	 * @brief Enable the binary cache of the imported files
+	 *
+	 * When enabled, openStripFile() stores the content of the DetX or Mos
+	 * file referenced by the strip file in a binary file next to it
+	 * (see cacheFileName()) and loads it instead of importing the source
+	 * file again as long as the source size and modification time match.
+	 * @param enabled True to enable the cache, false otherwise
+	 */
+	void setCacheEnabled(bool enabled) {
+		_cacheEnabled = enabled;
+	}
+	/**
+	 * @brief Check if the binary cache of the imported files is enabled
+	 * @return True if enabled, false otherwise
+	 */
+	bool cacheEnabled() const {
+		return _cacheEnabled;
+	}
+	/**
+	 * @brief Get the binary cache file name of a source file
+	 * @param sourceFileName The path to the imported file
+	 * @return The path to the cache file
+	 */
+	static QString cacheFileName(const QString &sourceFileName);
+	/**
+	 * @brief Write the document content to a binary cache file
+	 *
+	 * The file starts with a versioned header holding the source file size
+	 * and modification time. It is followed by a table of the distinct
+	 * strings (contents, people names, labels...) and by the objects
+	 * stored column by column (all the time in, then all the time out...).
+	 * @param fileName The path to the cache file
+	 * @param sourceFileName The path to the file the content was imported from
+	 * @return True if the cache saved well, false otherwise
+	 */
+	bool writeCacheFile(const QString &fileName, const QString &sourceFileName);
+	/**
+	 * @brief Read the document content from a binary cache file
+	 * @param fileName The path to the cache file
+	 * @param sourceFileName The path to the file the content was imported from
+	 * @return False if the cache is missing, invalid or older than the source file
+	 */
+	bool readCacheFile(const QString &fileName, const QString &sourceFileName);
 	/**
 	 * @brief Save the PhStripDoc to a strip file
 	 * @param fileName Path to the stripfile
@@ -468,6 +558,23 @@ private:
 	 */
 	QList<PhStripDetect *> _detects;
 
+	/**
+	 * Longest duration of the texts and detects lists,
+	 * used to bound the visibility queries.
+	 */
+	PhTime _maxText1Duration, _maxText2Duration, _maxDetectDuration;
+
+	/**
+	 * The texts of the main list sorted by time in for each people
+	 */
+	QMap<PhPeople *, QList<PhStripText *> > _peopleTexts;
+
+	void buildIndex();
+
+	bool importCachedFile(const QString &fileName, const QString &type);
+	bool readSyn6Database(QSqlDatabase &db);
+	bool _cacheEnabled;
+
 	PhTime ComputeDrbTime1(PhTime offset, PhTime value, PhTimeCodeType tcType);
 	PhTime ComputeDrbTime2(PhTime offset, PhTime value, PhTimeCodeType tcType);
 
@@ -493,14 +600,18 @@ private:
 	unsigned short _mosNextTag;
 	QMap<unsigned short, MosTag> _mosTagMap;
 
-	bool checkMosTag2(QFile &f, int level, QString expected);
-	bool checkMosTag(QFile &f, int level, MosTag expectedTag);
-	PhTime readMosTime(QFile &f, PhTimeCodeType tcType, int level);
-	PhStripText *readMosText(QFile &f, PhTimeCodeType tcType, int textLevel, int internLevel);
-	PhStripDetect *readMosDetect(QFile &f, PhTimeCodeType tcType, int detectLevel, int internLevel);
-	bool readMosProperties(QFile &f, int level);
-	MosTag readMosTag(QFile &f, int level, QString name);
-	bool readMosTrack(QFile &f, PhTimeCodeType tcType, QMap<int, PhPeople*> peopleMap, QMap<int, int> peopleTrackMap, int blocLevel, int textLevel, int detectLevel, int labelLevel, int level, int internLevel);
+	void readDetXHeader(QXmlStreamReader &xml, PhTimeCodeType tcType);
+	void readDetXLine(QXmlStreamReader &xml, PhTimeCodeType tcType, const QMap<QString, PhPeople *> &peopleMap, QMultiMap<QString, PhStripPeopleObject *> &pendingRoles);
+
+	bool checkMosTag2(PhBinaryReader &reader, int level, const char *expected);
+	bool checkMosTag(PhBinaryReader &reader, int level, MosTag expectedTag);
+	PhTime readMosTime(PhBinaryReader &reader, PhTimeCodeType tcType, int level);
+	PhStripText *readMosText(PhBinaryReader &reader, PhTimeCodeType tcType, int textLevel, int internLevel);
+	PhStripDetect *readMosDetect(PhBinaryReader &reader, PhTimeCodeType tcType, int detectLevel, int internLevel);
+	bool readMosProperties(PhBinaryReader &reader, int level);
+	MosTag readMosTag(PhBinaryReader &reader, int level, const char *name);
+	bool readMosFile(PhBinaryReader &reader);
+	bool readMosTrack(PhBinaryReader &reader, PhTimeCodeType tcType, QMap<int, PhPeople*> peopleMap, QMap<int, int> peopleTrackMap, int blocLevel, int textLevel, int detectLevel, int labelLevel, int level, int internLevel);
 	bool _videoForceRatio169;
 	bool _modified;
 };
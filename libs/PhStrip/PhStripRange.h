@@ -0,0 +1,76 @@
+/**
+ * @file
+ * @copyright (C) 2012-2014 Phonations
+ * @license http://www.gnu.org/licenses/gpl.html GPL version 2 or higher
+ */
+
+#ifndef PHSTRIPRANGE_H
+#define PHSTRIPRANGE_H
+
+#include <QList>
+
+/**
+ * @brief A view on a contiguous part of a sorted strip object list
+ *
+ * It only holds two iterators on the document list so that it can
+ * be returned and iterated (with foreach or a range based for)
+ * without copying the objects. The view is invalidated as soon as
+ * the document is modified.
+ */
+template <class T>
+class PhStripRange
+{
+public:
+	/**
+	 * @brief The iterator type
+	 */
+	typedef typename QList<T *>::const_iterator const_iterator;
+
+	/**
+	 * @brief PhStripRange constructor
+	 * @param begin The first object of the range
+	 * @param end The object following the last object of the range
+	 */
+	PhStripRange(const_iterator begin, const_iterator end) :
+		_begin(begin),
+		_end(end)
+	{
+	}
+
+	/**
+	 * @brief The first object of the range
+	 * @return An iterator
+	 */
+	const_iterator begin() const {
+		return _begin;
+	}
+
+	/**
+	 * @brief The object following the last object of the range
+	 * @return An iterator
+	 */
+	const_iterator end() const {
+		return _end;
+	}
+
+	/**
+	 * @brief The number of object in the range
+	 * @return An integer
+	 */
+	int count() const {
+		return _end - _begin;
+	}
+
+	/**
+	 * @brief Check if the range is empty
+	 * @return True if the range contains no object
+	 */
+	bool isEmpty() const {
+		return _begin == _end;
+	}
+
+private:
+	const_iterator _begin, _end;
+};
+
+#endif // PHSTRIPRANGE_H
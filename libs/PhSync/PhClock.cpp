@@ -9,7 +9,15 @@
 #include "PhClock.h"
 
 PhClock::PhClock() :
-	QObject(NULL), _time(0), _rate(0.0)
+	QObject(NULL), _time(0), _rate(0.0),
+	_remainder(0),
+	_lastUpdateNsecs(0),
+	_reference(NULL),
+	_lastReferenceTime(0),
+	_state(NULL),
+	_stateSampled(false),
+	_lastStateRate(0),
+	_timestamp(0)
 {
 	qRegisterMetaType<PhTime>("PhTime");
 	qRegisterMetaType<PhFrame>("PhFrame");
@@ -18,16 +26,34 @@ PhClock::PhClock() :
 }
 
 void PhClock::setTime(qint64 time)
+{
+	_remainder = 0;
+	changeTime(time, PhClockState::now());
+}
+
+void PhClock::changeTime(PhTime time, qint64 timestamp)
 {
 	if (_time != time) {
 		_time = time;
+		_timestamp = timestamp;
 		emit timeChanged(time);
 	}
 }
 
 void PhClock::setRate(PhRate rate)
+{
+	// The producer of the state is asked for the new rate
+	if(_state && (_rate != rate))
+		_state->requestRate(rate);
+	changeRate(rate);
+}
+
+void PhClock::changeRate(PhRate rate)
 {
 	if (_rate != rate) {
+		// The time elapsed so far is accounted at the previous rate
+		if(_elapsedTimer.isValid() || _reference)
+			update();
 		_rate = rate;
 		emit rateChanged(rate);
 	}
@@ -65,7 +91,72 @@ QString PhClock::timeCode(PhTimeCodeType tcType)
 
 void PhClock::tick(PhTimeScale frequence)
 {
-	int elapsed = 24000 / frequence;
-	this->setTime(static_cast<int>(_time + elapsed * _rate));
+	advance(24000.0 / frequence);
+}
+
+void PhClock::elapse(PhTime elapsed)
+{
+	advance(elapsed);
+}
+
+void PhClock::setReference(PhClock *reference)
+{
+	_reference = reference;
+	if(_reference)
+		_lastReferenceTime = _reference->time();
+	_elapsedTimer.invalidate();
+}
+
+void PhClock::update()
+{
+	if(_reference) {
+		PhTime referenceTime = _reference->time();
+		PhTime elapsed = referenceTime - _lastReferenceTime;
+		_lastReferenceTime = referenceTime;
+		advance(elapsed);
+		return;
+	}
+
+	if(!_elapsedTimer.isValid()) {
+		_elapsedTimer.start();
+		_lastUpdateNsecs = 0;
+		return;
+	}
+
+	qint64 nsecs = _elapsedTimer.nsecsElapsed();
+	advance((nsecs - _lastUpdateNsecs) * 24000.0 / 1000000000.0);
+	_lastUpdateNsecs = nsecs;
+}
+
+void PhClock::advance(double elapsed)
+{
+	// The fraction of PhTime unit is kept for the next advance
+	double delta = elapsed * _rate + _remainder;
+	PhTime step = static_cast<PhTime>(delta);
+	_remainder = delta - step;
+	changeTime(_time + step, PhClockState::now());
+}
+
+void PhClock::setState(const PhClockState *state)
+{
+	_state = state;
+	_stateSampled = false;
 }
 
+void PhClock::sample()
+{
+	if(_state) {
+		PhTime time;
+		PhRate rate;
+		qint64 timestamp;
+		_state->read(&time, &rate, &timestamp);
+		// A rate set locally is kept until the producer changes its own
+		if(!_stateSampled || (rate != _lastStateRate))
+			changeRate(rate);
+		_stateSampled = true;
+		_lastStateRate = rate;
+		// The time keeps the timestamp of its arrival in the state
+		_remainder = 0;
+		changeTime(time, timestamp);
+	}
+}
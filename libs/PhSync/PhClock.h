@@ -8,14 +8,28 @@
 #define PHCLOCK_H
 
 #include <QObject>
+#include <QElapsedTimer>
 
 #include "PhTimeCode.h"
+#include "PhClockState.h"
 
 /**
  * @brief The PhClock class modelize a clock with its current time and rate value.
  *
  * It can be synchronized through an external signal.
  * It emit a signal when its time and rate value changes.
+ *
+ * The clock can be advanced by ticks at a given frequency, by a measured
+ * elapsed time or, with update(), by the time elapsed since the previous
+ * update according to the monotonic system timer or to a reference clock.
+ * The fraction of PhTime unit resulting from the rate is accumulated so
+ * that the clock does not drift on long runs.
+ *
+ * A clock driven by another thread is slaved to a PhClockState written by
+ * that thread and copies it when sample() is called, so that its signals
+ * are always emitted in the thread of the clock. Setting the rate of such a
+ * clock requests it to the producer of the state, and the rate of the state
+ * only overrides the local one when the producer changes it.
  */
 class PhClock : public QObject
 {
@@ -85,6 +99,48 @@ public:
 	 */
 	QString timeCode(PhTimeCodeType tcType);
 
+	/**
+	 * @brief Slave the clock to a reference clock
+	 *
+	 * update() then advances the clock by the reference time elapsed
+	 * since the previous update instead of the system timer one.
+	 * @param reference A clock or NULL to use the system timer
+	 */
+	void setReference(PhClock *reference);
+
+	/**
+	 * @brief Get the reference clock
+	 * @return A clock or NULL if the system timer is used
+	 */
+	PhClock *reference() const {
+		return _reference;
+	}
+
+	/**
+	 * @brief Slave the clock to a state written by another thread
+	 * @param state A clock state or NULL
+	 */
+	void setState(const PhClockState *state);
+
+	/**
+	 * @brief Get the state the clock is slaved to
+	 * @return A clock state or NULL
+	 */
+	const PhClockState *state() const {
+		return _state;
+	}
+
+	/**
+	 * @brief Get the monotonic time of the last time change
+	 *
+	 * For a clock slaved to a state, it is the time the value
+	 * was written to the state by the producer thread.
+	 * @return A value in nanoseconds (see PhClockState::now())
+	 */
+	qint64 timestamp() const {
+		return _timestamp;
+	}
+
 signals:
 	/**
 	 * @brief emit a signal when the time changed
@@ -105,9 +161,44 @@ public slots:
 	 */
 	void tick(PhTimeScale frequence);
 
+	/**
+	 * Advance the clock by a measured elapsed time.
+	 * The clock time value is then updated accordingly to the clock rate.
+	 * @param elapsed The elapsed time
+	 */
+	void elapse(PhTime elapsed);
+
+	/**
+	 * Advance the clock by the time elapsed since the previous update.
+	 * The elapsed time is measured by the monotonic system timer or by
+	 * the reference clock (see setReference()). The first update only
+	 * starts the measure.
+	 */
+	void update();
+
+	/**
+	 * Copy the time and rate of the clock state (see setState()).
+	 * It is called once per frame by the render loop and does nothing
+	 * if the clock is not slaved to a state.
+	 */
+	void sample();
+
 private:
+	void advance(double elapsed);
+	void changeTime(PhTime time, qint64 timestamp);
+	void changeRate(PhRate rate);
+
 	PhTime _time;
 	PhRate _rate;
+	double _remainder;
+	QElapsedTimer _elapsedTimer;
+	qint64 _lastUpdateNsecs;
+	PhClock *_reference;
+	PhTime _lastReferenceTime;
+	const PhClockState *_state;
+	bool _stateSampled;
+	PhRate _lastStateRate;
+	qint64 _timestamp;
 };
 
 #endif // PHCLOCK_H
@@ -0,0 +1,147 @@
+/**
+ * @file
+ * @copyright (C) 2012-2014 Phonations
+ * @license http://www.gnu.org/licenses/gpl.html GPL version 2 or higher
+ */
+
+#include <cstring>
+
+#include <QElapsedTimer>
+
+#include "PhClockState.h"
+
+static inline qint64 bitsFromRate(PhRate rate)
+{
+	qint64 bits;
+	memcpy(&bits, &rate, sizeof(bits));
+	return bits;
+}
+
+static inline PhRate rateFromBits(qint64 bits)
+{
+	PhRate rate;
+	memcpy(&rate, &bits, sizeof(rate));
+	return rate;
+}
+
+PhClockState::PhClockState() :
+	_sequence(0),
+	_time(0),
+	_rate(bitsFromRate(0)),
+	_timestamp(0),
+	_requestedRate(bitsFromRate(0)),
+	_requestSerial(0),
+	_takenSerial(0)
+{
+}
+
+static QElapsedTimer startedTimer()
+{
+	QElapsedTimer timer;
+	timer.start();
+	return timer;
+}
+
+qint64 PhClockState::now()
+{
+	static const QElapsedTimer timer = startedTimer();
+	return timer.nsecsElapsed();
+}
+
+void PhClockState::beginWrite()
+{
+	// Several threads may write the same state (the pause detection of
+	// the midi reader runs beside the midi thread): the writer which
+	// makes the counter odd owns the state until it makes it even again.
+	while(true) {
+		int sequence = _sequence.loadAcquire();
+		if(((sequence & 1) == 0) && _sequence.testAndSetOrdered(sequence, sequence + 1))
+			break;
+	}
+}
+
+void PhClockState::endWrite()
+{
+	_sequence.fetchAndAddRelease(1);
+}
+
+void PhClockState::write(PhTime time, PhRate rate)
+{
+	qint64 timestamp = now();
+	beginWrite();
+	_time.store(time);
+	_rate.store(bitsFromRate(rate));
+	_timestamp.store(timestamp);
+	endWrite();
+}
+
+void PhClockState::writeTime(PhTime time)
+{
+	qint64 timestamp = now();
+	beginWrite();
+	_time.store(time);
+	_timestamp.store(timestamp);
+	endWrite();
+}
+
+void PhClockState::writeRate(PhRate rate)
+{
+	qint64 timestamp = now();
+	beginWrite();
+	_rate.store(bitsFromRate(rate));
+	_timestamp.store(timestamp);
+	endWrite();
+}
+
+void PhClockState::read(PhTime *time, PhRate *rate, qint64 *timestamp) const
+{
+	QAtomicInt &sequenceCounter = const_cast<QAtomicInt &>(_sequence);
+	while(true) {
+		int sequence = sequenceCounter.loadAcquire();
+		if(sequence & 1)
+			continue;
+		PhTime t = _time.load();
+		qint64 r = _rate.load();
+		qint64 ts = _timestamp.load();
+		// The read-modify-write keeps the loads above before the check
+		if(sequenceCounter.fetchAndAddOrdered(0) == sequence) {
+			if(time)
+				*time = t;
+			if(rate)
+				*rate = rateFromBits(r);
+			if(timestamp)
+				*timestamp = ts;
+			return;
+		}
+	}
+}
+
+void PhClockState::requestRate(PhRate rate) const
+{
+	_requestedRate.store(bitsFromRate(rate));
+	_requestSerial.fetchAndAddRelease(1);
+}
+
+bool PhClockState::takeRequestedRate(PhRate *rate)
+{
+	int serial = _requestSerial.loadAcquire();
+	if(serial == _takenSerial)
+		return false;
+	_takenSerial = serial;
+	*rate = rateFromBits(_requestedRate.load());
+	return true;
+}
+
+PhTime PhClockState::time() const
+{
+	PhTime time;
+	read(&time, NULL);
+	return time;
+}
+
+PhRate PhClockState::rate() const
+{
+	PhRate rate;
+	read(NULL, &rate);
+	return rate;
+}
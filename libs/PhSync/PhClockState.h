@@ -0,0 +1,119 @@
+/**
+ * @file
+ * @copyright (C) 2012-2014 Phonations
+ * @license http://www.gnu.org/licenses/gpl.html GPL version 2 or higher
+ */
+
+#ifndef PHCLOCKSTATE_H
+#define PHCLOCKSTATE_H
+
+#include <QAtomicInt>
+#include <QAtomicInteger>
+
+#include "PhTime.h"
+
+/**
+ * @brief The time, rate and timestamp of a clock shared between threads
+ *
+ * The state is written by the real time threads decoding a synchronization
+ * signal (audio callback, serial port or midi thread) without lock,
+ * allocation or signal, and read once per frame by the render thread
+ * (see PhClock::sample()).
+ *
+ * It is protected by a sequence counter: a writer makes the counter odd
+ * while it stores the values and a reader retries until it reads the same
+ * even counter before and after loading them.
+ *
+ * The state also carries a rate request from its readers back to its
+ * producer (the play/pause of the application sent to the sony protocol):
+ * the producer takes it with takeRequestedRate() and publishes the
+ * resulting rate with the next write.
+ */
+class PhClockState
+{
+public:
+	/**
+	 * @brief PhClockState constructor
+	 */
+	PhClockState();
+
+	/**
+	 * @brief Store a new time and rate
+	 * @param time The time
+	 * @param rate The rate
+	 */
+	void write(PhTime time, PhRate rate);
+
+	/**
+	 * @brief Store a new time and keep the rate
+	 * @param time The time
+	 */
+	void writeTime(PhTime time);
+
+	/**
+	 * @brief Store a new rate and keep the time
+	 * @param rate The rate
+	 */
+	void writeRate(PhRate rate);
+
+	/**
+	 * @brief Read a consistent copy of the state
+	 * @param time The time
+	 * @param rate The rate
+	 * @param timestamp The monotonic time of the last write in nanoseconds (see now())
+	 */
+	void read(PhTime *time, PhRate *rate, qint64 *timestamp = NULL) const;
+
+	/**
+	 * @brief Get the time of the last write
+	 * @return A time value
+	 */
+	PhTime time() const;
+
+	/**
+	 * @brief Get the rate of the last write
+	 * @return A rate value
+	 */
+	PhRate rate() const;
+
+	/**
+	 * @brief Ask the producer of the state for a new rate
+	 *
+	 * It is called by the reader thread. A request which was not
+	 * taken yet by the producer is replaced.
+	 * @param rate The rate
+	 */
+	void requestRate(PhRate rate) const;
+
+	/**
+	 * @brief Take the last rate requested by the readers
+	 *
+	 * It is called by the producer thread.
+	 * @param rate The requested rate
+	 * @return True if a new rate was requested since the previous call
+	 */
+	bool takeRequestedRate(PhRate *rate);
+
+	/**
+	 * @brief Get the monotonic time the states are stamped with
+	 * @return A value in nanoseconds
+	 */
+	static qint64 now();
+
+private:
+	void beginWrite();
+	void endWrite();
+
+	QAtomicInt _sequence;
+	QAtomicInteger<qint64> _time;
+	/** @brief The bits of the PhRate value */
+	QAtomicInteger<qint64> _rate;
+	QAtomicInteger<qint64> _timestamp;
+
+	// The request slot is written by the readers of a const state
+	mutable QAtomicInteger<qint64> _requestedRate;
+	mutable QAtomicInt _requestSerial;
+	int _takenSerial;
+};
+
+#endif // PHCLOCKSTATE_H
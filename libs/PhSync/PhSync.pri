@@ -8,10 +8,15 @@ HEADERS += \
 	$$TOP_ROOT/libs/PhSync/PhTime.h \
 	$$TOP_ROOT/libs/PhSync/PhTimeCode.h \
 	$$TOP_ROOT/libs/PhSync/PhClock.h \
-	$$TOP_ROOT/libs/PhSync/PhSynchronizer.h
+	$$TOP_ROOT/libs/PhSync/PhClockState.h \
+	$$TOP_ROOT/libs/PhSync/PhSyncFilter.h \
+	$$TOP_ROOT/libs/PhSync/PhSynchronizer.h \
+	$$TOP_ROOT/libs/PhSync/PhSynchronizerSettings.h
 
 SOURCES += \
 	$$TOP_ROOT/libs/PhSync/PhTimeCode.cpp \
 	$$TOP_ROOT/libs/PhSync/PhClock.cpp \
+	$$TOP_ROOT/libs/PhSync/PhClockState.cpp \
+	$$TOP_ROOT/libs/PhSync/PhSyncFilter.cpp \
 	$$TOP_ROOT/libs/PhSync/PhSynchronizer.cpp
 
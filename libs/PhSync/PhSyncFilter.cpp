@@ -0,0 +1,78 @@
+/**
+ * @file
+ * @copyright (C) 2012-2014 Phonations
+ * @license http://www.gnu.org/licenses/gpl.html GPL version 2 or higher
+ */
+
+#include <QtGlobal>
+#include <cmath>
+
+#include "PhSyncFilter.h"
+
+/** @brief The fraction of the error applied to the position */
+#define PHSYNCFILTER_ALPHA 0.2
+/** @brief The fraction of the error applied to the rate (critically damped) */
+#define PHSYNCFILTER_BETA (PHSYNCFILTER_ALPHA * PHSYNCFILTER_ALPHA / (2 - PHSYNCFILTER_ALPHA))
+/** @brief The maximum deviation of the estimated rate from the nominal one */
+#define PHSYNCFILTER_MAX_DRIFT 0.1
+
+static inline double elapsedTime(qint64 from, qint64 to)
+{
+	return (to - from) * 24000.0 / 1000000000.0;
+}
+
+PhSyncFilter::PhSyncFilter() :
+	_valid(false),
+	_position(0),
+	_rate(0),
+	_nominalRate(0),
+	_timestamp(0),
+	_resetThreshold(10000)
+{
+}
+
+void PhSyncFilter::reset()
+{
+	_valid = false;
+}
+
+void PhSyncFilter::start(PhTime time, PhRate rate, qint64 timestamp)
+{
+	_valid = true;
+	_position = time;
+	_rate = rate;
+	_nominalRate = rate;
+	_timestamp = timestamp;
+}
+
+void PhSyncFilter::addSample(PhTime time, PhRate rate, qint64 timestamp)
+{
+	if(!_valid || (rate != _nominalRate) || (rate == 0)) {
+		start(time, rate, timestamp);
+		return;
+	}
+
+	double elapsed = elapsedTime(_timestamp, timestamp);
+	if(elapsed <= 0) {
+		_position = time;
+		return;
+	}
+
+	double predicted = _position + _rate * elapsed;
+	double error = time - predicted;
+	if(qAbs(error) > _resetThreshold) {
+		start(time, rate, timestamp);
+		return;
+	}
+
+	_position = predicted + PHSYNCFILTER_ALPHA * error;
+	_rate += PHSYNCFILTER_BETA * error / elapsed;
+	double maxDrift = qAbs(_nominalRate) * PHSYNCFILTER_MAX_DRIFT;
+	_rate = qBound(_nominalRate - maxDrift, _rate, _nominalRate + maxDrift);
+	_timestamp = timestamp;
+}
+
+PhTime PhSyncFilter::position(qint64 timestamp) const
+{
+	return static_cast<PhTime>(std::floor(_position + _rate * elapsedTime(_timestamp, timestamp) + 0.5));
+}
@@ -0,0 +1,88 @@
+/**
+ * @file
+ * @copyright (C) 2012-2014 Phonations
+ * @license http://www.gnu.org/licenses/gpl.html GPL version 2 or higher
+ */
+
+#ifndef PHSYNCFILTER_H
+#define PHSYNCFILTER_H
+
+#include "PhTime.h"
+
+/**
+ * @brief Estimate the position and rate of an external synchronization signal
+ *
+ * The timecodes decoded from a synchronization signal arrive with the
+ * jitter of the audio buffers, the serial port or the midi driver.
+ * The filter is a second order phase locked loop (alpha-beta filter):
+ * each timestamped sample corrects the predicted position and the rate
+ * by a fraction of the prediction error, so that the estimated position
+ * can be interpolated smoothly at any time between two samples.
+ *
+ * The filter restarts from the sample when the nominal rate changes or
+ * when the error is above the reset threshold (the deck has been cued).
+ */
+class PhSyncFilter
+{
+public:
+	/**
+	 * @brief PhSyncFilter constructor
+	 */
+	PhSyncFilter();
+
+	/**
+	 * @brief Forget the previous samples
+	 */
+	void reset();
+
+	/**
+	 * @brief Add a sample of the synchronization signal
+	 * @param time The decoded time
+	 * @param rate The nominal rate of the signal
+	 * @param timestamp The monotonic time at which the time was decoded in nanoseconds
+	 */
+	void addSample(PhTime time, PhRate rate, qint64 timestamp);
+
+	/**
+	 * @brief Check if the filter has received a sample
+	 * @return True if a position can be estimated, false otherwise
+	 */
+	bool isValid() const {
+		return _valid;
+	}
+
+	/**
+	 * @brief Get the estimated position
+	 * @param timestamp A monotonic time in nanoseconds
+	 * @return The position of the signal at the given time
+	 */
+	PhTime position(qint64 timestamp) const;
+
+	/**
+	 * @brief Get the estimated rate
+	 * @return A rate value
+	 */
+	PhRate rate() const {
+		return _rate;
+	}
+
+	/**
+	 * @brief Set the prediction error above which the filter restarts
+	 * @param threshold A time value
+	 */
+	void setResetThreshold(PhTime threshold) {
+		_resetThreshold = threshold;
+	}
+
+private:
+	void start(PhTime time, PhRate rate, qint64 timestamp);
+
+	bool _valid;
+	double _position;
+	PhRate _rate;
+	PhRate _nominalRate;
+	qint64 _timestamp;
+	PhTime _resetThreshold;
+};
+
+#endif // PHSYNCFILTER_H
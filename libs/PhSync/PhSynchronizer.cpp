@@ -7,8 +7,15 @@
 #include "PhTools/PhDebug.h"
 #include "PhSynchronizer.h"
 
-PhSynchronizer::PhSynchronizer()
-	: _syncType(NoSync),
+/** @brief The fraction of the error corrected at each strip time change */
+#define PHSYNCHRONIZER_SLEW_GAIN 4
+/** @brief The maximum correction relatively to the strip time change */
+#define PHSYNCHRONIZER_MAX_SLEW 10
+
+PhSynchronizer::PhSynchronizer(PhSynchronizerSettings *settings)
+	: _settings(settings),
+	_lastStripTime(0),
+	_syncType(NoSync),
 	_stripClock(NULL),
 	_videoClock(NULL),
 	_syncClock(NULL),
@@ -25,6 +32,7 @@ void PhSynchronizer::setStripClock(PhClock *clock)
 {
 	_stripClock = clock;
 	if(clock) {
+		_lastStripTime = clock->time();
 		connect(_stripClock, &PhClock::timeChanged, this, &PhSynchronizer::onStripTimeChanged);
 		connect(_stripClock, &PhClock::rateChanged, this, &PhSynchronizer::onStripRateChanged);
 	}
@@ -41,33 +49,77 @@ void PhSynchronizer::setVideoClock(PhClock *clock)
 
 void PhSynchronizer::setSyncClock(PhClock *clock, SyncType type)
 {
+	if(_syncClock)
+		disconnect(_syncClock, 0, this, 0);
 	_syncClock = clock;
 	_syncType = type;
+	_syncFilter.reset();
+	// The slew is bounded by the strip time change from now on
+	if(_stripClock)
+		_lastStripTime = _stripClock->time();
 	if(_syncClock) {
 		connect(_syncClock, &PhClock::timeChanged, this, &PhSynchronizer::onSyncTimeChanged);
 		connect(_syncClock, &PhClock::rateChanged, this, &PhSynchronizer::onSyncRateChanged);
 	}
 }
 
+PhTime PhSynchronizer::correctionThreshold()
+{
+	if(_settings)
+		return _settings->synchroCorrectionThreshold();
+	return 1000;
+}
+
+PhTime PhSynchronizer::jumpThreshold()
+{
+	if(_settings)
+		return _settings->synchroJumpThreshold();
+	return 10000;
+}
+
+PhTime PhSynchronizer::syncTime()
+{
+	// The position of a playing signal is interpolated between two timecodes
+	if(_syncFilter.isValid() && (_syncClock->rate() != 0))
+		return _syncFilter.position(PhClockState::now());
+	return _syncClock->time();
+}
+
 void PhSynchronizer::onStripTimeChanged(PhTime time)
 {
 	if(!_settingStripTime) {
 		PHDBG(2) << time;
 		if(_syncClock) {
-			// Apply precise correction.
 			// We don't change sony clock because this would desynchronize the sony master.
-#warning /// @todo Make the error a settings
-			if(qAbs(time - _syncClock->time()) > 1000) {
-				PHDEBUG << "correct :" << _stripClock->time() << _syncClock->time();
+			PhTime error = syncTime() - time;
+			PhTime correction = 0;
+			if(_stripClock->rate() == 0) {
+				// Apply precise correction.
+				if(qAbs(error) > correctionThreshold())
+					correction = error;
+			}
+			else if(qAbs(error) > jumpThreshold())
+				correction = error;
+			else if(qAbs(time - _lastStripTime) <= jumpThreshold()) {
+				// Slew the strip toward the estimated position
+				PhTime maxCorrection = qAbs(time - _lastStripTime) / PHSYNCHRONIZER_MAX_SLEW;
+				correction = qBound(-maxCorrection, error / PHSYNCHRONIZER_SLEW_GAIN, maxCorrection);
+			}
+			// Otherwise the strip was moved outside of the synchronizer (a seek)
+			// and the slew starts again from the new strip time
+
+			if(correction != 0) {
+				PHDBG(2) << "correct :" << time << correction;
 				_settingStripTime = true;
-				_stripClock->setTime(_syncClock->time());
+				_stripClock->setTime(time + correction);
 				_settingStripTime = false;
 			}
 		}
+		_lastStripTime = _stripClock->time();
 
 		if(_syncType != Sony) {
 			_settingVideoTime = true;
-			_videoClock->setTime(time);
+			_videoClock->setTime(_stripClock->time());
 			_settingVideoTime = false;
 		}
 	}
@@ -102,20 +154,24 @@ void PhSynchronizer::onSyncTimeChanged(PhTime time)
 {
 	if(!_settingSonyTime) {
 		PHDBG(3) << time;
+		_syncFilter.setResetThreshold(correctionThreshold());
+		_syncFilter.addSample(time, _syncClock->rate(), _syncClock->timestamp());
+
 		if(_syncType == Sony) {
 			_settingVideoTime = true;
 			_videoClock->setTime(time);
 			_settingVideoTime = false;
 		}
 		// We apply correction here only when there is a significant change of sony time.
-		// Precise correction occurs in onStripTimeChanged() that is called after
-		// on SonyTimeChanged (see VideoStripView::paint()).
+		// The strip is slewed in onStripTimeChanged() that is called after
+		// onSyncTimeChanged() (see PhGraphicView::paintGL()).
 		PhTime error = qAbs(time - _stripClock->time());
-		if((error > 10000) || ((_stripClock->rate() == 0) && (error > 0))) {
+		if((error > jumpThreshold()) || ((_stripClock->rate() == 0) && (error > 0))) {
 			PHDEBUG << "correct error:" << time << _stripClock->time();
 			_settingStripTime = true;
 			_stripClock->setTime(time);
 			_settingStripTime = false;
+			_lastStripTime = time;
 		}
 	}
 }
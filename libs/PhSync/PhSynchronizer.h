@@ -10,9 +10,16 @@
 #include <QObject>
 
 #include "PhSync/PhClock.h"
+#include "PhSync/PhSyncFilter.h"
+#include "PhSync/PhSynchronizerSettings.h"
 
 /**
  * @brief Provide a synchronisation system between the strip, the video and the external sync signal
+ *
+ * The timecodes of the synchronization clock are filtered by a PhSyncFilter
+ * which estimates the position of the external signal between two timecodes.
+ * A playing strip is slewed smoothly toward this position and only jumps
+ * when the error is above the jump threshold (a cue of the external deck).
  */
 class PhSynchronizer : public QObject
 {
@@ -28,7 +35,11 @@ public:
 		MTC = 3,
 	};
 
-	PhSynchronizer();
+	/**
+	 * @brief PhSynchronizer constructor
+	 * @param settings The settings or NULL to use the default thresholds
+	 */
+	explicit PhSynchronizer(PhSynchronizerSettings *settings = NULL);
 
 	/**
 	 * @brief Set the strip clock
@@ -81,6 +92,13 @@ private slots:
 	void onSyncTimeChanged(PhTime time);
 	void onSyncRateChanged(PhRate rate);
 private:
+	PhTime correctionThreshold();
+	PhTime jumpThreshold();
+	PhTime syncTime();
+
+	PhSynchronizerSettings *_settings;
+	PhSyncFilter _syncFilter;
+	PhTime _lastStripTime;
 	int _syncType;
 	PhClock * _stripClock;
 	PhClock * _videoClock;
@@ -0,0 +1,33 @@
+/**
+ * @file
+ * @copyright (C) 2012-2014 Phonations
+ * @license http://www.gnu.org/licenses/gpl.html GPL version 2 or higher
+ */
+
+#ifndef PHSYNCHRONIZERSETTINGS_H
+#define PHSYNCHRONIZERSETTINGS_H
+
+/**
+ * @brief The PhSynchronizer settings
+ */
+class PhSynchronizerSettings
+{
+public:
+	/**
+	 * @brief The error above which the synchronization time is discontinuous
+	 *
+	 * A paused strip is then corrected and the synchronization filter restarts.
+	 * @return A time value
+	 */
+	virtual int synchroCorrectionThreshold() = 0;
+
+	/**
+	 * @brief The error above which a playing strip jumps to the synchronization time
+	 *
+	 * Below this value, the strip is slewed smoothly toward the estimated position.
+	 * @return A time value
+	 */
+	virtual int synchroJumpThreshold() = 0;
+};
+
+#endif // PHSYNCHRONIZERSETTINGS_H
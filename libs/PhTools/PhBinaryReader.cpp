@@ -0,0 +1,181 @@
+/**
+ * @file
+ * @copyright (C) 2012-2014 Phonations
+ * @license http://www.gnu.org/licenses/gpl.html GPL version 2 or higher
+ */
+
+#include <QStringList>
+#include <QVector>
+#include <QtEndian>
+
+#include "PhDebug.h"
+#include "PhBinaryReader.h"
+
+PhBinaryReader::PhBinaryReader() :
+	_data(NULL),
+	_size(0),
+	_pos(0),
+	_error(false)
+{
+}
+
+PhBinaryReader::~PhBinaryReader()
+{
+	close();
+}
+
+bool PhBinaryReader::open(const QString &fileName)
+{
+	close();
+
+	_file.setFileName(fileName);
+	if(!_file.open(QFile::ReadOnly))
+		return false;
+
+	_size = _file.size();
+	if(_size > 0) {
+		_data = _file.map(0, _size);
+		if(_data == NULL) {
+			PHDEBUG << "Unable to map" << fileName << ":" << _file.errorString();
+			_buffer = _file.readAll();
+			_data = reinterpret_cast<const uchar *>(_buffer.constData());
+			_size = _buffer.size();
+		}
+	}
+
+	return true;
+}
+
+void PhBinaryReader::close()
+{
+	if(_file.isOpen()) {
+		if(_data && (_data != reinterpret_cast<const uchar *>(_buffer.constData())))
+			_file.unmap(const_cast<uchar *>(_data));
+		_file.close();
+	}
+	_buffer.clear();
+	_data = NULL;
+	_size = 0;
+	_pos = 0;
+	_error = false;
+}
+
+bool PhBinaryReader::seek(qint64 pos)
+{
+	if((pos < 0) || (pos > _size))
+		return false;
+	_pos = pos;
+	return true;
+}
+
+const uchar *PhBinaryReader::take(qint64 count, const char *name)
+{
+	if((count < 0) || (count > _size - _pos)) {
+		if(!_error)
+			PHDEBUG << "Unable to read" << count << "bytes at" << PHNQ(QString::number(_pos, 16)) << "for" << name;
+		_error = true;
+		return NULL;
+	}
+	const uchar *data = _data + _pos;
+	_pos += count;
+	return data;
+}
+
+unsigned char PhBinaryReader::readChar(int level, const char *name)
+{
+	qint64 offset = _pos;
+	const uchar *data = take(1, name);
+	unsigned char result = data ? *data : 0;
+	PHDBG(level) << PHNQ(QString::number(offset, 16)) << name << PHNQ(QString::number(result, 16));
+	return result;
+}
+
+unsigned short PhBinaryReader::readShort(int level, const char *name)
+{
+	qint64 offset = _pos;
+	const uchar *data = take(2, name);
+	unsigned short result = data ? qFromLittleEndian<quint16>(data) : 0;
+	PHDBG(level) << PHNQ(QString::number(offset, 16)) << name << PHNQ(QString::number(result, 16));
+	return result;
+}
+
+int PhBinaryReader::readInt(int level, const char *name)
+{
+	qint64 offset = _pos;
+	const uchar *data = take(4, name);
+	int result = data ? qFromLittleEndian<qint32>(data) : 0;
+	PHDBG(level) << PHNQ(QString::number(offset, 16)) << name << result;
+	return result;
+}
+
+qint64 PhBinaryReader::readInt64(int level, const char *name)
+{
+	qint64 offset = _pos;
+	const uchar *data = take(8, name);
+	qint64 result = data ? qFromLittleEndian<qint64>(data) : 0;
+	PHDBG(level) << PHNQ(QString::number(offset, 16)) << name << result;
+	return result;
+}
+
+const uchar *PhBinaryReader::readData(qint64 count, int level, const char *name)
+{
+	qint64 offset = _pos;
+	const uchar *data = take(count, name);
+	PHDBG(level) << PHNQ(QString::number(offset, 16)) << name << count << "bytes";
+	return data;
+}
+
+QString PhBinaryReader::readString(int level, const char *name)
+{
+	int internLevel = 4;
+	qint64 offset = _pos;
+	int size = readShort(internLevel);
+	bool wide = true;
+
+	switch(size) {
+	case 0xfeff:
+		readChar(internLevel);
+		size = readChar(internLevel);
+		if(size == 0xff) {
+			size = readShort(internLevel);
+			if(size == 0xffff)
+				size = readInt(internLevel);
+		}
+		break;
+	case 0xffff:
+		size = readShort(internLevel);
+		break;
+	default:
+		wide = false;
+		break;
+	}
+
+	QString result;
+	if(wide) {
+		const uchar *data = take(2 * qint64(size), name);
+		if(data) {
+#if Q_BYTE_ORDER == Q_LITTLE_ENDIAN
+			result = QString::fromUtf16(reinterpret_cast<const ushort *>(data), size);
+#else
+			QVector<ushort> utf16(size);
+			for(int i = 0; i < size; i++)
+				utf16[i] = qFromLittleEndian<quint16>(data + 2 * i);
+			result = QString::fromUtf16(utf16.constData(), size);
+#endif
+		}
+	}
+	else {
+		const uchar *data = take(size, name);
+		if(data)
+			result = QString::fromLatin1(reinterpret_cast<const char *>(data), size);
+	}
+
+	QStringList resultSplit = result.split("\r\n");
+	if(resultSplit.count() > 3) {
+		result = resultSplit.first() + "\r\n...\r\n" + resultSplit.last();
+	}
+
+	PHDBG(level) << PHNQ(QString::number(offset, 16)) << name << result << "(" << PHNQ(QString::number(size, 16)) << ")";
+
+	return result;
+}
@@ -0,0 +1,155 @@
+/**
+ * @file
+ * @copyright (C) 2012-2014 Phonations
+ * @license http://www.gnu.org/licenses/gpl.html GPL version 2 or higher
+ */
+
+#ifndef PHBINARYREADER_H
+#define PHBINARYREADER_H
+
+#include <QFile>
+#include <QByteArray>
+
+/**
+ * @brief A cursor over a binary file
+ *
+ * The file is memory mapped (or read at once if it cannot be mapped)
+ * and the values are decoded in place as little endian.
+ *
+ * A read beyond the end of the file does not move the cursor:
+ * it returns a null value and sets the error flag so that
+ * the parser can stop at once.
+ *
+ * Each value is logged with its offset and its name.
+ */
+class PhBinaryReader
+{
+public:
+	/**
+	 * @brief PhBinaryReader constructor
+	 */
+	PhBinaryReader();
+
+	~PhBinaryReader();
+
+	/**
+	 * @brief Open and map a file
+	 * @param fileName The file path
+	 * @return True if succeeded, false otherwise.
+	 */
+	bool open(const QString &fileName);
+
+	/**
+	 * @brief Unmap and close the file
+	 */
+	void close();
+
+	/**
+	 * @brief Get the file size
+	 * @return A number of bytes
+	 */
+	qint64 size() const {
+		return _size;
+	}
+
+	/**
+	 * @brief Get the cursor position
+	 * @return An offset from the beginning of the file
+	 */
+	qint64 pos() const {
+		return _pos;
+	}
+
+	/**
+	 * @brief Move the cursor
+	 * @param pos An offset from the beginning of the file
+	 * @return True if the offset is inside the file, false otherwise.
+	 */
+	bool seek(qint64 pos);
+
+	/**
+	 * @brief Check if the cursor reached the end of the file
+	 * @return True if all the bytes were read
+	 */
+	bool atEnd() const {
+		return _pos >= _size;
+	}
+
+	/**
+	 * @brief Check if a read failed since the file was opened
+	 * @return True if a read went beyond the end of the file
+	 */
+	bool error() const {
+		return _error;
+	}
+
+	/**
+	 * @brief Read a single char
+	 * @param level The log level
+	 * @param name The name (for logging purpose)
+	 * @return A char
+	 */
+	unsigned char readChar(int level, const char *name = "???");
+
+	/**
+	 * @brief Read a two-bytes unsigned short
+	 * @param level The log level
+	 * @param name The name (for logging purpose)
+	 * @return An unsigned short
+	 */
+	unsigned short readShort(int level, const char *name = "???");
+
+	/**
+	 * @brief Read a four-bytes signed integer
+	 * @param level The log level
+	 * @param name The name (for logging purpose)
+	 * @return A signed int
+	 */
+	int readInt(int level, const char *name = "???");
+
+	/**
+	 * @brief Read an eight-bytes signed integer
+	 * @param level The log level
+	 * @param name The name (for logging purpose)
+	 * @return A signed 64 bits integer
+	 */
+	qint64 readInt64(int level, const char *name = "???");
+
+	/**
+	 * @brief Read a block of bytes without copying it
+	 *
+	 * The returned pointer stays valid until the file is closed.
+	 * @param count The number of bytes
+	 * @param level The log level
+	 * @param name The name (for logging purpose)
+	 * @return A pointer to the bytes or NULL if the block goes beyond the end of the file
+	 */
+	const uchar *readData(qint64 count, int level, const char *name = "???");
+
+	/**
+	 * @brief Read a string
+	 *
+	 * The readString method assumes that the string starts with its size
+	 * and is followed by the character data.
+	 * If the size is 0xFFFF or 0xFEFF, the real size follows
+	 * and a wide char string will be decoded.
+	 * @param level The log level
+	 * @param name The name (for logging purpose)
+	 * @return A string
+	 */
+	QString readString(int level, const char *name = "???");
+
+private:
+	Q_DISABLE_COPY(PhBinaryReader)
+
+	const uchar *take(qint64 count, const char *name);
+
+	QFile _file;
+	QByteArray _buffer;
+	const uchar *_data;
+	qint64 _size;
+	qint64 _pos;
+	bool _error;
+};
+
+#endif // PHBINARYREADER_H
@@ -19,7 +19,7 @@ PhDebug* PhDebug::_d = NULL;
 void PhDebug::messageOutput(QtMsgType type, const QMessageLogContext &context, const QString &msg)
 {
 	Q_UNUSED(type); Q_UNUSED(context);
-	if(instance()->_logMask & (1 << instance()->_currentLogLevel)) {
+	if(instance()->_logMask & (1 << instance()->_currentLogLevel.localData())) {
 		instance()->_mutex.lock();
 		QString logMessage = "";
 
@@ -118,13 +118,13 @@ void PhDebug::disable()
 
 QDebug PhDebug::debug(const char *fileName, int lineNumber, const char *functionName, int messageLogLevel)
 {
-	instance()->_currentLogLevel = messageLogLevel;
+	instance()->_currentLogLevel.setLocalData(messageLogLevel);
 	return QMessageLogger(fileName, lineNumber, functionName).debug();
 }
 
 QDebug PhDebug::error(const char *fileName, int lineNumber, const char *functionName)
 {
-	instance()->_currentLogLevel = 0;
+	instance()->_currentLogLevel.setLocalData(0);
 	return QMessageLogger(fileName, lineNumber, functionName).critical();
 }
 
@@ -169,6 +169,11 @@ int PhDebug::getLogMask()
 	return instance()->_logMask;
 }
 
+bool PhDebug::isLogLevelEnabled(int messageLogLevel)
+{
+	return (instance()->_logMask & (1 << messageLogLevel)) != 0;
+}
+
 QDebug operator <<(QDebug stream, const QEvent * event) {
 	static int eventEnumIndex = QEvent::staticMetaObject
 	                            .indexOfEnumerator("Type");
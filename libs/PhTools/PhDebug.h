@@ -9,12 +9,19 @@
 
 #include <QDebug>
 #include <QMutex>
+#include <QThreadStorage>
 
 /** PHERR allow to log error */
 #define PHERR PhDebug::error(__FILE__, __LINE__, __FUNCTION__)
 
-/** PHDBG allow to have a multi level log system */
-#define PHDBG(messageLogLevel) PhDebug::debug(__FILE__, __LINE__, __FUNCTION__, messageLogLevel)
+/**
+ * PHDBG allow to have a multi level log system
+ *
+ * The message is neither formatted nor output if its level does not fit the mask.
+ */
+#define PHDBG(messageLogLevel) \
+	for(bool phDebugEnabled = PhDebug::isLogLevelEnabled(messageLogLevel); phDebugEnabled; phDebugEnabled = false) \
+		PhDebug::debug(__FILE__, __LINE__, __FUNCTION__, messageLogLevel)
 
 /** PHDEBUG is the default log system */
 #define PHDEBUG PHDBG(0)
@@ -89,6 +96,14 @@ public:
 	 * @return The log mask.
 	 */
 	static int getLogMask();
+	/**
+	 * @brief Check if the messages of a log level are shown
+	 *
+	 * It is used by PHDBG to skip the formatting of a message which would be filtered.
+	 * @param messageLogLevel The log level
+	 * @return True if the level fits the mask, false otherwise.
+	 */
+	static bool isLogLevelEnabled(int messageLogLevel);
 	/**
 	 * @brief Get the log location
 	 * As the log file is with the others system & user logs, and this place
@@ -141,7 +156,8 @@ private:
 
 	static PhDebug * _d;
 	int _logMask;
-	int _currentLogLevel;
+	/** @brief The level of the message being output, for each thread */
+	QThreadStorage<int> _currentLogLevel;
 	QTextStream *_textLog;
 	QString _logFileName;
 	bool _displayDate;
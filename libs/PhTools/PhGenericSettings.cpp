@@ -3,7 +3,8 @@
 #include "PhGenericSettings.h"
 #include "PhDebug.h"
 
-PhGenericSettings::PhGenericSettings(bool clear) : _settings(ORG_NAME, APP_NAME)
+PhGenericSettings::PhGenericSettings(bool clear) : _settings(ORG_NAME, APP_NAME),
+	_version(0)
 {
 	QSettings::setDefaultFormat(QSettings::NativeFormat);
 	PHDEBUG << "Settings file:" << _settings.fileName();
@@ -13,16 +14,22 @@ PhGenericSettings::PhGenericSettings(bool clear) : _settings(ORG_NAME, APP_NAME)
 
 void PhGenericSettings::clear()
 {
+	QMutexLocker locker(&_mutex);
 	_settings.clear();
+	// The version changes once the values are written
+	_version.fetchAndAddRelease(1);
 }
 
 void PhGenericSettings::setIntValue(QString name, int value)
 {
+	QMutexLocker locker(&_mutex);
 	_settings.setValue(name, value);
+	_version.fetchAndAddRelease(1);
 }
 
 int PhGenericSettings::intValue(QString name, int defaultValue)
 {
+	QMutexLocker locker(&_mutex);
 	return _settings.value(name, defaultValue).toInt();
 }
 
@@ -37,36 +44,46 @@ int PhGenericSettings::intValueWithAlias(QString name, QString alias)
 
 void PhGenericSettings::setBoolValue(QString name, bool value)
 {
+	QMutexLocker locker(&_mutex);
 	_settings.setValue(name, value);
+	_version.fetchAndAddRelease(1);
 }
 
 bool PhGenericSettings::boolValue(QString name, bool defaultValue)
 {
+	QMutexLocker locker(&_mutex);
 	return _settings.value(name, defaultValue).toBool();
 }
 
 void PhGenericSettings::setFloatValue(QString name, float value)
 {
+	QMutexLocker locker(&_mutex);
 	_settings.setValue(name, value);
+	_version.fetchAndAddRelease(1);
 }
 
 float PhGenericSettings::floatValue(QString name, float defaultValue)
 {
+	QMutexLocker locker(&_mutex);
 	return _settings.value(name, defaultValue).toFloat();
 }
 
 void PhGenericSettings::setStringValue(QString name, QString value)
 {
+	QMutexLocker locker(&_mutex);
 	_settings.setValue(name, value);
+	_version.fetchAndAddRelease(1);
 }
 
 QString PhGenericSettings::stringValue(QString name, QString defaultValue)
 {
+	QMutexLocker locker(&_mutex);
 	return _settings.value(name, defaultValue).toString();
 }
 
 void PhGenericSettings::setStringList(QString name, QStringList list)
 {
+	QMutexLocker locker(&_mutex);
 	_settings.remove(name);
 	_settings.beginWriteArray(name);
 	for(int i = 0; i < list.size(); i++) {
@@ -74,10 +91,12 @@ void PhGenericSettings::setStringList(QString name, QStringList list)
 		_settings.setValue("listItem", list.at(i));
 	}
 	_settings.endArray();
+	_version.fetchAndAddRelease(1);
 }
 
 QStringList PhGenericSettings::stringList(QString name, QStringList defaultValue)
 {
+	QMutexLocker locker(&_mutex);
 	QStringList list;
 	int size = _settings.beginReadArray(name);
 	if(size == 0)
@@ -95,10 +114,13 @@ QStringList PhGenericSettings::stringList(QString name, QStringList defaultValue
 
 void PhGenericSettings::setByteArray(QString name, QByteArray array)
 {
+	QMutexLocker locker(&_mutex);
 	_settings.setValue(name, array);
+	_version.fetchAndAddRelease(1);
 }
 
 QByteArray PhGenericSettings::byteArray(QString name)
 {
+	QMutexLocker locker(&_mutex);
 	return _settings.value(name).toByteArray();
 }
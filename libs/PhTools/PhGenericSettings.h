@@ -1,79 +1,233 @@
 #ifndef PHGENERICSETTINGS_H
 #define PHGENERICSETTINGS_H
 
+#include <cstring>
+
 #include <QSettings>
 #include <QStringList>
 #include <QByteArray>
+#include <QList>
+#include <QMutex>
+#include <QAtomicInt>
+#include <QAtomicPointer>
+#include <QAtomicInteger>
+
+/**
+ * Implement a setter and a getter reading the in-memory snapshot
+ * of a PhGenericSettings (see PhSettingValue)
+ *
+ * The snapshot member is declared next to the getter.
+ */
+#define PH_SETTING_SNAPSHOT(type, setter, getter, write, read) \
+	void setter(type getter) { write; } \
+	type getter() { \
+		int version = _version.loadAcquire(); \
+		type value; \
+		if(!_ ## getter ## Snapshot.get(version, &value)) { \
+			value = read; \
+			_ ## getter ## Snapshot.set(value, version); \
+		} \
+		return value; \
+	} \
+	PhSettingValue<type> _ ## getter ## Snapshot;
 
 /** Implement the integer setter and getter for a PhGenericSettings */
 #define PH_SETTING_INT(setter, getter) \
-	void setter(int getter) { setIntValue(#getter, getter); } \
-	int getter() {return intValue(#getter); }
+	PH_SETTING_SNAPSHOT(int, setter, getter, setIntValue(#getter, getter), intValue(#getter))
 
 /** Implement the integer setter, getter and default value for a PhGenericSettings */
 #define PH_SETTING_INT2(setter, getter, defaultValue) \
-	void setter(int getter) { setIntValue(#getter, getter); } \
-	int getter() {return intValue(#getter, defaultValue); }
+	PH_SETTING_SNAPSHOT(int, setter, getter, setIntValue(#getter, getter), intValue(#getter, defaultValue))
 
 /** Implement the integer setter, getter and alias for a PhGenericSettings */
 #define PH_SETTING_INT3(setter, getter, alias) \
-	void setter(int getter) { setIntValue(#getter, getter); } \
-	int getter() {return intValueWithAlias(#getter, #alias); }
+	PH_SETTING_SNAPSHOT(int, setter, getter, setIntValue(#getter, getter), intValueWithAlias(#getter, #alias))
 
 /** Implement the unsigned char setter and getter for a PhGenericSettings */
 #define PH_SETTING_UCHAR(setter, getter) \
-	void setter(unsigned char getter) { setIntValue(#getter, getter); } \
-	unsigned char getter() {return intValue(#getter); }
+	PH_SETTING_SNAPSHOT(unsigned char, setter, getter, setIntValue(#getter, getter), intValue(#getter))
 
 /** Implement the unsigned char setter, getter and default value for a PhGenericSettings */
 #define PH_SETTING_UCHAR2(setter, getter, defaultValue) \
-	void setter(unsigned char getter) { setIntValue(#getter, getter); } \
-	unsigned char getter() {return intValue(#getter, defaultValue); }
+	PH_SETTING_SNAPSHOT(unsigned char, setter, getter, setIntValue(#getter, getter), intValue(#getter, defaultValue))
 
 /** Implement the bool setter and getter for a PhGenericSettings */
 #define PH_SETTING_BOOL(setter, getter) \
-	void setter(bool getter) { setBoolValue(#getter, getter); } \
-	bool getter() {return boolValue(#getter); }
+	PH_SETTING_SNAPSHOT(bool, setter, getter, setBoolValue(#getter, getter), boolValue(#getter))
 
 /** Implement the bool setter, getter and default value for a PhGenericSettings */
 #define PH_SETTING_BOOL2(setter, getter, defaultValue) \
-	void setter(bool getter) { setBoolValue(#getter, getter); } \
-	bool getter() {return boolValue(#getter, defaultValue); }
+	PH_SETTING_SNAPSHOT(bool, setter, getter, setBoolValue(#getter, getter), boolValue(#getter, defaultValue))
 
 /** Implement the float setter and getter for a PhGenericSettings */
 #define PH_SETTING_FLOAT(setter, getter) \
-	void setter(float getter) { setFloatValue(#getter, getter); } \
-	float getter() {return floatValue(#getter); }
+	PH_SETTING_SNAPSHOT(float, setter, getter, setFloatValue(#getter, getter), floatValue(#getter))
 
 /** Implement the float setter, getter and default value for a PhGenericSettings */
 #define PH_SETTING_FLOAT2(setter, getter, defaultValue) \
-	void setter(float getter) { setFloatValue(#getter, getter); } \
-	float getter() {return floatValue(#getter, defaultValue); }
+	PH_SETTING_SNAPSHOT(float, setter, getter, setFloatValue(#getter, getter), floatValue(#getter, defaultValue))
 
 /** Implement the string setter and getter for a PhGenericSettings */
 #define PH_SETTING_STRING(setter, getter) \
-	void setter(QString getter) { setStringValue(#getter, getter); } \
-	QString getter() {return stringValue(#getter); }
+	PH_SETTING_SNAPSHOT(QString, setter, getter, setStringValue(#getter, getter), stringValue(#getter))
 
 /** Implement the string setter, getter and default value for a PhGenericSettings */
 #define PH_SETTING_STRING2(setter, getter, defaultValue) \
-	void setter(QString getter) { setStringValue(#getter, getter); } \
-	QString getter() {return stringValue(#getter, defaultValue); }
+	PH_SETTING_SNAPSHOT(QString, setter, getter, setStringValue(#getter, getter), stringValue(#getter, defaultValue))
 
 /** Implement the string list setter and getter for a PhGenericSettings */
 #define PH_SETTING_STRINGLIST(setter, getter) \
-	void setter(QStringList list) { setStringList(#getter, list); } \
-	QStringList getter() {return stringList(#getter); }
+	PH_SETTING_SNAPSHOT(QStringList, setter, getter, setStringList(#getter, getter), stringList(#getter))
 
 /** Implement the string list setter and getter qnd default value for a PhGenericSettings */
 #define PH_SETTING_STRINGLIST2(setter, getter, defaultValue) \
-	void setter(QStringList list) { setStringList(#getter, list); } \
-	QStringList getter() {return stringList(#getter, defaultValue); }
+	PH_SETTING_SNAPSHOT(QStringList, setter, getter, setStringList(#getter, getter), stringList(#getter, defaultValue))
 
 /** Implement the byte array setter and getter for a PhGenericSettings */
 #define PH_SETTING_BYTEARRAY(setter, getter) \
-	void setter(QByteArray array) { setByteArray(#getter, array); } \
-	QByteArray getter() {return byteArray(#getter); }
+	PH_SETTING_SNAPSHOT(QByteArray, setter, getter, setByteArray(#getter, getter), byteArray(#getter))
+
+/**
+ * @brief A settings value kept in memory
+ *
+ * The getters generated by the PH_SETTING macros are called at each frame
+ * by the rendering code: they return the value read once from QSettings
+ * as long as the settings version has not changed.
+ *
+ * Some getters are called from the real time threads (audio callback,
+ * serial port) so they shall not lock: the value and its version are
+ * published through an atomic pointer and the implicitly shared value
+ * is copied by incrementing its reference count only.
+ * Since a reader may still copy a replaced value, the replaced ones are
+ * only freed with the snapshot: a new value is only published when it
+ * differs from the current one, otherwise its version is updated.
+ * The scalar values are packed with their version in a single atomic
+ * integer instead (see PhSettingScalar).
+ */
+template <typename T>
+class PhSettingValue
+{
+public:
+	/**
+	 * @brief PhSettingValue constructor
+	 */
+	PhSettingValue() : _entry(NULL) {
+	}
+
+	~PhSettingValue() {
+		delete _entry.load();
+		qDeleteAll(_replacedEntries);
+	}
+
+	/**
+	 * @brief Get the value if it is up to date
+	 * @param version The current settings version
+	 * @param value The value
+	 * @return True if the value was stored for this version, false otherwise
+	 */
+	bool get(int version, T *value) const {
+		const Entry *entry = _entry.loadAcquire();
+		if((entry == NULL) || (entry->version.loadAcquire() != version))
+			return false;
+		*value = entry->value;
+		return true;
+	}
+
+	/**
+	 * @brief Store the value
+	 * @param value The value
+	 * @param version The settings version the value was read for
+	 */
+	void set(const T &value, int version) {
+		QMutexLocker locker(&_mutex);
+		Entry *entry = _entry.load();
+		if(entry && (entry->value == value)) {
+			entry->version.storeRelease(version);
+			return;
+		}
+		if(entry)
+			_replacedEntries.append(entry);
+		_entry.storeRelease(new Entry(value, version));
+	}
+
+private:
+	struct Entry
+	{
+		Entry(const T &value, int version) : value(value), version(version) {
+		}
+		const T value;
+		QAtomicInt version;
+	};
+
+	QAtomicPointer<Entry> _entry;
+	/** @brief Serialize the writers, the readers never lock */
+	QMutex _mutex;
+	QList<Entry*> _replacedEntries;
+};
+
+/**
+ * @brief A scalar settings value kept in memory without lock
+ *
+ * The value bits and the settings version are stored together
+ * in a single 64 bits atomic integer.
+ */
+template <typename T>
+class PhSettingScalar
+{
+public:
+	/**
+	 * @brief PhSettingScalar constructor
+	 */
+	PhSettingScalar() : _bits(0) {
+		Q_STATIC_ASSERT(sizeof(T) <= sizeof(quint32));
+	}
+
+	/**
+	 * @brief Get the value if it is up to date
+	 * @param version The current settings version
+	 * @param value The value
+	 * @return True if the value was stored for this version, false otherwise
+	 */
+	bool get(int version, T *value) const {
+		quint64 bits = _bits.loadAcquire();
+		// The stored version is shifted by one so that 0 means no value
+		if((bits >> 32) != quint32(version) + 1)
+			return false;
+		quint32 valueBits = quint32(bits);
+		memcpy(value, &valueBits, sizeof(T));
+		return true;
+	}
+
+	/**
+	 * @brief Store the value
+	 * @param value The value
+	 * @param version The settings version the value was read for
+	 */
+	void set(const T &value, int version) {
+		quint32 valueBits = 0;
+		memcpy(&valueBits, &value, sizeof(T));
+		_bits.storeRelease((quint64(quint32(version) + 1) << 32) | valueBits);
+	}
+
+private:
+	QAtomicInteger<quint64> _bits;
+};
+
+/** @brief An integer settings value kept in memory without lock */
+template <>
+class PhSettingValue<int> : public PhSettingScalar<int> {};
+
+/** @brief An unsigned char settings value kept in memory without lock */
+template <>
+class PhSettingValue<unsigned char> : public PhSettingScalar<unsigned char> {};
+
+/** @brief A bool settings value kept in memory without lock */
+template <>
+class PhSettingValue<bool> : public PhSettingScalar<bool> {};
+
+/** @brief A float settings value kept in memory without lock */
+template <>
+class PhSettingValue<float> : public PhSettingScalar<float> {};
 
 /**
  * @brief A generic implementation of the module settings
@@ -83,6 +237,17 @@
  * behaviour.
  * The main interest is to centralize the default value of each settings
  * and to insure settings name unicity and homogeneity.
+ *
+ * The values are kept in memory by the getters so that they can be read
+ * at each frame without accessing QSettings. Each write increments the
+ * settings version, which makes the getters read QSettings again once
+ * (a value may depend on another one through an alias or a default value).
+ * QSettings keeps the written values in memory too and saves them to the
+ * disk later from the event loop.
+ *
+ * The getters can be called from any thread: the version is atomic and
+ * the QSettings accesses are serialized by a mutex, which is only locked
+ * by the getters when a value was written since their previous call.
  */
 class PhGenericSettings
 {
@@ -98,6 +263,16 @@ public:
 	 */
 	void clear();
 
+	/**
+	 * @brief Get the settings version
+	 *
+	 * It is incremented each time a value is written or the settings are cleared.
+	 * @return An integer value
+	 */
+	int version() const {
+		return _version.loadAcquire();
+	}
+
 protected:
 	/**
 	 * @brief Set an integer value
@@ -193,6 +368,15 @@ protected:
 	 * @brief The QSettings object
 	 */
 	QSettings _settings;
+
+	/**
+	 * @brief The settings version
+	 */
+	QAtomicInt _version;
+
+private:
+	/** @brief Serialize the QSettings accesses of the different threads */
+	QMutex _mutex;
 };
 
 #endif // PHGENERICSETTINGS_H
@@ -7,7 +7,7 @@ HEADERS += \
 	$$TOP_ROOT/libs/PhTools/PhDebug.h \
 	$$TOP_ROOT/libs/PhTools/PhTickCounter.h \
 	$$TOP_ROOT/libs/PhTools/PhPictureTools.h \
-	$$TOP_ROOT/libs/PhTools/PhFileTool.h \
+	$$TOP_ROOT/libs/PhTools/PhBinaryReader.h \
 	$$TOP_ROOT/libs/PhTools/PhGenericSettings.h \
 	$$TOP_ROOT/libs/PhTools/PhTestTools.h
 
@@ -15,6 +15,6 @@ SOURCES += \
 	$$TOP_ROOT/libs/PhTools/PhDebug.cpp \
 	$$TOP_ROOT/libs/PhTools/PhTickCounter.cpp \
 	$$TOP_ROOT/libs/PhTools/PhPictureTools.cpp \
-	$$TOP_ROOT/libs/PhTools/PhFileTool.cpp \
+	$$TOP_ROOT/libs/PhTools/PhBinaryReader.cpp \
 	$$TOP_ROOT/libs/PhTools/PhGenericSettings.cpp \
 	$$TOP_ROOT/libs/PhTools/PhTestTools.cpp
@@ -5,9 +5,11 @@
 
 HEADERS += \
     $$TOP_ROOT/libs/PhVideo/PhVideoEngine.h \
+    $$TOP_ROOT/libs/PhVideo/PhVideoDecoder.h \
     $$TOP_ROOT/libs/PhVideo/PhVideoSettings.h
 SOURCES += \
-    $$TOP_ROOT/libs/PhVideo/PhVideoEngine.cpp
+    $$TOP_ROOT/libs/PhVideo/PhVideoEngine.cpp \
+    $$TOP_ROOT/libs/PhVideo/PhVideoDecoder.cpp
 
 # Windows specific
 win32{
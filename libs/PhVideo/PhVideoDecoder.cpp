@@ -0,0 +1,928 @@
+/**
+ * @file
+ * @copyright (C) 2012-2014 Phonations
+ * @license http://www.gnu.org/licenses/gpl.html GPL version 2 or higher
+ */
+
+#include <algorithm>
+
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QStandardPaths>
+
+#include "PhTools/PhDebug.h"
+
+#include "PhVideoDecoder.h"
+
+PhVideoDecoder::PhVideoDecoder(int bufferSize, int reverseBufferSize) :
+	_fileName(""),
+	_tcType(PhTimeCodeType25),
+	_frameStamp(PHFRAMEMIN),
+	_frameLength(0),
+	_pFormatContext(NULL),
+	_videoStream(NULL),
+	_videoFrame(NULL),
+	_swsContext(NULL),
+	_threadCount(0),
+	_decodeRate(0),
+	_decodeBusyTime(0),
+	_decodedFrameCount(0),
+	_currentFrame(PHFRAMEMIN),
+	_useAudio(false),
+	_audioStream(NULL),
+	_audioFrame(NULL),
+	_bufferSize(bufferSize),
+	_frames(qMax(bufferSize, reverseBufferSize)),
+	_requestedFrame(PHFRAMEMIN),
+	_rate(0),
+	_stalledFrame(PHFRAMEMIN),
+	_deinterlace(false),
+	_shaderConversion(false),
+	_generation(0),
+	_threadRunning(false)
+{
+	for(int i = 0; i < _frames.size(); i++) {
+		_frames[i].frame = PHFRAMEMIN;
+		_frames[i].data = NULL;
+		_frames[i].size = 0;
+		_frames[i].width = 0;
+		_frames[i].height = 0;
+		_frames[i].pixelFormat = AV_PIX_FMT_BGRA;
+		_frames[i].chromaWidth = 0;
+		_frames[i].chromaHeight = 0;
+		_frames[i].locked = false;
+	}
+
+	av_register_all();
+	avcodec_register_all();
+}
+
+PhVideoDecoder::~PhVideoDecoder()
+{
+	close();
+}
+
+bool PhVideoDecoder::ready()
+{
+	return (_pFormatContext && _videoStream && _videoFrame);
+}
+
+bool PhVideoDecoder::open(QString fileName)
+{
+	close();
+	PHDEBUG << fileName;
+
+	_currentFrame = PHFRAMEMIN;
+	_requestedFrame = PHFRAMEMIN;
+	_stalledFrame = PHFRAMEMIN;
+	_skippedFrames.clear();
+
+	if(avformat_open_input(&_pFormatContext, fileName.toStdString().c_str(), NULL, NULL) < 0)
+		return false;
+
+	// The frame length, the timecode and the keyframes come from the cache:
+	// only a short analysis is needed to set up the codec parameters.
+	bool cached = loadIndexCache(fileName);
+	if(cached)
+		_pFormatContext->max_analyze_duration = AV_TIME_BASE / 2;
+
+	// Retrieve stream information
+	if (avformat_find_stream_info(_pFormatContext, NULL) < 0)
+		return false; // Couldn't find stream information
+
+	av_dump_format(_pFormatContext, 0, fileName.toStdString().c_str(), 0);
+
+	// Find video stream :
+	for(int i = 0; i < (int)_pFormatContext->nb_streams; i++) {
+		AVMediaType streamType = _pFormatContext->streams[i]->codec->codec_type;
+		PHDEBUG << i << ":" << streamType;
+		switch(streamType) {
+		case AVMEDIA_TYPE_VIDEO:
+			_videoStream = _pFormatContext->streams[i];
+			PHDEBUG << "\t=> video";
+			break;
+		case AVMEDIA_TYPE_AUDIO:
+			if(_useAudio && (_audioStream == NULL))
+				_audioStream = _pFormatContext->streams[i];
+			PHDEBUG << "\t=> audio";
+			break;
+		default:
+			PHDEBUG << "\t=> unknown";
+			break;
+		}
+	}
+
+	if(_videoStream == NULL)
+		return false;
+
+	if(!cached) {
+		// Looking for timecode type
+		_tcType = PhTimeCode::computeTimeCodeType(this->framePerSecond());
+
+		// Reading timestamp :
+		AVDictionaryEntry *tag = av_dict_get(_pFormatContext->metadata, "timecode", NULL, AV_DICT_IGNORE_SUFFIX);
+		if(tag == NULL)
+			tag = av_dict_get(_videoStream->metadata, "timecode", NULL, AV_DICT_IGNORE_SUFFIX);
+
+		if(tag) {
+			PHDEBUG << "Found timestamp:" << tag->value;
+			_frameStamp = PhTimeCode::frameFromString(tag->value, _tcType);
+		}
+
+		_frameLength = time2frame(_videoStream->duration);
+	}
+
+	PHDEBUG << "size : " << _videoStream->codec->width << "x" << _videoStream->codec->height;
+	AVCodec * videoCodec = avcodec_find_decoder(_videoStream->codec->codec_id);
+	if(videoCodec == NULL) {
+		PHDEBUG << "Unable to find the codec:" << _videoStream->codec->codec_id;
+		return false;
+	}
+
+	// Enable the frame and slice threading, 0 lets libavcodec choose the thread count
+	_videoStream->codec->thread_count = _threadCount;
+	_videoStream->codec->thread_type = FF_THREAD_FRAME | FF_THREAD_SLICE;
+
+	if (avcodec_open2(_videoStream->codec, videoCodec, NULL) < 0) {
+		PHDEBUG << "Unable to open the codec:" << _videoStream->codec;
+		return false;
+	}
+
+	PHDEBUG << "decoder threads:" << this->threadCount() << "type:" << _videoStream->codec->active_thread_type;
+
+	_videoFrame = av_frame_alloc();
+
+	if(!cached) {
+		buildKeyframeIndex();
+		saveIndexCache(fileName);
+	}
+
+	PHDEBUG << "length:" << this->frameLength();
+	PHDEBUG << "fps:" << this->framePerSecond();
+
+	if(_audioStream) {
+		AVCodec* audioCodec = avcodec_find_decoder(_audioStream->codec->codec_id);
+		if(audioCodec) {
+			if(avcodec_open2(_audioStream->codec, audioCodec, NULL) < 0) {
+				PHDEBUG << "Unable to open audio codec.";
+				_audioStream = NULL;
+			}
+			else {
+				_audioFrame = av_frame_alloc();
+				PHDEBUG << "Audio OK.";
+			}
+		}
+		else {
+			PHDEBUG << "Unable to find codec for audio.";
+			_audioStream = NULL;
+		}
+	}
+
+	_fileName = fileName;
+
+	_threadRunning = true;
+	this->start();
+
+	return true;
+}
+
+void PhVideoDecoder::close()
+{
+	PHDEBUG << _fileName;
+
+	if(this->isRunning()) {
+		_mutex.lock();
+		_threadRunning = false;
+		_condition.wakeAll();
+		_mutex.unlock();
+		this->wait();
+	}
+
+	for(int i = 0; i < _frames.size(); i++) {
+		av_free(_frames[i].data);
+		_frames[i].frame = PHFRAMEMIN;
+		_frames[i].data = NULL;
+		_frames[i].size = 0;
+		_frames[i].locked = false;
+	}
+
+	if(_pFormatContext) {
+		PHDEBUG << "Close the media context.";
+		if(_videoStream)
+			avcodec_close(_videoStream->codec);
+		if(_audioStream)
+			avcodec_close(_audioStream->codec);
+		avformat_close_input(&_pFormatContext);
+	}
+	if(_swsContext) {
+		sws_freeContext(_swsContext);
+		_swsContext = NULL;
+	}
+	if(_videoFrame)
+		av_frame_free(&_videoFrame);
+	if(_audioFrame)
+		av_frame_free(&_audioFrame);
+
+	_keyframes.clear();
+	_frameStamp = PHFRAMEMIN;
+	_frameLength = 0;
+	_pFormatContext = NULL;
+	_videoStream = NULL;
+	_audioStream = NULL;
+	_currentFrame = PHFRAMEMIN;
+	_requestedFrame = PHFRAMEMIN;
+	PHDEBUG << _fileName << "closed";
+
+	_fileName = "";
+}
+
+PhFrame PhVideoDecoder::frameLength()
+{
+	if(_videoStream)
+		return _frameLength;
+	return 0;
+}
+
+int PhVideoDecoder::threadCount()
+{
+	if(_videoStream)
+		return _videoStream->codec->thread_count;
+	return 0;
+}
+
+QString PhVideoDecoder::codecName()
+{
+	if(_videoStream)
+		return _videoStream->codec->codec_name;
+	return "";
+}
+
+int PhVideoDecoder::width()
+{
+	if(_videoStream)
+		return _videoStream->codec->width;
+	return 0;
+}
+
+int PhVideoDecoder::height()
+{
+	if(_videoStream)
+		return _videoStream->codec->height;
+	return 0;
+}
+
+float PhVideoDecoder::framePerSecond()
+{
+	float result = 0;
+	if(_videoStream) {
+		result = _videoStream->avg_frame_rate.num / _videoStream->avg_frame_rate.den;
+		// See http://stackoverflow.com/a/570694/2307070
+		// for NaN handling
+		if(result != result) {
+			result = _videoStream->time_base.den;
+			result /= _videoStream->time_base.num;
+		}
+	}
+
+	return result;
+}
+
+void PhVideoDecoder::setDeinterlace(bool deinterlace)
+{
+	QMutexLocker locker(&_mutex);
+	if(_deinterlace != deinterlace) {
+		_deinterlace = deinterlace;
+		flush();
+	}
+}
+
+void PhVideoDecoder::setShaderConversion(bool shaderConversion)
+{
+	QMutexLocker locker(&_mutex);
+	if(_shaderConversion != shaderConversion) {
+		_shaderConversion = shaderConversion;
+		flush();
+	}
+}
+
+void PhVideoDecoder::requestFrame(PhFrame frame, PhRate rate)
+{
+	QMutexLocker locker(&_mutex);
+	if((frame != _requestedFrame) || (rate != _rate)) {
+		_requestedFrame = frame;
+		_rate = rate;
+		_stalledFrame = PHFRAMEMIN;
+		// Forget the skipped frames which left the read ahead window
+		QSet<PhFrame>::iterator it = _skippedFrames.begin();
+		while(it != _skippedFrames.end()) {
+			if(inWindow(*it))
+				++it;
+			else
+				it = _skippedFrames.erase(it);
+		}
+		_condition.wakeAll();
+	}
+}
+
+PhVideoFrame *PhVideoDecoder::acquireFrame(PhFrame frame)
+{
+	QMutexLocker locker(&_mutex);
+	// When paused or seeking only the exact picture is shown. In fast modes
+	// the codec may have dropped the requested frame: a picture less than
+	// a step away stands for it.
+	PhFrame tolerance = (_rate == 0) ? 0 : stride() - 1;
+	PhVideoFrame *result = NULL;
+	for(int i = 0; i < _frames.size(); i++) {
+		PhVideoFrame *videoFrame = &_frames[i];
+		if((videoFrame->frame == PHFRAMEMIN) || videoFrame->locked)
+			continue;
+		if(qAbs(videoFrame->frame - frame) > tolerance)
+			continue;
+		if((result == NULL) || (qAbs(videoFrame->frame - frame) < qAbs(result->frame - frame)))
+			result = videoFrame;
+	}
+	if(result)
+		result->locked = true;
+	return result;
+}
+
+void PhVideoDecoder::releaseFrame(PhVideoFrame *videoFrame)
+{
+	QMutexLocker locker(&_mutex);
+	videoFrame->locked = false;
+	_condition.wakeAll();
+}
+
+QList<PhFrame> PhVideoDecoder::bufferedFrames()
+{
+	QMutexLocker locker(&_mutex);
+	QList<PhFrame> result;
+	for(int i = 0; i < _frames.size(); i++) {
+		if(_frames[i].frame != PHFRAMEMIN)
+			result.append(_frames[i].frame);
+	}
+	std::sort(result.begin(), result.end());
+	return result;
+}
+
+void PhVideoDecoder::run()
+{
+	_mutex.lock();
+	while(_threadRunning) {
+		PhFrame frame = nextFrameToDecode();
+		if(frame == PHFRAMEMIN) {
+			_condition.wait(&_mutex);
+			continue;
+		}
+
+		bool deinterlace = _deinterlace;
+		bool shaderConversion = _shaderConversion;
+		bool fast = (stride() > 1);
+		int generation = _generation;
+		_mutex.unlock();
+
+		// In fast modes the non reference frames are not needed
+		_videoStream->codec->skip_frame = fast ? AVDISCARD_NONREF : AVDISCARD_DEFAULT;
+		QElapsedTimer timer;
+		timer.start();
+		bool result = decodeFrame(frame, deinterlace, shaderConversion, generation);
+
+		// Publish the throughput every half second of decoding
+		_decodeBusyTime += timer.nsecsElapsed();
+		if(_decodeBusyTime >= 500000000) {
+			_decodeRate.store(_decodedFrameCount * 1000000000LL / _decodeBusyTime);
+			_decodeBusyTime = 0;
+			_decodedFrameCount = 0;
+		}
+
+		_mutex.lock();
+		if(!result && (generation == _generation))
+			_stalledFrame = frame;
+	}
+	_mutex.unlock();
+}
+
+int PhVideoDecoder::stride()
+{
+	return qMax(1, qRound(qAbs(_rate)));
+}
+
+int PhVideoDecoder::windowSize()
+{
+	// Keep one slot free for the frame being displayed
+	if(_rate < 0)
+		return _frames.size() - 1;
+	return _bufferSize - 1;
+}
+
+bool PhVideoDecoder::inWindow(PhFrame frame)
+{
+	PhFrame extent = (windowSize() - 1) * stride();
+	if(_rate < 0)
+		return (frame <= _requestedFrame) && (frame >= _requestedFrame - extent);
+	return (frame >= _requestedFrame) && (frame <= _requestedFrame + extent);
+}
+
+bool PhVideoDecoder::contains(PhFrame frame)
+{
+	for(int i = 0; i < _frames.size(); i++) {
+		if(_frames[i].frame == frame)
+			return true;
+	}
+	return false;
+}
+
+PhFrame PhVideoDecoder::nextFrameToDecode()
+{
+	if(_requestedFrame == PHFRAMEMIN)
+		return PHFRAMEMIN;
+
+	PhFrame lastFrame = this->frameLength() - 1;
+	int step = (_rate < 0) ? -stride() : stride();
+	int count = windowSize();
+	int missing = 0;
+	PhFrame result = PHFRAMEMIN;
+	for(int i = 0; i < count; i++) {
+		PhFrame frame = _requestedFrame + i * step;
+		if((frame < 0) || (frame > lastFrame))
+			break;
+		// Stop reading ahead after a decoding error until a new frame is requested
+		if(frame == _stalledFrame)
+			break;
+
+		if(!contains(frame) && !_skippedFrames.contains(frame)) {
+			missing++;
+			if(result == PHFRAMEMIN)
+				result = frame;
+		}
+	}
+
+	// When playing backward, a frame is decoded ahead only if the decoding
+	// from its keyframe stays inside the window so that each seek stores
+	// a whole GOP into the buffer. With GOP longer than the window, wait
+	// for half of the window to be consumed instead.
+	if((_rate < 0) && (result != _requestedFrame) && (missing < count / 2)) {
+		PhFrame lowestFrame = _requestedFrame - (count - 1) * stride();
+		if(keyframeBefore(frame2time(result)) < frame2time(lowestFrame))
+			return PHFRAMEMIN;
+	}
+
+	return result;
+}
+
+PhVideoFrame *PhVideoDecoder::recycleFrame(PhFrame frame, bool force)
+{
+	auto distance = [](PhVideoFrame *videoFrame, PhFrame frame) {
+		return (videoFrame->frame == PHFRAMEMIN) ? PHFRAMEMAX : qAbs(videoFrame->frame - frame);
+	};
+
+	PhVideoFrame *result = NULL;
+	PhVideoFrame *windowFrame = NULL;
+	for(int i = 0; i < _frames.size(); i++) {
+		PhVideoFrame *videoFrame = &_frames[i];
+		if(videoFrame->locked)
+			continue;
+		if((videoFrame->frame == PHFRAMEMIN) || !inWindow(videoFrame->frame)) {
+			// Recycle the slots outside of the read ahead window: the already
+			// allocated ones first to keep the memory usage low, then the farthest.
+			bool allocated = (videoFrame->data != NULL);
+			bool resultAllocated = result && (result->data != NULL);
+			if((result == NULL) || (allocated && !resultAllocated)
+			   || ((allocated == resultAllocated) && (distance(videoFrame, frame) > distance(result, frame))))
+				result = videoFrame;
+		}
+		else if(force && (videoFrame->frame != frame)) {
+			// The window is full: drop the frame needed last
+			if((windowFrame == NULL) || (distance(videoFrame, _requestedFrame) > distance(windowFrame, _requestedFrame)))
+				windowFrame = videoFrame;
+		}
+	}
+
+	if(result == NULL)
+		result = windowFrame;
+
+	if(result) {
+		result->frame = PHFRAMEMIN;
+		result->locked = true;
+	}
+	return result;
+}
+
+void PhVideoDecoder::flush()
+{
+	for(int i = 0; i < _frames.size(); i++)
+		_frames[i].frame = PHFRAMEMIN;
+	_stalledFrame = PHFRAMEMIN;
+	_skippedFrames.clear();
+	_generation++;
+	_condition.wakeAll();
+}
+
+bool PhVideoDecoder::storeFrame(PhFrame frame, bool target, bool deinterlace, bool shaderConversion, int generation)
+{
+	_mutex.lock();
+	PhVideoFrame *videoFrame = NULL;
+	// The frames decoded on the way to the target are kept
+	// if they are expected soon (backward playback). In fast modes,
+	// only the ones read by the stride are.
+	bool expected = inWindow(frame) && ((frame - _requestedFrame) % stride() == 0) && !contains(frame);
+	if((generation == _generation) && (target || expected))
+		videoFrame = recycleFrame(frame, target);
+	_mutex.unlock();
+
+	if(videoFrame == NULL)
+		return false;
+
+	bool result = convertFrame(videoFrame, deinterlace, shaderConversion);
+
+	_mutex.lock();
+	videoFrame->locked = false;
+	// Discard the frame if the buffer was flushed during the decoding
+	if(result && (generation == _generation))
+		videoFrame->frame = frame;
+	_mutex.unlock();
+
+	return result;
+}
+
+bool PhVideoDecoder::decodeFrame(PhFrame frame, bool deinterlace, bool shaderConversion, int generation)
+{
+	if(!ready()) {
+		PHDEBUG << "not ready";
+		return false;
+	}
+
+	// Do not perform frame seek if the last decoded frame is the previous frame
+	// or if the requested frame can be reached by decoding forward
+	// without crossing a keyframe.
+	if((_currentFrame == PHFRAMEMIN) || (frame - _currentFrame != 1)) {
+		int64_t keyframeTime = keyframeBefore(frame2time(frame));
+		if((_currentFrame == PHFRAMEMIN) || (frame <= _currentFrame) || (frame2time(_currentFrame) < keyframeTime)) {
+			PHDEBUG << "seek:" << frame << "from keyframe" << keyframeTime;
+			av_seek_frame(_pFormatContext, _videoStream->index, keyframeTime, AVSEEK_FLAG_BACKWARD);
+			avcodec_flush_buffers(_videoStream->codec);
+			_currentFrame = PHFRAMEMIN;
+		}
+	}
+
+	AVPacket packet;
+	bool endOfFile = false;
+
+	while(true) {
+		if(!endOfFile) {
+			int error = av_read_frame(_pFormatContext, &packet);
+			if(error < 0) {
+				char errorStr[256];
+				av_strerror(error, errorStr, 256);
+				PHDEBUG << frame << "error:" << errorStr;
+				endOfFile = true;
+			}
+		}
+
+		if(endOfFile) {
+			// Drain the frames delayed by the codec
+			av_init_packet(&packet);
+			packet.data = NULL;
+			packet.size = 0;
+			packet.stream_index = _videoStream->index;
+		}
+
+		if(packet.stream_index == _videoStream->index) {
+			int frameFinished = 0;
+			avcodec_decode_video2(_videoStream->codec, _videoFrame, &frameFinished, &packet);
+			av_free_packet(&packet);
+			if(frameFinished)
+				_decodedFrameCount++;
+
+			if(!frameFinished) {
+				if(endOfFile)
+					return false;
+				// if frame decode is not finished, let's read another packet.
+				continue;
+			}
+
+			int64_t timestamp = av_frame_get_best_effort_timestamp(_videoFrame);
+			if(timestamp != AV_NOPTS_VALUE)
+				_currentFrame = time2frame(timestamp);
+			else if(_currentFrame != PHFRAMEMIN)
+				_currentFrame++;
+			else
+				_currentFrame = frame;
+
+			// Decode forward from the keyframe up to the requested frame
+			if(_currentFrame < frame) {
+				storeFrame(_currentFrame, false, deinterlace, shaderConversion, generation);
+				continue;
+			}
+
+			// The requested frame may have been dropped by the codec in fast modes:
+			// the picture is stored with its own number (acquireFrame() accepts
+			// it for the requested one) and the requested one is not decoded again.
+			if(_currentFrame > frame) {
+				PHDBG(24) << "requested" << frame << "but decoded" << _currentFrame;
+				_mutex.lock();
+				if(generation == _generation)
+					_skippedFrames.insert(frame);
+				_mutex.unlock();
+			}
+
+			return storeFrame(_currentFrame, true, deinterlace, shaderConversion, generation);
+		}
+		else if(_audioStream && (packet.stream_index == _audioStream->index)) {
+			int ok = 0;
+			avcodec_decode_audio4(_audioStream->codec, _audioFrame, &ok, &packet);
+			if(ok) {
+				PHDEBUG << "audio:" << _audioFrame->nb_samples;
+			}
+		}
+		//Avoid memory leak
+		av_free_packet(&packet);
+	}
+}
+
+void PhVideoDecoder::buildKeyframeIndex()
+{
+	_keyframes.clear();
+
+	// Most of the container (mov, mp4, mkv, ...) already provide an index after the opening
+	for(int i = 0; i < _videoStream->nb_index_entries; i++) {
+		AVIndexEntry *entry = &_videoStream->index_entries[i];
+		if(entry->flags & AVINDEX_KEYFRAME) {
+			PhVideoKeyframe keyframe = {entry->timestamp, entry->pos};
+			_keyframes.append(keyframe);
+		}
+	}
+
+	// Otherwise demux the whole file once
+	if(_keyframes.isEmpty()) {
+		AVPacket packet;
+		while(av_read_frame(_pFormatContext, &packet) == 0) {
+			if((packet.stream_index == _videoStream->index) && (packet.flags & AV_PKT_FLAG_KEY)) {
+				PhVideoKeyframe keyframe = {packet.pts != AV_NOPTS_VALUE ? packet.pts : packet.dts, packet.pos};
+				_keyframes.append(keyframe);
+			}
+			av_free_packet(&packet);
+		}
+		av_seek_frame(_pFormatContext, _videoStream->index, 0, AVSEEK_FLAG_BACKWARD);
+	}
+
+	std::sort(_keyframes.begin(), _keyframes.end(), [](const PhVideoKeyframe &a, const PhVideoKeyframe &b) {
+		return a.time < b.time;
+	});
+
+	PHDEBUG << _keyframes.count() << "keyframes";
+}
+
+int64_t PhVideoDecoder::keyframeBefore(int64_t time)
+{
+	// Find the first keyframe after the time and step back
+	QVector<PhVideoKeyframe>::const_iterator it = std::upper_bound(_keyframes.constBegin(), _keyframes.constEnd(), time,
+	                                                               [](int64_t t, const PhVideoKeyframe &keyframe) {
+		return t < keyframe.time;
+	});
+	if(it == _keyframes.constBegin())
+		return (it == _keyframes.constEnd()) ? time : it->time;
+	return (it - 1)->time;
+}
+
+bool PhVideoDecoder::convertFrame(PhVideoFrame *videoFrame, bool deinterlace, bool shaderConversion)
+{
+	// As the following formats are deprecated (see https://libav.org/doxygen/master/pixfmt_8h.html#a9a8e335cf3be472042bc9f0cf80cd4c5)
+	// we replace its with the new ones recommended by LibAv
+	// in order to get ride of the warnings
+	AVPixelFormat pixFormat;
+	switch (_videoStream->codec->pix_fmt) {
+	case AV_PIX_FMT_YUVJ420P:
+		pixFormat = AV_PIX_FMT_YUV420P;
+		break;
+	case AV_PIX_FMT_YUVJ422P:
+		pixFormat = AV_PIX_FMT_YUV422P;
+		break;
+	case AV_PIX_FMT_YUVJ444P:
+		pixFormat = AV_PIX_FMT_YUV444P;
+		break;
+	case AV_PIX_FMT_YUVJ440P:
+		pixFormat = AV_PIX_FMT_YUV440P;
+		break;
+	default:
+		pixFormat = _videoStream->codec->pix_fmt;
+		break;
+	}
+
+	// The planar formats supported by PhGraphicYUVRect are left to the GPU
+	if(shaderConversion && ((pixFormat == AV_PIX_FMT_YUV420P) || (pixFormat == AV_PIX_FMT_YUV422P)))
+		return copyPlanes(videoFrame, pixFormat, deinterlace);
+
+	int frameHeight = _videoFrame->height;
+	if(deinterlace)
+		frameHeight = _videoFrame->height / 2;
+
+	/* Note: we output the frames in AV_PIX_FMT_BGRA rather than AV_PIX_FMT_RGB24,
+	 * because this format is native to most video cards and will avoid a conversion
+	 * in the video driver.
+	 * The scaler context is only reallocated when the source size, the pixel format
+	 * or the output size changes. */
+	_swsContext = sws_getCachedContext(_swsContext, _videoFrame->width, _videoStream->codec->height, pixFormat,
+	                                   _videoStream->codec->width, frameHeight, AV_PIX_FMT_BGRA,
+	                                   SWS_POINT, NULL, NULL, NULL);
+	if(_swsContext == NULL) {
+		PHDEBUG << "Unable to get the scaler context";
+		return false;
+	}
+
+	if(!reserveBuffer(videoFrame, avpicture_get_size(AV_PIX_FMT_BGRA, _videoFrame->width, frameHeight)))
+		return false;
+
+	int linesize = _videoFrame->width * 4;
+	if (sws_scale(_swsContext, (const uint8_t * const *) _videoFrame->data,
+	              _videoFrame->linesize, 0, _videoStream->codec->height, &videoFrame->data,
+	              &linesize) < 0)
+		return false;
+
+	videoFrame->width = _videoFrame->width;
+	videoFrame->height = frameHeight;
+	videoFrame->pixelFormat = AV_PIX_FMT_BGRA;
+	return true;
+}
+
+bool PhVideoDecoder::copyPlanes(PhVideoFrame *videoFrame, AVPixelFormat pixFormat, bool deinterlace)
+{
+	// Deinterlacing keeps one line out of two like the BGRA point scaler does
+	int lineStep = deinterlace ? 2 : 1;
+	int width = _videoFrame->width;
+	int height = _videoFrame->height / lineStep;
+	int chromaWidth = (_videoFrame->width + 1) / 2;
+	int chromaHeight = _videoFrame->height / lineStep;
+	if(pixFormat == AV_PIX_FMT_YUV420P)
+		chromaHeight = (_videoFrame->height + 1) / 2 / lineStep;
+
+	if(!reserveBuffer(videoFrame, width * height + 2 * chromaWidth * chromaHeight))
+		return false;
+
+	uint8_t *dst = videoFrame->data;
+	for(int plane = 0; plane < 3; plane++) {
+		int planeWidth = plane ? chromaWidth : width;
+		int planeHeight = plane ? chromaHeight : height;
+		for(int line = 0; line < planeHeight; line++) {
+			memcpy(dst, _videoFrame->data[plane] + line * lineStep * _videoFrame->linesize[plane], planeWidth);
+			dst += planeWidth;
+		}
+	}
+
+	videoFrame->width = width;
+	videoFrame->height = height;
+	videoFrame->chromaWidth = chromaWidth;
+	videoFrame->chromaHeight = chromaHeight;
+	videoFrame->pixelFormat = pixFormat;
+	return true;
+}
+
+bool PhVideoDecoder::reserveBuffer(PhVideoFrame *videoFrame, int size)
+{
+	// The ring buffer slots act as a pool: their buffers are only
+	// reallocated when a bigger picture is needed.
+	if(videoFrame->size < size) {
+		av_free(videoFrame->data);
+		// av_malloc() returns a buffer aligned for the SIMD code path of swscale
+		videoFrame->data = (uint8_t*)av_malloc(size);
+		if(videoFrame->data == NULL) {
+			videoFrame->size = 0;
+			return false;
+		}
+		videoFrame->size = size;
+	}
+	return true;
+}
+
+QString PhVideoDecoder::indexCacheFileName(QString fileName)
+{
+	QFileInfo info(fileName);
+	// Image sequence patterns and streams are not cached
+	if(!info.isFile())
+		return "";
+
+	QByteArray key = QString("%1|%2|%3").arg(info.absoluteFilePath())
+	                 .arg(info.size())
+	                 .arg(info.lastModified().toMSecsSinceEpoch()).toUtf8();
+	QString hash = QCryptographicHash::hash(key, QCryptographicHash::Sha1).toHex();
+	return QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/videoindex/" + hash + ".idx";
+}
+
+bool PhVideoDecoder::loadIndexCache(QString fileName)
+{
+	QFile file(indexCacheFileName(fileName));
+	if(!file.open(QIODevice::ReadOnly))
+		return false;
+
+	QDataStream stream(&file);
+	quint32 magic, version;
+	stream >> magic >> version;
+	if((magic != PHVIDEOINDEX_MAGIC) || (version != PHVIDEOINDEX_VERSION)) {
+		PHDEBUG << "Invalid index cache:" << file.fileName();
+		return false;
+	}
+
+	qint32 tcType;
+	qint64 frameStamp, frameLength;
+	qint32 count;
+	stream >> tcType >> frameStamp >> frameLength >> count;
+	if(stream.status() != QDataStream::Ok)
+		return false;
+
+	// Do not trust the count before allocating: a truncated or corrupted
+	// file cannot hold more entries than its remaining bytes.
+	qint64 entrySize = 2 * sizeof(qint64);
+	if((count < 0) || (count > (file.size() - file.pos()) / entrySize)) {
+		PHDEBUG << "Invalid keyframe count in the index cache:" << count;
+		return false;
+	}
+
+	QVector<PhVideoKeyframe> keyframes(count);
+	for(int i = 0; i < count; i++) {
+		qint64 time, pos;
+		stream >> time >> pos;
+		if(stream.status() != QDataStream::Ok) {
+			PHDEBUG << "Truncated index cache:" << file.fileName();
+			return false;
+		}
+		keyframes[i].time = time;
+		keyframes[i].pos = pos;
+	}
+
+	_tcType = (PhTimeCodeType)tcType;
+	_frameStamp = frameStamp;
+	_frameLength = frameLength;
+	_keyframes = keyframes;
+
+	PHDEBUG << "Index loaded from" << file.fileName() << ":" << count << "keyframes";
+	return true;
+}
+
+void PhVideoDecoder::saveIndexCache(QString fileName)
+{
+	QString cacheFileName = indexCacheFileName(fileName);
+	if(cacheFileName.isEmpty())
+		return;
+	QDir().mkpath(QFileInfo(cacheFileName).absolutePath());
+
+	// Write to a temporary file first so that an interrupted write
+	// never leaves a partial index behind.
+	QSaveFile file(cacheFileName);
+	if(!file.open(QIODevice::WriteOnly)) {
+		PHDEBUG << "Unable to write the index cache:" << cacheFileName;
+		return;
+	}
+
+	QDataStream stream(&file);
+	stream << (quint32)PHVIDEOINDEX_MAGIC << (quint32)PHVIDEOINDEX_VERSION;
+	stream << (qint32)_tcType << (qint64)_frameStamp << (qint64)_frameLength << (qint32)_keyframes.count();
+	foreach(PhVideoKeyframe keyframe, _keyframes)
+		stream << (qint64)keyframe.time << (qint64)keyframe.pos;
+	if(!file.commit()) {
+		PHDEBUG << "Unable to write the index cache:" << cacheFileName;
+		return;
+	}
+
+	pruneIndexCache(QFileInfo(cacheFileName).absolutePath());
+}
+
+void PhVideoDecoder::pruneIndexCache(QString cacheFolder)
+{
+	// The files of the edited or removed media are never read again:
+	// keep the most recent ones up to a total size and a maximum age.
+	QFileInfoList files = QDir(cacheFolder).entryInfoList(QStringList("*.idx"), QDir::Files, QDir::Time);
+	QDateTime oldest = QDateTime::currentDateTime().addDays(-PHVIDEOINDEX_CACHE_DAYS);
+	qint64 totalSize = 0;
+	foreach(QFileInfo info, files) {
+		totalSize += info.size();
+		if((totalSize > PHVIDEOINDEX_CACHE_SIZE) || (info.lastModified() < oldest)) {
+			PHDEBUG << "Removing the index cache:" << info.fileName();
+			QFile::remove(info.absoluteFilePath());
+		}
+	}
+}
+
+int64_t PhVideoDecoder::frame2time(PhFrame f)
+{
+	int64_t t = 0;
+	if(_videoStream) {
+		PhFrame fps = PhTimeCode::getFps(_tcType);
+		t = f * _videoStream->time_base.den / _videoStream->time_base.num / fps;
+	}
+	return t;
+}
+
+PhFrame PhVideoDecoder::time2frame(int64_t t)
+{
+	PhFrame f = 0;
+	if(_videoStream) {
+		PhFrame fps = PhTimeCode::getFps(_tcType);
+		f = t * _videoStream->time_base.num * fps / _videoStream->time_base.den;
+	}
+	return f;
+}
@@ -0,0 +1,324 @@
+/**
+ * @file
+ * @copyright (C) 2012-2014 Phonations
+ * @license http://www.gnu.org/licenses/gpl.html GPL version 2 or higher
+ */
+
+#ifndef PHVIDEODECODER_H
+#define PHVIDEODECODER_H
+
+extern "C" {
+#ifndef INT64_C
+/** see http://code.google.com/p/ffmpegsource/issues/detail?id=11#c13 */
+#define INT64_C(c) (c ## LL)
+/** and http://code.google.com/p/ffmpegsource/issues/detail?id=11#c23 */
+#define UINT64_C(c) (c ## ULL)
+#endif
+
+#include <libavformat/avformat.h>
+#include <libavutil/avutil.h>
+#include <libavcodec/avcodec.h>
+#include <libswscale/swscale.h>
+}
+
+#include <QThread>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QVector>
+#include <QList>
+#include <QSet>
+#include <QAtomicInt>
+
+#include "PhSync/PhTimeCode.h"
+
+/** @brief The video index cache file magic number ("PHVI") */
+#define PHVIDEOINDEX_MAGIC 0x50485649
+/** @brief The video index cache file format version */
+#define PHVIDEOINDEX_VERSION 1
+/** @brief The maximum total size of the video index cache files */
+#define PHVIDEOINDEX_CACHE_SIZE (16 * 1024 * 1024)
+/** @brief The number of days a video index cache file is kept */
+#define PHVIDEOINDEX_CACHE_DAYS 90
+
+/**
+ * @brief A decoded video frame stored in the decoder ring buffer
+ */
+struct PhVideoFrame
+{
+	/** @brief The frame number relative to the beginning of the file (PHFRAMEMIN if the slot is empty) */
+	PhFrame frame;
+	/** @brief The picture buffer: BGRA pixels or tightly packed Y, U and V planes */
+	uint8_t *data;
+	/** @brief The allocated size of the picture buffer */
+	int size;
+	/** @brief The picture width */
+	int width;
+	/** @brief The picture height */
+	int height;
+	/** @brief The picture format: AV_PIX_FMT_BGRA, AV_PIX_FMT_YUV420P or AV_PIX_FMT_YUV422P */
+	AVPixelFormat pixelFormat;
+	/** @brief The chroma planes width (YUV formats only) */
+	int chromaWidth;
+	/** @brief The chroma planes height (YUV formats only) */
+	int chromaHeight;
+	/** @brief True if the slot is currently read or written and shall not be recycled */
+	bool locked;
+};
+
+/**
+ * @brief A keyframe entry of the video stream index
+ */
+struct PhVideoKeyframe
+{
+	/** @brief The presentation timestamp in the video stream time base */
+	int64_t time;
+	/** @brief The byte position in the file (-1 if unknown) */
+	int64_t pos;
+};
+
+/**
+ * @brief Decode a video file in a dedicated thread
+ *
+ * The decoder reads ahead of the requested frame and stores the
+ * BGRA pictures into a bounded ring of PhVideoFrame so that
+ * the render thread only has to pick a ready frame and upload it.
+ *
+ * When playing backward, the frames decoded forward from a keyframe
+ * are kept in a larger ring so that a whole GOP is decoded once
+ * and served backward. In fast modes (more than 1.5 times), only
+ * one frame out of the rate is read and the non reference frames
+ * are skipped by the codec.
+ *
+ * All the frame values handled by the decoder are relative to the
+ * beginning of the file.
+ *
+ * A keyframe index is built on opening so that a seek always starts
+ * from the preceding keyframe and decodes forward to the exact frame.
+ * The index, the frame length and the timestamp are stored in a cache file
+ * identified by the video path, size and modification date so that
+ * reopening the same file skips the scan.
+ */
+class PhVideoDecoder : public QThread
+{
+	Q_OBJECT
+public:
+	/**
+	 * @brief PhVideoDecoder constructor
+	 * @param bufferSize The number of frame read ahead when playing forward
+	 * @param reverseBufferSize The number of frame kept when playing backward
+	 */
+	explicit PhVideoDecoder(int bufferSize = 8, int reverseBufferSize = 32);
+
+	~PhVideoDecoder();
+
+	/**
+	 * @brief Open a video file and start the decoding thread
+	 * @param fileName A video file path
+	 * @return True if the file was opened successfully, false otherwise
+	 */
+	bool open(QString fileName);
+
+	/**
+	 * @brief Stop the decoding thread and close the video file
+	 */
+	void close();
+
+	/**
+	 * @brief Check if a video file is opened
+	 * @return True if the decoder is ready, false otherwise
+	 */
+	bool ready();
+
+	/**
+	 * @brief The timecode type computed from the file frame rate
+	 * @return A timecode type value
+	 */
+	PhTimeCodeType timeCodeType() {
+		return _tcType;
+	}
+
+	/**
+	 * @brief The timestamp found in the file metadata
+	 * @return A frame value or PHFRAMEMIN if no timestamp was found
+	 */
+	PhFrame frameStamp() {
+		return _frameStamp;
+	}
+
+	/**
+	 * @brief Get the video length in frame
+	 * @return A frame value
+	 */
+	PhFrame frameLength();
+
+	/**
+	 * @brief Set the number of thread used by the codec
+	 *
+	 * It is taken into account on the next opening.
+	 * @param threadCount A thread count or 0 for an automatic detection
+	 */
+	void setThreadCount(int threadCount) {
+		_threadCount = threadCount;
+	}
+
+	/**
+	 * @brief Get the number of thread effectively used by the codec
+	 * @return A thread count
+	 */
+	int threadCount();
+
+	/**
+	 * @brief Get the decoding throughput
+	 *
+	 * With frame threading the codec output is delayed by the thread count,
+	 * so the number of frames decoded per second of decoding is measured
+	 * instead of the duration of each call.
+	 * @return A number of frames per second
+	 */
+	int decodeRate() {
+		return _decodeRate.load();
+	}
+
+	/**
+	 * @brief Get the codec name
+	 * @return the codec name
+	 */
+	QString codecName();
+
+	/**
+	 * @brief Get the video width
+	 * @return A pixel value
+	 */
+	int width();
+
+	/**
+	 * @brief Get the video height
+	 * @return A pixel value
+	 */
+	int height();
+
+	/**
+	 * @brief Get average number of frame per second
+	 * @return A float value.
+	 */
+	float framePerSecond();
+
+	/**
+	 * @brief Set the video deinterlace mode
+	 *
+	 * The ring buffer is flushed since all the stored frames are invalid.
+	 * @param deinterlace True if deinterlace false otherwise
+	 */
+	void setDeinterlace(bool deinterlace);
+
+	/**
+	 * @brief Keep the YUV420P and YUV422P frames planar for a GPU conversion
+	 *
+	 * The ring buffer is flushed since all the stored frames are invalid.
+	 * @param shaderConversion True to skip the BGRA conversion
+	 */
+	void setShaderConversion(bool shaderConversion);
+
+	/**
+	 * @brief Tell the decoding thread which frame will be displayed next
+	 *
+	 * The rate gives the direction and the step of the read ahead.
+	 * @param frame A frame value
+	 * @param rate The playback rate
+	 */
+	void requestFrame(PhFrame frame, PhRate rate = 1);
+
+	/**
+	 * @brief Get the ready frame to display for a given frame
+	 *
+	 * Only the exact frame is returned when paused. In fast modes the
+	 * nearest frame less than a step away is accepted since the codec
+	 * may drop the requested one.
+	 * The returned frame is locked until releaseFrame() is called.
+	 * @param frame A frame value
+	 * @return A ready frame or NULL if the frame is not decoded yet
+	 */
+	PhVideoFrame *acquireFrame(PhFrame frame);
+
+	/**
+	 * @brief Give back a frame obtained with acquireFrame()
+	 * @param videoFrame A video frame
+	 */
+	void releaseFrame(PhVideoFrame *videoFrame);
+
+	/**
+	 * @brief Get the frames currently stored in the ring buffer
+	 * @return A sorted list of frame values
+	 */
+	QList<PhFrame> bufferedFrames();
+
+	/**
+	 * @brief Get the path of the index cache file of a video file
+	 * @param fileName A video file path
+	 * @return A file path or an empty string if the video is not cached
+	 */
+	static QString indexCacheFileName(QString fileName);
+
+protected:
+	/**
+	 * @brief The decoding thread loop
+	 */
+	void run();
+
+private:
+	int stride();
+	int windowSize();
+	bool inWindow(PhFrame frame);
+	bool contains(PhFrame frame);
+	PhFrame nextFrameToDecode();
+	PhVideoFrame *recycleFrame(PhFrame frame, bool force);
+	void flush();
+	bool decodeFrame(PhFrame frame, bool deinterlace, bool shaderConversion, int generation);
+	bool storeFrame(PhFrame frame, bool target, bool deinterlace, bool shaderConversion, int generation);
+	bool convertFrame(PhVideoFrame *videoFrame, bool deinterlace, bool shaderConversion);
+	bool copyPlanes(PhVideoFrame *videoFrame, AVPixelFormat pixFormat, bool deinterlace);
+	bool reserveBuffer(PhVideoFrame *videoFrame, int size);
+	void buildKeyframeIndex();
+	int64_t keyframeBefore(int64_t time);
+	bool loadIndexCache(QString fileName);
+	void saveIndexCache(QString fileName);
+	void pruneIndexCache(QString cacheFolder);
+	int64_t frame2time(PhFrame f);
+	PhFrame time2frame(int64_t t);
+
+	QString _fileName;
+	PhTimeCodeType _tcType;
+	PhFrame _frameStamp;
+	PhFrame _frameLength;
+
+	AVFormatContext * _pFormatContext;
+	AVStream *_videoStream;
+	AVFrame * _videoFrame;
+	SwsContext * _swsContext;
+	int _threadCount;
+	QAtomicInt _decodeRate;
+	qint64 _decodeBusyTime;
+	int _decodedFrameCount;
+	PhFrame _currentFrame;
+	QVector<PhVideoKeyframe> _keyframes;
+
+	bool _useAudio;
+	AVStream *_audioStream;
+	AVFrame * _audioFrame;
+
+	QMutex _mutex;
+	QWaitCondition _condition;
+	int _bufferSize;
+	QVector<PhVideoFrame> _frames;
+	PhFrame _requestedFrame;
+	PhRate _rate;
+	PhFrame _stalledFrame;
+	/** @brief The frames dropped by the codec in fast modes, which are not decoded again */
+	QSet<PhFrame> _skippedFrames;
+	bool _deinterlace;
+	bool _shaderConversion;
+	int _generation;
+	bool _threadRunning;
+};
+
+#endif // PHVIDEODECODER_H
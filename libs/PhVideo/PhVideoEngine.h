@@ -7,33 +7,23 @@
 #ifndef PHVIDEOENGINE_H
 #define PHVIDEOENGINE_H
 
-extern "C" {
-#ifndef INT64_C
-/** see http://code.google.com/p/ffmpegsource/issues/detail?id=11#c13 */
-#define INT64_C(c) (c ## LL)
-/** and http://code.google.com/p/ffmpegsource/issues/detail?id=11#c23 */
-#define UINT64_C(c) (c ## ULL)
-#endif
-
-#include <libavformat/avformat.h>
-#include <libavutil/avutil.h>
-#include <libavcodec/avcodec.h>
-#include <libswscale/swscale.h>
-}
-
 #include <QObject>
 #include <QElapsedTimer>
 
 #include "PhSync/PhClock.h"
 #include "PhTools/PhTickCounter.h"
 #include "PhGraphic/PhGraphicTexturedRect.h"
+#include "PhGraphic/PhGraphicYUVRect.h"
 
 #include "PhVideoSettings.h"
+#include "PhVideoDecoder.h"
 
 /**
  * @brief The video engine
  *
  * It provide engine which compute the video from a file to an openGL texture.
+ * The decoding is performed ahead of the clock by a PhVideoDecoder thread
+ * so that drawVideo() only uploads a ready frame.
  */
 class PhVideoEngine : public QObject
 {
@@ -155,6 +145,16 @@ public:
 	int refreshRate() {
 		return _videoFrameTickCounter.frequency();
 	}
+	/**
+	 * @brief Get the number of thread used by the codec
+	 * @return A thread count
+	 */
+	int decoderThreadCount();
+	/**
+	 * @brief Get the decoding throughput
+	 * @return A number of frames decoded per second of decoding
+	 */
+	int decodeRate();
 
 	// Methods
 	/**
@@ -219,31 +219,21 @@ signals:
 	void timeCodeTypeChanged(PhTimeCodeType tcType);
 
 private:
-	bool decodeFrame(PhFrame frame);
-	int64_t frame2time(PhFrame f);
-	PhFrame time2frame(int64_t t);
-
 	PhVideoSettings *_settings;
 	QString _fileName;
 	PhTimeCodeType _tcType;
 	PhClock _clock;
 	PhFrame _frameIn;
 
-	AVFormatContext * _pFormatContext;
-	AVStream *_videoStream;
-	AVFrame * _videoFrame;
+	PhVideoDecoder _decoder;
 	PhGraphicTexturedRect _videoRect;
+	PhGraphicYUVRect _yuvRect;
 	PhFrame _currentFrame;
+	bool _yuvFrame;
 
 	PhTickCounter _videoFrameTickCounter;
 
-	bool _useAudio;
-	AVStream *_audioStream;
-	AVFrame * _audioFrame;
-
 	bool _deinterlace;
-
-	uint8_t * _rgb;
 };
 
 #endif // PHVIDEOENGINE_H
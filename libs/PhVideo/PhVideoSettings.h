@@ -18,6 +18,24 @@ public:
 	 * @return A value in millisecond
 	 */
 	virtual int screenDelay() = 0;
+
+	/**
+	 * @brief Convert the planar YUV video frames to RGB in a fragment shader
+	 *
+	 * When disabled, the frames are converted to BGRA on the CPU.
+	 * @return True if the conversion is done by the GPU
+	 */
+	virtual bool videoShaderConversion() {
+		return false;
+	}
+
+	/**
+	 * @brief The number of thread used to decode the video
+	 * @return A thread count or 0 to use as many threads as cores
+	 */
+	virtual int videoDecoderThreadCount() {
+		return 0;
+	}
 };
 
 #endif // PHVIDEOSETTINGS_H
@@ -46,6 +46,7 @@ HEADERS += \
 	GraphicStripTestSettings.h \
 	GraphicStripTest.h \
 	VideoTest.h \
+	VideoDecoderTest.h \
 	VideoTestSettings.h \
 	MidiTest.h \
     SynchronizerTest.h
@@ -65,6 +66,7 @@ SOURCES += main.cpp \
 	GraphicTextTest.cpp \
 	GraphicStripTest.cpp \
 	VideoTest.cpp \
+	VideoDecoderTest.cpp \
 	MidiTest.cpp \
     SynchronizerTest.cpp
 
@@ -4,6 +4,7 @@
  */
 
 #include <QTest>
+#include <QtConcurrent>
 
 #include "PhTools/PhDebug.h"
 
@@ -128,3 +129,149 @@ void ClockTest::tickTest()
 	QCOMPARE(_clock.time(), 12000);
 
 }
+
+void ClockTest::elapseTest()
+{
+	// Elapsing a clock with a null rate should not change the time
+	_clock.elapse(24000);
+	QVERIFY(!_timeChangedCalled);
+	QCOMPARE(_clock.time(), 0);
+
+	_clock.setRate(1);
+	_clock.elapse(400); // 1 frame at 60 fps
+	QCOMPARE(_clock.time(), 400);
+
+	// The fraction of PhTime unit are accumulated
+	_clock.setRate(0.25);
+	for(int i = 0; i < 10; i++)
+		_clock.elapse(1);
+	QCOMPARE(_clock.time(), 402);
+
+	// Ticking at 59.94 Hz during one hour should not drift
+	_clock.setTime(0);
+	_clock.setRate(1000.0 / 1001.0);
+	for(int i = 0; i < 60 * 60 * 60; i++)
+		_clock.tick(60);
+	QCOMPARE(_clock.time(), 24000LL * 60 * 60 * 1000 / 1001);
+}
+
+void ClockTest::updateTest()
+{
+	PhClock clock;
+	clock.setRate(1);
+
+	// The first update only starts the measure
+	clock.update();
+	QCOMPARE(clock.time(), 0);
+
+	QTest::qWait(100);
+	clock.update();
+	QVERIFY(clock.time() >= 2400);
+
+	// The time elapsed before a rate change is accounted at the previous rate
+	PhTime time = clock.time();
+	QTest::qWait(100);
+	clock.setRate(0);
+	QVERIFY(clock.time() >= time + 2400);
+
+	time = clock.time();
+	QTest::qWait(100);
+	clock.update();
+	QCOMPARE(clock.time(), time);
+}
+
+void ClockTest::referenceTest()
+{
+	PhClock reference;
+	PhClock clock;
+	clock.setReference(&reference);
+	clock.setRate(2);
+
+	reference.setTime(1000);
+	clock.update();
+	QCOMPARE(clock.time(), 2000);
+
+	reference.setTime(1500);
+	clock.update();
+	QCOMPARE(clock.time(), 3000);
+
+	clock.setReference(NULL);
+	QVERIFY(clock.reference() == NULL);
+}
+
+void ClockTest::stateTest()
+{
+	PhClockState state;
+	PhClock clock;
+	connect(&clock, &PhClock::timeChanged, [&](PhTime) {
+	            _timeChangedCalled = true;
+			});
+
+	state.write(1000, 2);
+	QCOMPARE(state.time(), 1000);
+	QCOMPARE(state.rate(), 2.0);
+
+	// The clock does not change until it is sampled
+	clock.setState(&state);
+	QCOMPARE(clock.time(), 0);
+	clock.sample();
+	QVERIFY(_timeChangedCalled);
+	QCOMPARE(clock.time(), 1000);
+	QCOMPARE(clock.rate(), 2.0);
+
+	state.writeRate(0);
+	state.writeTime(2000);
+	clock.sample();
+	QCOMPARE(clock.time(), 2000);
+	QCOMPARE(clock.rate(), 0.0);
+
+	// The values read while another thread writes are consistent
+	QFuture<void> writer = QtConcurrent::run([&]() {
+		for(int i = 1; i <= 100000; i++)
+			state.write(i, i);
+	});
+
+	PhTime time;
+	PhRate rate;
+	bool consistent = true;
+	do {
+		state.read(&time, &rate);
+		consistent &= (static_cast<PhRate>(time) == rate);
+	} while(time < 100000);
+	writer.waitForFinished();
+	QVERIFY(consistent);
+}
+
+void ClockTest::stateRequestTest()
+{
+	PhClockState state;
+	PhClock clock;
+	PhRate rate;
+
+	state.write(1000, 0);
+	clock.setState(&state);
+	clock.sample();
+	QCOMPARE(clock.rate(), 0.0);
+	QVERIFY(!state.takeRequestedRate(&rate));
+
+	// The rate set locally is requested to the producer
+	clock.setRate(1);
+	QCOMPARE(clock.rate(), 1.0);
+	QVERIFY(state.takeRequestedRate(&rate));
+	QCOMPARE(rate, 1.0);
+	QVERIFY(!state.takeRequestedRate(&rate));
+
+	// It is not reverted until the producer changes its rate
+	clock.sample();
+	QCOMPARE(clock.rate(), 1.0);
+
+	state.write(2000, 1);
+	clock.sample();
+	QCOMPARE(clock.time(), 2000);
+	QCOMPARE(clock.rate(), 1.0);
+
+	state.writeRate(-1);
+	clock.sample();
+	QCOMPARE(clock.rate(), -1.0);
+	QVERIFY(!state.takeRequestedRate(&rate));
+}
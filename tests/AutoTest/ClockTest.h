@@ -29,6 +29,11 @@ private slots:
 	void msTest();
 	void tcTest();
 	void tickTest();
+	void elapseTest();
+	void updateTest();
+	void referenceTest();
+	void stateTest();
+	void stateRequestTest();
 
 private:
 	PhClock _clock;
@@ -106,6 +106,25 @@ void DebugTest::stdoutTest()
 	QCOMPARE(lines[8], QString("it should be displayed when default log mask is 2"));
 }
 
+void DebugTest::filteredLevelTest()
+{
+	int count = 0;
+
+	// The message of a filtered level is not formatted
+	PHDBG(2) << ++count;
+	QCOMPARE(count, 0);
+
+	PhDebug::setLogMask(4);
+	PHDBG(2) << ++count;
+	QCOMPARE(count, 1);
+
+	if(count == 0)
+		PHDBG(2) << "never";
+	else
+		count++;
+	QCOMPARE(count, 2);
+}
+
 void DebugTest::stderrTest()
 {
 	std::stringstream buffer;
@@ -15,6 +15,7 @@ private slots:
 	void initTestCase();
 	void init();
 	void stdoutTest();
+	void filteredLevelTest();
 	void stderrTest();
 	void logFileTest();
 };
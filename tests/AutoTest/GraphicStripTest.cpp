@@ -5,6 +5,7 @@
 
 #include <QTest>
 #include <QWindow>
+#include <QtMath>
 
 #include "PhTools/PhPictureTools.h"
 
@@ -15,12 +16,11 @@
 
 #include "GraphicStripTest.h"
 
-void GraphicStripTest::drawTest()
+QImage GraphicStripTest::drawStrip(GraphicStripTestSettings *settings, bool texts)
 {
 	PhGraphicView view(980, 320);
 
-	GraphicStripTestSettings _settings;
-	PhGraphicStrip _strip(&_settings);
+	PhGraphicStrip _strip(settings);
 
 	connect(&view, &PhGraphicView::paint, [&](int w, int h) {
 	            _strip.draw(0, 0, w, h);
@@ -31,11 +31,13 @@ void GraphicStripTest::drawTest()
 	doc->addPeople(new PhPeople("A people"));
 	doc->addPeople(new PhPeople("A second people", "red"));
 
-	doc->addObject(new PhStripText(0, doc->peoples().first(), 10000, 0.25f, "Hello", 0.25f));
+	if(texts)
+		doc->addObject(new PhStripText(0, doc->peoples().first(), 10000, 0.25f, "Hello", 0.25f));
 	doc->addObject(new PhStripCut(5400, PhStripCut::CrossFade));
 	doc->addObject(new PhStripDetect(PhStripDetect::Off, 0, doc->peoples().first(), 10000, 0.25f));
 	doc->addObject(new PhStripLoop(22000, "label"));
-	doc->addObject(new PhStripText(10000, doc->peoples().last(), 15000, 0.5f, "Hi !", 0.25f));
+	if(texts)
+		doc->addObject(new PhStripText(10000, doc->peoples().last(), 15000, 0.5f, "Hi !", 0.25f));
 	doc->addObject(new PhStripDetect(PhStripDetect::SemiOff, 10000, doc->peoples().last(), 15000, 0.5f));
 	doc->changed();
 
@@ -44,10 +46,86 @@ void GraphicStripTest::drawTest()
 	QImage resultImage(view.renderPixmap(980, 320).toImage());
 	QString resultFile = QString("%1.result.bmp").arg(QTest::currentTestFunction());
 	resultImage.save(resultFile);
-	QString expectedFile = QString("%1.expected.bmp").arg(QTest::currentTestFunction());
-	QImage expectedImage(expectedFile);
+	return resultImage;
+}
+
+static int pixelDifference(QRgb a, QRgb b)
+{
+	return qPow(qRed(a) - qRed(b), 2) + qPow(qGreen(a) - qGreen(b), 2) + qPow(qBlue(a) - qBlue(b), 2);
+}
+
+void GraphicStripTest::drawTest()
+{
+	GraphicStripTestSettings settings;
+	QImage resultImage = drawStrip(&settings);
+	QImage expectedImage("drawTest.expected.bmp");
 
 	unsigned int result = PhPictureTools::compare(resultImage, expectedImage);
 	PHDEBUG << "result:" << result;
 	QVERIFY(result < 920 * 320 / 4); // accept a difference of 1 per 4 pixels
 }
+
+void GraphicStripTest::drawTileCacheTest()
+{
+	// The reference is drawn directly with the same driver so that
+	// the tiles shall give back the same picture.
+	GraphicStripTestSettings settings;
+	QImage expectedImage = drawStrip(&settings);
+	expectedImage.save(QString("%1.reference.bmp").arg(QTest::currentTestFunction()));
+
+	settings.setStripTileCache(true);
+	QImage resultImage = drawStrip(&settings);
+
+	unsigned int result = PhPictureTools::compare(resultImage, expectedImage);
+	PHDEBUG << "result:" << result;
+	QVERIFY(result < 980 * 320 / 100); // accept a difference of 1 per 100 pixels
+}
+
+void GraphicStripTest::drawDistanceFieldTest()
+{
+	// The references are drawn with the same driver: with the bitmap
+	// glyphs and without any text.
+	GraphicStripTestSettings settings;
+	QImage bitmapImage = drawStrip(&settings);
+	bitmapImage.save(QString("%1.reference.bmp").arg(QTest::currentTestFunction()));
+	QImage backgroundImage = drawStrip(&settings, false);
+
+	settings.setTextDistanceField(true);
+	QImage resultImage = drawStrip(&settings);
+	QCOMPARE(resultImage.size(), bitmapImage.size());
+
+	// Outside of the texts (with a margin for the glyph edges)
+	// the picture is the same, inside the glyphs cover the same area.
+	int margin = 2;
+	unsigned int result = 0;
+	int bitmapGlyphPixels = 0;
+	int resultGlyphPixels = 0;
+	for(int i = 0; i < resultImage.width(); i++) {
+		for(int j = 0; j < resultImage.height(); j++) {
+			bool textArea = false;
+			for(int u = qMax(0, i - margin); (u <= qMin(resultImage.width() - 1, i + margin)) && !textArea; u++) {
+				for(int v = qMax(0, j - margin); v <= qMin(resultImage.height() - 1, j + margin); v++) {
+					if(bitmapImage.pixel(u, v) != backgroundImage.pixel(u, v)) {
+						textArea = true;
+						break;
+					}
+				}
+			}
+
+			if(textArea) {
+				if(bitmapImage.pixel(i, j) != backgroundImage.pixel(i, j))
+					bitmapGlyphPixels++;
+				if(resultImage.pixel(i, j) != backgroundImage.pixel(i, j))
+					resultGlyphPixels++;
+			}
+			else
+				result += pixelDifference(resultImage.pixel(i, j), bitmapImage.pixel(i, j));
+		}
+	}
+
+	PHDEBUG << "result:" << result << "glyph pixels:" << resultGlyphPixels << "/" << bitmapGlyphPixels;
+	QCOMPARE(result, 0u);
+	QVERIFY(bitmapGlyphPixels > 0);
+	QVERIFY(resultGlyphPixels > bitmapGlyphPixels * 3 / 4);
+	QVERIFY(resultGlyphPixels < bitmapGlyphPixels * 5 / 4);
+}
@@ -7,6 +7,9 @@
 #define GRAPHICSTRIPTEST_H
 
 #include <QObject>
+#include <QImage>
+
+class GraphicStripTestSettings;
 
 class GraphicStripTest : public QObject
 {
@@ -14,6 +17,11 @@ class GraphicStripTest : public QObject
 
 private slots:
 	void drawTest();
+	void drawTileCacheTest();
+	void drawDistanceFieldTest();
+
+private:
+	QImage drawStrip(GraphicStripTestSettings *settings, bool texts = true);
 
 };
 
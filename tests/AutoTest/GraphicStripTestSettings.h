@@ -12,6 +12,9 @@
 class GraphicStripTestSettings : public PhGraphicStripSettings
 {
 public:
+	GraphicStripTestSettings() : _stripTileCache(false), _textDistanceField(false) {
+	}
+
 	// PhGraphicSettings
 	int screenDelay() {
 		return 0;
@@ -91,6 +94,24 @@ public:
 	int backgroundColorDark() {
 		return 0x242e2c;
 	}
+
+	bool stripTileCache() {
+		return _stripTileCache;
+	}
+	void setStripTileCache(bool enabled) {
+		_stripTileCache = enabled;
+	}
+
+	bool textDistanceField() {
+		return _textDistanceField;
+	}
+	void setTextDistanceField(bool enabled) {
+		_textDistanceField = enabled;
+	}
+
+private:
+	bool _stripTileCache;
+	bool _textDistanceField;
 };
 
 #endif // GRAPHICSTRIPTESTSETTINGS_H
@@ -11,6 +11,7 @@
 #include "PhGraphic/PhGraphicSolidRect.h"
 #include "PhGraphic/PhGraphicTexturedRect.h"
 #include "PhGraphic/PhGraphicImage.h"
+#include "PhGraphic/PhGraphicBatch.h"
 
 
 #include "GraphicTest.h"
@@ -127,3 +128,42 @@ void GraphicTest::rgbPatternTest()
 	unsigned int result = PhPictureTools::compare(resultImage, expectedImage);
 	QVERIFY2(result == 0, PHNQ(QString("Comparison result=%1").arg(result)));
 }
+
+void GraphicTest::batchTest()
+{
+	PhGraphicView view1(64, 64);
+	PhGraphicView view2(64, 64);
+
+	// The disc sizes keep the pixel centers away from the triangle edges
+	auto paint = [&](int, int) {
+		// The nearest rectangle is added first
+		PhGraphicBatch::addRect(8, 8, 32, 32, 1, Qt::red);
+		PhGraphicBatch::addRect(24, 24, 32, 32, -1, Qt::blue);
+		PhGraphicBatch::addDisc(44, 20, 12.5f, 4, 2, Qt::green);
+		// The depth test keeps the order across the flushes
+		PhGraphicBatch::flush();
+		PhGraphicBatch::addRect(0, 52, 64, 8, 0, Qt::white);
+		PhGraphicBatch::addDisc(12, 52, 8.5f, 4, -2, Qt::yellow);
+	};
+
+	connect(&view1, &PhGraphicView::paint, paint);
+	connect(&view2, &PhGraphicView::paint, paint);
+
+	view1.show();
+	view2.show();
+
+	QString expectedFile = QString("%1.expected.bmp").arg(QTest::currentTestFunction());
+	QImage expectedImage(expectedFile);
+
+	// Each rendering uses its own context: the vertex buffer shall follow
+	QList<PhGraphicView*> views;
+	views << &view1 << &view2 << &view1;
+	for(int i = 0; i < views.count(); i++) {
+		QImage resultImage(views[i]->renderPixmap(64, 64).toImage());
+		QString resultFile = QString("%1.%2.result.bmp").arg(QTest::currentTestFunction()).arg(i);
+		resultImage.save(resultFile);
+
+		unsigned int result = PhPictureTools::compare(resultImage, expectedImage);
+		QVERIFY2(result == 0, PHNQ(QString("Comparison result=%1").arg(result)));
+	}
+}
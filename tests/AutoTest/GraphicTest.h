@@ -20,6 +20,7 @@ private slots:
 	void rectTest();
 	void imageTest();
 	void rgbPatternTest();
+	void batchTest();
 };
 
 #endif // GRAPHICTEST_H
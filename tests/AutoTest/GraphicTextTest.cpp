@@ -107,3 +107,20 @@ void GraphicTextTest::computeMaxFontSizeTest()
 	QCOMPARE(PhFont::computeMaxFontSize("Bedizen.ttf"), 97);
 	QCOMPARE(PhFont::computeMaxFontSize("weblysleekuil.ttf"), 94);
 }
+
+void GraphicTextTest::unicodeAdvanceTest()
+{
+	PhGraphicView view;
+
+	PhFont font;
+	font.setFontFile("Arial.ttf");
+
+	QVERIFY(font.getAdvance('a') > 0);
+	QVERIFY(font.getAdvance(0x0153) > 0); // latin small ligature oe
+	QVERIFY(font.getAdvance(0x0142) > 0); // latin small letter l with stroke
+	QVERIFY(font.getAdvance(0x0416) > 0); // cyrillic capital letter zhe
+	QVERIFY(font.getAdvance(0x03A9) > 0); // greek capital letter omega
+	QCOMPARE(font.getAdvance(0x1F600), 0); // outside of the basic multilingual plane
+
+	QCOMPARE(font.getNominalWidth(QString::fromUtf8("Ωa")), font.getAdvance(0x03A9) + font.getAdvance('a'));
+}
@@ -18,6 +18,7 @@ private slots:
 	void fontTest();
 	void fontTest_data();
 	void computeMaxFontSizeTest();
+	void unicodeAdvanceTest();
 };
 
 #endif // GRAPHICTEXTTEST_H
@@ -238,6 +238,7 @@ void MidiTest::testMTCReader()
 	QCOMPARE(tcTypeCalled, 1);
 	QCOMPARE(tcType, PhTimeCodeType24);
 	QCOMPARE(mtcReader.timeCodeType(), PhTimeCodeType24);
+	mtcReader.clock()->sample();
 	QCOMPARE(t2s(mtcReader.clock()->time(), PhTimeCodeType24), QString("01:00:00:00"));
 
 	//
@@ -247,6 +248,7 @@ void MidiTest::testMTCReader()
 	midiOut.sendQFTC(0x02); // Send frame low digit
 	QThread::msleep(10);
 
+	mtcReader.clock()->sample();
 	QCOMPARE(t2s(mtcReader.clock()->time(), PhTimeCodeType24), QString("01:00:00:00"));
 	QVERIFY(PhTestTools::compareFloats(mtcReader.clock()->rate(), 1));
 
@@ -260,6 +262,7 @@ void MidiTest::testMTCReader()
 	QThread::msleep(10);
 
 	// Since 4 quarter frame message have elapsed the frame increment by one
+	mtcReader.clock()->sample();
 	QCOMPARE(t2s(mtcReader.clock()->time(), PhTimeCodeType24), QString("01:00:00:01"));
 
 	midiOut.sendQFTC(0x40); // Send minute low digit
@@ -271,6 +274,7 @@ void MidiTest::testMTCReader()
 	midiOut.sendQFTC(0x70); // Send hour high digit and 24 fps info
 	QThread::msleep(10);
 
+	mtcReader.clock()->sample();
 	QCOMPARE(t2s(mtcReader.clock()->time(), PhTimeCodeType24), QString("01:00:00:02"));
 
 	// Send 8 quarter frame message from another timecode (23:40:19:20)
@@ -283,6 +287,7 @@ void MidiTest::testMTCReader()
 	QThread::msleep(10);
 	midiOut.sendQFTC(0x31); // Send second high digit
 	QThread::msleep(10);
+	mtcReader.clock()->sample();
 	QCOMPARE(t2s(mtcReader.clock()->time(), PhTimeCodeType24), QString("01:00:00:03"));
 	midiOut.sendQFTC(0x48); // Send minute low digit
 	QThread::msleep(10);
@@ -292,6 +297,7 @@ void MidiTest::testMTCReader()
 	QThread::msleep(10);
 	midiOut.sendQFTC(0x71); // Send hour high digit and 24 fps info
 	QThread::msleep(10);
+	mtcReader.clock()->sample();
 	QCOMPARE(t2s(mtcReader.clock()->time(), PhTimeCodeType24), QString("23:40:19:22"));
 
 	// Send the next 8 quarter frame message to check passing seconds
@@ -304,6 +310,7 @@ void MidiTest::testMTCReader()
 	QThread::msleep(10);
 	midiOut.sendQFTC(0x31); // Send second high digit
 	QThread::msleep(10);
+	mtcReader.clock()->sample();
 	QCOMPARE(t2s(mtcReader.clock()->time(), PhTimeCodeType24), QString("23:40:19:23"));
 	midiOut.sendQFTC(0x48); // Send minute low digit
 	QThread::msleep(10);
@@ -314,6 +321,7 @@ void MidiTest::testMTCReader()
 	midiOut.sendQFTC(0x71); // Send hour high digit and 24 fps info
 	QThread::msleep(10);
 
+	mtcReader.clock()->sample();
 	QCOMPARE(t2s(mtcReader.clock()->time(), PhTimeCodeType24), QString("23:40:20:00"));
 
 	// Test passing minutes (from 10:03:59:20 to 10:04:00:00)
@@ -326,6 +334,7 @@ void MidiTest::testMTCReader()
 	QThread::msleep(10);
 	midiOut.sendQFTC(0x33); // Send second high digit
 	QThread::msleep(10);
+	mtcReader.clock()->sample();
 	QCOMPARE(t2s(mtcReader.clock()->time(), PhTimeCodeType24), QString("23:40:20:01"));
 	midiOut.sendQFTC(0x43); // Send minute low digit
 	QThread::msleep(10);
@@ -335,6 +344,7 @@ void MidiTest::testMTCReader()
 	QThread::msleep(10);
 	midiOut.sendQFTC(0x70); // Send hour high digit and 24 fps info
 	QThread::msleep(10);
+	mtcReader.clock()->sample();
 	QCOMPARE(t2s(mtcReader.clock()->time(), PhTimeCodeType24), QString("10:03:59:22"));
 	midiOut.sendQFTC(0x00); // Send frame low digit
 	QThread::msleep(10);
@@ -344,6 +354,7 @@ void MidiTest::testMTCReader()
 	QThread::msleep(10);
 	midiOut.sendQFTC(0x30); // Send second high digit
 	QThread::msleep(10);
+	mtcReader.clock()->sample();
 	QCOMPARE(t2s(mtcReader.clock()->time(), PhTimeCodeType24), QString("10:03:59:23"));
 	midiOut.sendQFTC(0x44); // Send minute low digit
 	QThread::msleep(10);
@@ -353,6 +364,7 @@ void MidiTest::testMTCReader()
 	QThread::msleep(10);
 	midiOut.sendQFTC(0x70); // Send hour high digit and 24 fps info
 	QThread::msleep(10);
+	mtcReader.clock()->sample();
 	QCOMPARE(t2s(mtcReader.clock()->time(), PhTimeCodeType24), QString("10:04:00:00"));
 	midiOut.sendQFTC(0x02); // Send frame low digit
 	QThread::msleep(10);
@@ -362,6 +374,7 @@ void MidiTest::testMTCReader()
 	QThread::msleep(10);
 	midiOut.sendQFTC(0x30); // Send second high digit
 	QThread::msleep(10);
+	mtcReader.clock()->sample();
 	QCOMPARE(t2s(mtcReader.clock()->time(), PhTimeCodeType24), QString("10:04:00:01"));
 	midiOut.sendQFTC(0x44); // Send minute low digit
 	QThread::msleep(10);
@@ -371,6 +384,7 @@ void MidiTest::testMTCReader()
 	QThread::msleep(10);
 	midiOut.sendQFTC(0x70); // Send hour high digit and 24 fps info
 	QThread::msleep(10);
+	mtcReader.clock()->sample();
 	QCOMPARE(t2s(mtcReader.clock()->time(), PhTimeCodeType24), QString("10:04:00:02"));
 
 	// Switch to 25 fps timecode
@@ -385,6 +399,7 @@ void MidiTest::testMTCReader()
 	QThread::msleep(10);
 	midiOut.sendQFTC(0x30); // Send second high digit
 	QThread::msleep(10);
+	mtcReader.clock()->sample();
 	QCOMPARE(t2s(mtcReader.clock()->time(), PhTimeCodeType24), QString("10:04:00:03"));
 	midiOut.sendQFTC(0x44); // Send minute low digit
 	QThread::msleep(10);
@@ -398,6 +413,7 @@ void MidiTest::testMTCReader()
 	QCOMPARE(tcTypeCalled, 2);
 	QCOMPARE(tcType, PhTimeCodeType25);
 	QCOMPARE(mtcReader.timeCodeType(), PhTimeCodeType25);
+	mtcReader.clock()->sample();
 	QCOMPARE(t2s(mtcReader.clock()->time(), PhTimeCodeType25), QString("10:04:00:04"));
 
 	// Stop sending quarter frame MTC message should stop the reader after one frame:
@@ -1,3 +1,5 @@
+#include <QtConcurrent>
+
 #include "SettingsTest.h"
 #include "AutoTestSettings.h"
 
@@ -181,3 +183,81 @@ void SettingsTest::testByteArraySettings()
 	for(int i = 0; i < array1.size(); i++)
 		QCOMPARE(array2.at(i), array1.at(i));
 }
+
+void SettingsTest::testVersion()
+{
+	AutoTestSettings settings(true);
+
+	int version = settings.version();
+	QCOMPARE(settings.intTest1(), 0);
+	QCOMPARE(settings.version(), version);
+
+	settings.setIntTest1(3);
+	QVERIFY(settings.version() > version);
+	QCOMPARE(settings.intTest1(), 3);
+
+	// The values depending on another one are read again after a write
+	QCOMPARE(settings.intTest4(), 3);
+	settings.setIntTest1(5);
+	QCOMPARE(settings.intTest4(), 5);
+
+	// The values falling back to their default are read again after a write
+	settings.setStringListTest3(QStringList("d"));
+	QCOMPARE(settings.stringListTest3(), QStringList("d"));
+	settings.setStringListTest3(QStringList());
+	QCOMPARE(settings.stringListTest3(), QStringList({"a", "b", "c"}));
+
+	version = settings.version();
+	settings.clear();
+	QVERIFY(settings.version() > version);
+	QCOMPARE(settings.intTest1(), 0);
+	QCOMPARE(settings.intTest4(), 0);
+}
+
+void SettingsTest::testThreadedRead()
+{
+	AutoTestSettings settings(true);
+
+	// A real time thread reads a value while the main thread writes it
+	QFuture<bool> reader = QtConcurrent::run([&]() {
+		int previous = 0;
+		while(previous < 1000) {
+			int value = settings.intTest1();
+			if(value < previous)
+				return false;
+			previous = value;
+		}
+		return true;
+	});
+
+	for(int i = 1; i <= 1000; i++)
+		settings.setIntTest1(i);
+
+	reader.waitForFinished();
+	QVERIFY(reader.result());
+	QCOMPARE(settings.intTest1(), 1000);
+}
+
+void SettingsTest::testThreadedStringRead()
+{
+	AutoTestSettings settings(true);
+
+	// The string values are read without lock while they are replaced
+	QFuture<bool> reader = QtConcurrent::run([&]() {
+		int previous = 0;
+		while(previous < 1000) {
+			int value = settings.stringTest1().toInt();
+			if(value < previous)
+				return false;
+			previous = value;
+		}
+		return true;
+	});
+
+	for(int i = 1; i <= 1000; i++)
+		settings.setStringTest1(QString::number(i));
+
+	reader.waitForFinished();
+	QVERIFY(reader.result());
+	QCOMPARE(settings.stringTest1(), QString("1000"));
+}
@@ -19,6 +19,9 @@ private slots:
 	void testStringSettings();
 	void testStringListSettings();
 	void testByteArraySettings();
+	void testVersion();
+	void testThreadedRead();
+	void testThreadedStringRead();
 };
 
 #endif // PHSETTINGSTEST_H
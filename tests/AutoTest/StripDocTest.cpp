@@ -345,6 +345,36 @@ void StripDocTest::importMosTest04()
 	QCOMPARE(doc.detects()[0]->type(), PhStripDetect::Off);
 }
 
+void StripDocTest::importMosTruncatedTest()
+{
+	PhStripDoc doc;
+
+	QFile source("test04.mos");
+	QVERIFY(source.open(QFile::ReadOnly));
+	QByteArray data = source.readAll();
+	source.close();
+
+	// The file stops in the middle of the tracks
+	QTemporaryFile truncated("XXXXXX.mos");
+	QVERIFY(truncated.open());
+	truncated.write(data.left(data.size() / 2));
+	truncated.close();
+
+	QVERIFY(!doc.importMosFile(truncated.fileName()));
+
+	// Nothing is kept from the part read before the failure
+	QCOMPARE(doc.peoples().count(), 0);
+	QCOMPARE(doc.texts().count(), 0);
+	QCOMPARE(doc.detects().count(), 0);
+	QCOMPARE(doc.cuts().count(), 0);
+
+	QTemporaryFile empty("XXXXXX.mos");
+	QVERIFY(empty.open());
+	empty.close();
+
+	QVERIFY(!doc.importMosFile(empty.fileName()));
+}
+
 void StripDocTest::importDrbTest01()
 {
 	PhStripDoc doc;
@@ -562,6 +592,96 @@ void StripDocTest::openStripFileTest()
 #warning /// @todo Test video frame rate
 }
 
+void StripDocTest::cacheTest()
+{
+	QString cacheFileName = PhStripDoc::cacheFileName("test04.mos");
+	QFile::remove(cacheFileName);
+
+	PhStripDoc doc1;
+	QVERIFY(!doc1.readCacheFile(cacheFileName, "test04.mos"));
+	QVERIFY(doc1.importMosFile("test04.mos"));
+	QVERIFY(doc1.writeCacheFile(cacheFileName, "test04.mos"));
+
+	PhStripDoc doc2;
+	QVERIFY(doc2.readCacheFile(cacheFileName, "test04.mos"));
+
+	QCOMPARE(doc2.filePath(), QString("test04.mos"));
+	QCOMPARE(doc2.generator(), doc1.generator());
+	QCOMPARE(doc2.title(), doc1.title());
+	QCOMPARE(doc2.authorName(), doc1.authorName());
+	QCOMPARE(doc2.videoTimeCodeType(), doc1.videoTimeCodeType());
+	QCOMPARE(doc2.videoTimeIn(), doc1.videoTimeIn());
+	QCOMPARE(doc2.metaKeys(), doc1.metaKeys());
+	foreach(QString key, doc1.metaKeys())
+		QCOMPARE(doc2.metaInformation(key), doc1.metaInformation(key));
+
+	QCOMPARE(doc2.peoples().count(), doc1.peoples().count());
+	for(int i = 0; i < doc1.peoples().count(); i++)
+		QCOMPARE(doc2.peoples()[i]->name(), doc1.peoples()[i]->name());
+
+	for(int k = 0; k < 2; k++) {
+		QList<PhStripText*> texts1 = doc1.texts(k == 1);
+		QList<PhStripText*> texts2 = doc2.texts(k == 1);
+		QCOMPARE(texts2.count(), texts1.count());
+		for(int i = 0; i < texts1.count(); i++) {
+			QCOMPARE(texts2[i]->timeIn(), texts1[i]->timeIn());
+			QCOMPARE(texts2[i]->timeOut(), texts1[i]->timeOut());
+			QCOMPARE(texts2[i]->content(), texts1[i]->content());
+			QCOMPARE(doc2.peoples().indexOf(texts2[i]->people()), doc1.peoples().indexOf(texts1[i]->people()));
+			QCOMPARE(texts2[i]->y(), texts1[i]->y());
+		}
+	}
+
+	QCOMPARE(doc2.detects().count(), doc1.detects().count());
+	for(int i = 0; i < doc1.detects().count(); i++) {
+		QCOMPARE(doc2.detects()[i]->timeIn(), doc1.detects()[i]->timeIn());
+		QCOMPARE(doc2.detects()[i]->timeOut(), doc1.detects()[i]->timeOut());
+		QCOMPARE(doc2.detects()[i]->type(), doc1.detects()[i]->type());
+	}
+
+	QCOMPARE(doc2.loops().count(), doc1.loops().count());
+	for(int i = 0; i < doc1.loops().count(); i++) {
+		QCOMPARE(doc2.loops()[i]->timeIn(), doc1.loops()[i]->timeIn());
+		QCOMPARE(doc2.loops()[i]->label(), doc1.loops()[i]->label());
+	}
+
+	QCOMPARE(doc2.cuts().count(), doc1.cuts().count());
+	for(int i = 0; i < doc1.cuts().count(); i++)
+		QCOMPARE(doc2.cuts()[i]->timeIn(), doc1.cuts()[i]->timeIn());
+
+	// The cache does not match another source file
+	QVERIFY(!doc2.readCacheFile(cacheFileName, "test03.mos"));
+	QFile::remove(cacheFileName);
+
+	// The last position of a DetX file is kept in the cache
+	cacheFileName = PhStripDoc::cacheFileName("test01.detx");
+	QFile::remove(cacheFileName);
+
+	QVERIFY(doc1.importDetXFile("test01.detx"));
+	QVERIFY(doc1.writeCacheFile(cacheFileName, "test01.detx"));
+	QVERIFY(doc2.readCacheFile(cacheFileName, "test01.detx"));
+	QCOMPARE(t2s(doc2.lastTime(), PhTimeCodeType25), QString("01:00:16:00"));
+	QFile::remove(cacheFileName);
+
+	// The joker file import writes the cache and reads it the next time
+
+	PhStripDoc doc3;
+	doc3.setCacheEnabled(true);
+	QVERIFY(doc3.cacheEnabled());
+	QVERIFY(doc3.openStripFile("test01.joker"));
+	QVERIFY(QFile::exists(cacheFileName));
+	QVERIFY(doc3.openStripFile("test01.joker"));
+
+	QCOMPARE(doc3.filePath(), QString("test01.detx"));
+	QCOMPARE(doc3.videoFilePath(), QString("test01.mov"));
+	QCOMPARE(t2s(doc3.videoTimeIn(), PhTimeCodeType25), QString("01:01:00:00"));
+	QCOMPARE(t2s(doc3.lastTime(), PhTimeCodeType25), QString("01:30:00:00"));
+	QCOMPARE(doc3.title(), QString("Title test"));
+	QCOMPARE(doc3.generator(), QString("Cappella v0.12.5, 1"));
+
+	QFile::remove(cacheFileName);
+}
+
 void StripDocTest::openSaveTest01()
 {
 	PhStripDoc doc1;
@@ -727,6 +847,30 @@ void StripDocTest::getPreviousLoopTest()
 	QCOMPARE(t2s(doc.previousLoop(s2t("23:00:00:00", tcType))->timeIn(), tcType), QString("01:01:00:00"));
 }
 
+void StripDocTest::getTextsByPeopleTest()
+{
+	PhStripDoc doc;
+
+	QVERIFY(doc.importDetXFile("test01.detx"));
+	PhTimeCodeType tcType = PhTimeCodeType25;
+
+	PhPeople *sue = doc.peopleByName("Sue");
+	int count = doc.texts(sue).count();
+	QVERIFY(count > 0);
+	foreach(PhStripText *text, doc.texts(sue))
+		QCOMPARE(text->people(), sue);
+
+	// The added text is inserted at its place in the people list
+	doc.addObject(new PhStripText(s2t("01:00:10:00", tcType), sue, s2t("01:00:11:00", tcType), 0, "Added", 0.25f));
+	QCOMPARE(doc.texts(sue).count(), count + 1);
+	QCOMPARE(doc.nextText(sue, s2t("01:00:06:00", tcType))->content(), QString("Added"));
+	QCOMPARE(doc.nextText(s2t("01:00:06:00", tcType))->content(), QString("Added"));
+	QCOMPARE(t2s(doc.previousTextTime(s2t("01:00:12:00", tcType)), tcType), QString("01:00:10:00"));
+
+	PhPeople nobody("Nobody");
+	QVERIFY(doc.texts(&nobody).isEmpty());
+}
+
 void StripDocTest::addObjectTest()
 {
 	PhStripDoc doc;
@@ -754,6 +898,49 @@ void StripDocTest::addPeopleTest()
 
 }
 
+void StripDocTest::visibleRangeTest()
+{
+	PhStripDoc doc;
+	doc.addPeople(new PhPeople("A people"));
+
+	// Added in a random order
+	doc.addObject(new PhStripText(30000, doc.peoples().last(), 40000, 0, "Third", 0.25f));
+	doc.addObject(new PhStripText(0, doc.peoples().last(), 10000, 0, "First", 0.25f));
+	doc.addObject(new PhStripText(10000, doc.peoples().last(), 25000, 0, "Second", 0.25f));
+	doc.addObject(new PhStripLoop(20000, "2"));
+	doc.addObject(new PhStripLoop(5000, "1"));
+	doc.addObject(new PhStripCut(12000, PhStripCut::Simple));
+	doc.addObject(new PhStripDetect(PhStripDetect::Off, 8000, doc.peoples().last(), 28000, 0));
+
+	QCOMPARE(doc.texts()[0]->content(), QString("First"));
+	QCOMPARE(doc.texts()[1]->content(), QString("Second"));
+	QCOMPARE(doc.texts()[2]->content(), QString("Third"));
+	QCOMPARE(doc.loops()[0]->label(), QString("1"));
+
+	QCOMPARE(doc.visibleTexts(PHTIMEMIN, PHTIMEMAX).count(), 3);
+	QCOMPARE(doc.visibleTexts(24000, 28000).count(), 1);
+	QCOMPARE((*doc.visibleTexts(24000, 28000).begin())->content(), QString("Second"));
+	QVERIFY(doc.visibleTexts(26000, 28000).isEmpty());
+	QCOMPARE(doc.visibleTexts(20000, 35000).count(), 2);
+	// "Third" is in the range since the longest text could intersect it
+	QCOMPARE(doc.visibleTexts(41000, 50000).count(), 1);
+	QVERIFY(doc.visibleTexts(-10000, -1).isEmpty());
+
+	QCOMPARE(doc.visibleLoops(0, 10000).count(), 1);
+	QCOMPARE((*doc.visibleLoops(0, 10000).begin())->label(), QString("1"));
+	QCOMPARE(doc.visibleLoops(5000, 20000).count(), 2);
+	QVERIFY(doc.visibleLoops(21000, 30000).isEmpty());
+
+	QCOMPARE(doc.visibleCuts(12000, 12000).count(), 1);
+	QVERIFY(doc.visibleCuts(0, 11000).isEmpty());
+
+	QCOMPARE(doc.visibleDetects(27000, 30000).count(), 1);
+	QVERIFY(doc.visibleDetects(0, 7000).isEmpty());
+
+	QCOMPARE(doc.detects(0, 30000).count(), 1);
+	QVERIFY(doc.detects(10000, 30000).isEmpty());
+}
+
 #warning /// @todo Move to PhTest
 QString StripDocTest::t2s(PhTime time, PhTimeCodeType tcType)
 {
@@ -773,3 +960,56 @@ void StripDocTest::importDetXNoTitleTest()
 	QVERIFY(doc.title() == "notitle");
 
 }
+
+void StripDocTest::importDetXBadFormedTest()
+{
+	PhStripDoc doc;
+
+	QTemporaryFile badRoot("XXXXXX.detx");
+	QVERIFY(badRoot.open());
+	badRoot.write("<?xml version=\"1.0\"?><mos><header><title>Bad root</title></header></mos>");
+	badRoot.close();
+	QVERIFY(!doc.importDetXFile(badRoot.fileName()));
+
+	// The document stops in the middle of the body
+	QTemporaryFile truncated("XXXXXX.detx");
+	QVERIFY(truncated.open());
+	truncated.write("<?xml version=\"1.0\"?><detx><header><title>Truncated</title></header>"
+	                "<body><loop timecode=\"01:00:00:00\"/><line role=\"a\" track=\"0\">"
+	                "<lipsync timecode=\"01:00:01:00\" link=\"on\"/><text>Hel");
+	truncated.close();
+	QVERIFY(!doc.importDetXFile(truncated.fileName()));
+
+	QCOMPARE(doc.title(), QString(""));
+	QCOMPARE(doc.loops().count(), 0);
+	QCOMPARE(doc.detects().count(), 0);
+}
+
+void StripDocTest::importDetXRolesAfterBodyTest()
+{
+	PhStripDoc doc;
+
+	QVERIFY(doc.importDetXFile("roles_after_body.detx"));
+
+	QCOMPARE(doc.peoples().count(), 2);
+	PhPeople *jeanne = doc.peopleByName("Jeanne");
+	PhPeople *paul = doc.peopleByName("Paul");
+	QVERIFY(jeanne);
+	QVERIFY(paul);
+	QCOMPARE(jeanne->color(), QString("#00BB00"));
+
+	QCOMPARE(doc.texts().count(), 4);
+	QCOMPARE(doc.texts()[0]->people(), jeanne);
+	QCOMPARE(doc.texts()[1]->people(), paul);
+	QCOMPARE(doc.texts()[2]->people(), paul);
+	// An undeclared role has no people
+	QVERIFY(doc.texts()[3]->people() == NULL);
+
+	QCOMPARE(doc.detects().count(), 3);
+	QCOMPARE(doc.detects()[0]->people(), jeanne);
+	QCOMPARE(doc.detects()[1]->people(), paul);
+	QVERIFY(doc.detects()[2]->people() == NULL);
+
+	QCOMPARE(doc.texts(jeanne).count(), 1);
+	QCOMPARE(doc.texts(paul).count(), 2);
+}
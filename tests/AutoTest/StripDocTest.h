@@ -26,12 +26,15 @@ private slots:
 	void importDetXTextTest();
 	void importDetXDetectTest();
 	void importDetXNoTitleTest();
+	void importDetXBadFormedTest();
+	void importDetXRolesAfterBodyTest();
 
 	// Import Mos tests
 	void importMosTest01();
 	void importMosTest02();
 	void importMosTest03();
 	void importMosTest04();
+	void importMosTruncatedTest();
 
 	// Import DRB tests
 	void importDrbTest01();
@@ -44,6 +47,7 @@ private slots:
 
 	// Open any doc (*.detx, *.strip, *.joker) test
 	void openStripFileTest();
+	void cacheTest();
 	void openSaveTest01();
 	void openSaveTest02();
 
@@ -58,10 +62,13 @@ private slots:
 	void getNextTextTestByPeopleList();
 	void getNextLoopTest();
 	void getPreviousLoopTest();
+	void getTextsByPeopleTest();
 
 	void addObjectTest();
 	void addPeopleTest();
 
+	void visibleRangeTest();
+
 private:
 	QString t2s(PhTime time, PhTimeCodeType tcType);
 	PhTime s2t(QString string, PhTimeCodeType tcType);
@@ -150,3 +150,83 @@ void SynchronizerTest::testSyncRateChanged()
 	QVERIFY(PhTestTools::compareFloats(videoClock.rate(), -1));
 	QVERIFY(PhTestTools::compareFloats(syncClock.rate(), -1));
 }
+
+void SynchronizerTest::testSyncFilter()
+{
+	PhSyncFilter filter;
+	QVERIFY(!filter.isValid());
+
+	// A 24 fps signal received with a 5 ms jitter
+	qint64 frameDuration = 1000000000LL / 24;
+	for(int i = 0; i < 100; i++) {
+		qint64 jitter = (i % 2) ? 5000000 : -5000000;
+		filter.addSample(i * 1000, 1, i * frameDuration + jitter);
+	}
+	QVERIFY(filter.isValid());
+	QVERIFY(qAbs(filter.position(99 * frameDuration) - 99000) < 60);
+	QVERIFY(qAbs(filter.position(100 * frameDuration) - 100000) < 60);
+	QVERIFY(qAbs(filter.rate() - 1) < 0.01);
+
+	// A cue restarts the filter
+	filter.addSample(240000, 1, 100 * frameDuration);
+	QCOMPARE(filter.position(100 * frameDuration), 240000);
+	QVERIFY(PhTestTools::compareFloats(filter.rate(), 1));
+
+	// A paused signal is not interpolated
+	filter.addSample(240000, 0, 101 * frameDuration);
+	QCOMPARE(filter.position(200 * frameDuration), 240000);
+}
+
+void SynchronizerTest::testSlew()
+{
+	PhSynchronizer sync;
+	PhClock stripClock, videoClock, syncClock;
+
+	sync.setStripClock(&stripClock);
+	sync.setVideoClock(&videoClock);
+	sync.setSyncClock(&syncClock, PhSynchronizer::LTC);
+
+	syncClock.setRate(1);
+	syncClock.setTime(24000);
+	QCOMPARE((int)stripClock.time(), 24000);
+
+	// A small error is corrected by 10% of the strip time change at most
+	stripClock.setTime(26000);
+	QCOMPARE((int)stripClock.time(), 25800);
+	QCOMPARE((int)videoClock.time(), 25800);
+
+	stripClock.elapse(400);
+	QCOMPARE((int)stripClock.time(), 26160);
+	QCOMPARE((int)videoClock.time(), 26160);
+
+	// A big error makes the strip jump
+	stripClock.setTime(60000);
+	QVERIFY(qAbs(stripClock.time() - 24000) < 2400);
+}
+
+void SynchronizerTest::testSlewFromStripTime()
+{
+	PhSynchronizer sync;
+	PhClock stripClock, videoClock, syncClock;
+
+	// The strip is not at the origin when the synchronizer starts
+	stripClock.setTime(100000);
+	sync.setStripClock(&stripClock);
+	sync.setVideoClock(&videoClock);
+	sync.setSyncClock(&syncClock, PhSynchronizer::LTC);
+
+	syncClock.setRate(1);
+	syncClock.setTime(96000);
+	QCOMPARE((int)stripClock.time(), 100000);
+
+	// The first correction is bounded by the strip time change
+	stripClock.elapse(400);
+	QCOMPARE((int)stripClock.time(), 100360);
+
+	// A seek of the strip is not slewed
+	stripClock.setTime(90000);
+	QCOMPARE((int)stripClock.time(), 90000);
+
+	stripClock.elapse(400);
+	QCOMPARE((int)stripClock.time(), 90440);
+}
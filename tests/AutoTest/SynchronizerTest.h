@@ -19,6 +19,9 @@ private slots:
 	void testVideoRateChanged();
 	void testSyncTimeChanged();
 	void testSyncRateChanged();
+	void testSyncFilter();
+	void testSlew();
+	void testSlewFromStripTime();
 };
 
 #endif // SYNCHRONIZERTEST_H
@@ -0,0 +1,402 @@
+/**
+ * Copyright (C) 2012-2014 Phonations
+ * License: http://www.gnu.org/licenses/gpl.html GPL version 2 or higher
+ */
+#include <QTest>
+#include <QDataStream>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QImage>
+#include <QThread>
+
+extern "C" {
+#include <libavutil/opt.h>
+}
+
+#include "PhTools/PhDebug.h"
+
+#include "VideoDecoderTest.h"
+
+/** The test video generated from the interlace_%03d.bmp pictures */
+#define GOP_VIDEO "gop.avi"
+#define GOP_FRAME_COUNT 50
+#define GOP_SIZE 12
+#define GOP_KEYFRAME_COUNT ((GOP_FRAME_COUNT + GOP_SIZE - 1) / GOP_SIZE)
+/** The maximum time to wait for the decoding thread in milliseconds */
+#define DECODE_TIMEOUT 5000
+
+void VideoDecoderTest::initTestCase()
+{
+	PhDebug::enable();
+
+	QVERIFY(createVideo(GOP_VIDEO));
+}
+
+bool VideoDecoderTest::createVideo(QString fileName)
+{
+	av_register_all();
+	avcodec_register_all();
+
+	AVFormatContext *formatContext = NULL;
+	if(avformat_alloc_output_context2(&formatContext, NULL, "avi", fileName.toStdString().c_str()) < 0)
+		return false;
+
+	AVCodec *codec = avcodec_find_encoder(AV_CODEC_ID_MPEG4);
+	if(codec == NULL)
+		return false;
+
+	// A keyframe every GOP_SIZE frames and only predicted frames in between
+	AVRational timeBase = {1, 25};
+	AVStream *stream = avformat_new_stream(formatContext, codec);
+	AVCodecContext *codecContext = stream->codec;
+	codecContext->width = 64;
+	codecContext->height = 64;
+	codecContext->time_base = timeBase;
+	codecContext->pix_fmt = AV_PIX_FMT_YUV420P;
+	codecContext->gop_size = GOP_SIZE;
+	codecContext->max_b_frames = 0;
+	av_opt_set_int(codecContext, "sc_threshold", 1000000000, AV_OPT_SEARCH_CHILDREN);
+	stream->time_base = timeBase;
+
+	if((avcodec_open2(codecContext, codec, NULL) < 0)
+	   || (avio_open(&formatContext->pb, fileName.toStdString().c_str(), AVIO_FLAG_WRITE) < 0)) {
+		avformat_free_context(formatContext);
+		return false;
+	}
+	avformat_write_header(formatContext, NULL);
+
+	AVFrame *frame = av_frame_alloc();
+	frame->format = AV_PIX_FMT_YUV420P;
+	frame->width = 64;
+	frame->height = 64;
+	av_frame_get_buffer(frame, 32);
+	SwsContext *swsContext = sws_getContext(64, 64, AV_PIX_FMT_BGRA, 64, 64, AV_PIX_FMT_YUV420P,
+	                                        SWS_POINT, NULL, NULL, NULL);
+
+	bool result = true;
+	for(int i = 0; result; i++) {
+		AVFrame *input = NULL;
+		if(i < GOP_FRAME_COUNT) {
+			QImage image = QImage(QString("interlace_%1.bmp").arg(i, 3, 10, QChar('0'))).convertToFormat(QImage::Format_RGB32);
+			if(image.isNull()) {
+				result = false;
+				break;
+			}
+			const uint8_t *src = image.constBits();
+			int srcStride = image.bytesPerLine();
+			av_frame_make_writable(frame);
+			sws_scale(swsContext, &src, &srcStride, 0, 64, frame->data, frame->linesize);
+			frame->pts = i;
+			input = frame;
+		}
+
+		// A NULL input drains the encoder
+		AVPacket packet;
+		av_init_packet(&packet);
+		packet.data = NULL;
+		packet.size = 0;
+		int gotPacket = 0;
+		if(avcodec_encode_video2(codecContext, &packet, input, &gotPacket) < 0)
+			result = false;
+		else if(gotPacket) {
+			packet.pts = av_rescale_q(packet.pts, codecContext->time_base, stream->time_base);
+			packet.dts = av_rescale_q(packet.dts, codecContext->time_base, stream->time_base);
+			packet.stream_index = stream->index;
+			if(av_interleaved_write_frame(formatContext, &packet) < 0)
+				result = false;
+		}
+		else if(input == NULL)
+			break;
+	}
+
+	av_write_trailer(formatContext);
+	sws_freeContext(swsContext);
+	av_frame_free(&frame);
+	avcodec_close(codecContext);
+	avio_close(formatContext->pb);
+	avformat_free_context(formatContext);
+
+	return result;
+}
+
+void VideoDecoderTest::writeIndexHeader(QString fileName, qint64 frameLength, qint32 count)
+{
+	QDir().mkpath(QFileInfo(fileName).absolutePath());
+	QFile file(fileName);
+	QVERIFY(file.open(QIODevice::WriteOnly));
+	QDataStream stream(&file);
+	stream << (quint32)PHVIDEOINDEX_MAGIC << (quint32)PHVIDEOINDEX_VERSION;
+	stream << (qint32)PhTimeCodeType25 << (qint64)PHFRAMEMIN << frameLength << count;
+	// A single entry whatever the count is
+	stream << (qint64)0 << (qint64)-1;
+}
+
+qint32 VideoDecoderTest::readIndexCount(QString fileName)
+{
+	QFile file(fileName);
+	if(!file.open(QIODevice::ReadOnly))
+		return -1;
+	QDataStream stream(&file);
+	quint32 magic, version;
+	qint32 tcType, count;
+	qint64 frameStamp, frameLength;
+	stream >> magic >> version >> tcType >> frameStamp >> frameLength >> count;
+	if((stream.status() != QDataStream::Ok) || (magic != PHVIDEOINDEX_MAGIC) || (version != PHVIDEOINDEX_VERSION))
+		return -1;
+	return count;
+}
+
+PhVideoFrame *VideoDecoderTest::waitFrame(PhVideoDecoder *decoder, PhFrame frame)
+{
+	// Poll the ring buffer until the decoding thread stores the exact frame
+	QElapsedTimer timer;
+	timer.start();
+	while(timer.elapsed() < DECODE_TIMEOUT) {
+		PhVideoFrame *videoFrame = decoder->acquireFrame(frame);
+		if(videoFrame) {
+			if(videoFrame->frame == frame)
+				return videoFrame;
+			decoder->releaseFrame(videoFrame);
+		}
+		QThread::msleep(1);
+	}
+	return NULL;
+}
+
+bool VideoDecoderTest::waitBufferedFrames(PhVideoDecoder *decoder, QList<PhFrame> frames)
+{
+	QElapsedTimer timer;
+	timer.start();
+	while(timer.elapsed() < DECODE_TIMEOUT) {
+		if(decoder->bufferedFrames().toSet().contains(frames.toSet()))
+			return true;
+		QThread::msleep(1);
+	}
+	return false;
+}
+
+QByteArray VideoDecoderTest::picture(PhVideoFrame *videoFrame)
+{
+	return QByteArray((const char*)videoFrame->data, videoFrame->width * videoFrame->height * 4);
+}
+
+void VideoDecoderTest::indexCacheTest()
+{
+	QString cacheFileName = PhVideoDecoder::indexCacheFileName(GOP_VIDEO);
+	QVERIFY(!cacheFileName.isEmpty());
+	QFile::remove(cacheFileName);
+
+	// The first opening builds the index and writes the cache
+	PhVideoDecoder decoder;
+	QVERIFY(decoder.open(GOP_VIDEO));
+	QCOMPARE(decoder.frameLength(), (PhFrame)GOP_FRAME_COUNT);
+	QCOMPARE(decoder.timeCodeType(), PhTimeCodeType25);
+	decoder.close();
+
+	QCOMPARE(readIndexCount(cacheFileName), (qint32)GOP_KEYFRAME_COUNT);
+
+	// Alter the cached length: the second opening shall read it back
+	QFile file(cacheFileName);
+	QVERIFY(file.open(QIODevice::ReadWrite));
+	QVERIFY(file.seek(4 + 4 + 4 + 8));
+	QDataStream stream(&file);
+	stream << (qint64)42;
+	file.close();
+
+	QVERIFY(decoder.open(GOP_VIDEO));
+	QCOMPARE(decoder.frameLength(), (PhFrame)42);
+	QCOMPARE(decoder.timeCodeType(), PhTimeCodeType25);
+	decoder.close();
+
+	QFile::remove(cacheFileName);
+}
+
+void VideoDecoderTest::indexCacheCorruptTest()
+{
+	QString cacheFileName = PhVideoDecoder::indexCacheFileName(GOP_VIDEO);
+	PhVideoDecoder decoder;
+
+	// A keyframe count larger than the file content
+	writeIndexHeader(cacheFileName, 42, 0x7fffffff);
+	QVERIFY(decoder.open(GOP_VIDEO));
+	QCOMPARE(decoder.frameLength(), (PhFrame)GOP_FRAME_COUNT);
+	decoder.close();
+
+	// The invalid file has been replaced
+	QCOMPARE(readIndexCount(cacheFileName), (qint32)GOP_KEYFRAME_COUNT);
+
+	// A negative keyframe count
+	writeIndexHeader(cacheFileName, 42, -1);
+	QVERIFY(decoder.open(GOP_VIDEO));
+	QCOMPARE(decoder.frameLength(), (PhFrame)GOP_FRAME_COUNT);
+	decoder.close();
+
+	// A file truncated in the header
+	QFile file(cacheFileName);
+	QVERIFY(file.open(QIODevice::WriteOnly));
+	QDataStream stream(&file);
+	stream << (quint32)PHVIDEOINDEX_MAGIC << (quint32)PHVIDEOINDEX_VERSION << (qint32)PhTimeCodeType25;
+	file.close();
+	QVERIFY(decoder.open(GOP_VIDEO));
+	QCOMPARE(decoder.frameLength(), (PhFrame)GOP_FRAME_COUNT);
+	decoder.close();
+
+	QCOMPARE(readIndexCount(cacheFileName), (qint32)GOP_KEYFRAME_COUNT);
+
+	QFile::remove(cacheFileName);
+}
+
+void VideoDecoderTest::acquireFrameTest()
+{
+	PhVideoDecoder decoder;
+	QVERIFY(decoder.open(GOP_VIDEO));
+
+	decoder.requestFrame(20, 0);
+	PhVideoFrame *videoFrame = waitFrame(&decoder, 20);
+	QVERIFY(videoFrame);
+	QCOMPARE(videoFrame->frame, (PhFrame)20);
+	QCOMPARE(videoFrame->width, 64);
+	QCOMPARE(videoFrame->height, 64);
+	decoder.releaseFrame(videoFrame);
+
+	// A frame which is not decoded yet is not replaced by a neighbour
+	QVERIFY(decoder.acquireFrame(40) == NULL);
+
+	// After a seek, only the new frame is given back
+	decoder.requestFrame(40, 0);
+	videoFrame = waitFrame(&decoder, 40);
+	QVERIFY(videoFrame);
+	QCOMPARE(videoFrame->frame, (PhFrame)40);
+	decoder.releaseFrame(videoFrame);
+
+	videoFrame = decoder.acquireFrame(20);
+	if(videoFrame) {
+		QCOMPARE(videoFrame->frame, (PhFrame)20);
+		decoder.releaseFrame(videoFrame);
+	}
+
+	decoder.close();
+}
+
+void VideoDecoderTest::seekTest()
+{
+	// A frame between two keyframes
+	PhFrame target = GOP_SIZE + 5;
+
+	// Decode linearly from the beginning of the file
+	PhVideoDecoder linearDecoder;
+	QVERIFY(linearDecoder.open(GOP_VIDEO));
+	QByteArray expected;
+	for(PhFrame frame = 0; frame <= target; frame++) {
+		linearDecoder.requestFrame(frame, 0);
+		PhVideoFrame *videoFrame = waitFrame(&linearDecoder, frame);
+		QVERIFY(videoFrame);
+		if(frame == target)
+			expected = picture(videoFrame);
+		linearDecoder.releaseFrame(videoFrame);
+	}
+	linearDecoder.close();
+
+	// Seek directly: the decoding starts from the preceding keyframe
+	PhVideoDecoder seekDecoder;
+	QVERIFY(seekDecoder.open(GOP_VIDEO));
+	seekDecoder.requestFrame(target, 0);
+	PhVideoFrame *videoFrame = waitFrame(&seekDecoder, target);
+	QVERIFY(videoFrame);
+	QCOMPARE(videoFrame->pixelFormat, AV_PIX_FMT_BGRA);
+	QVERIFY(picture(videoFrame) == expected);
+	seekDecoder.releaseFrame(videoFrame);
+
+	// Seek backward to another frame of the same GOP
+	seekDecoder.requestFrame(target - 2, 0);
+	videoFrame = waitFrame(&seekDecoder, target - 2);
+	QVERIFY(videoFrame);
+	seekDecoder.releaseFrame(videoFrame);
+	seekDecoder.requestFrame(target, 0);
+	videoFrame = waitFrame(&seekDecoder, target);
+	QVERIFY(videoFrame);
+	QVERIFY(picture(videoFrame) == expected);
+	seekDecoder.releaseFrame(videoFrame);
+
+	seekDecoder.close();
+}
+
+void VideoDecoderTest::backwardTest()
+{
+	// The ring buffer holds 31 frames when playing backward
+	PhVideoDecoder decoder(8, 32);
+	QVERIFY(decoder.open(GOP_VIDEO));
+
+	// From frame 40, the window goes down to frame 10: the GOP starting
+	// at 36, 24 and 12 are decoded and stored entirely.
+	decoder.requestFrame(40, -1);
+	QList<PhFrame> expected;
+	for(PhFrame frame = 12; frame <= 40; frame++)
+		expected.append(frame);
+	QVERIFY(waitBufferedFrames(&decoder, expected));
+
+	// The GOP starting at 0 does not fit in the window yet
+	QTest::qWait(100);
+	QCOMPARE(decoder.bufferedFrames(), expected);
+
+	// Once the window reaches it, it is decoded at once
+	decoder.requestFrame(30, -1);
+	expected.clear();
+	for(PhFrame frame = 0; frame <= 30; frame++)
+		expected.append(frame);
+	QVERIFY(waitBufferedFrames(&decoder, expected));
+
+	// The pictures are the ones decoded forward
+	PhVideoFrame *videoFrame = decoder.acquireFrame(17);
+	QVERIFY(videoFrame);
+	QCOMPARE(videoFrame->frame, (PhFrame)17);
+	QByteArray backwardPicture = picture(videoFrame);
+	decoder.releaseFrame(videoFrame);
+	decoder.close();
+
+	QVERIFY(decoder.open(GOP_VIDEO));
+	decoder.requestFrame(17, 0);
+	videoFrame = waitFrame(&decoder, 17);
+	QVERIFY(videoFrame);
+	QVERIFY(picture(videoFrame) == backwardPicture);
+	decoder.releaseFrame(videoFrame);
+
+	decoder.close();
+}
+
+void VideoDecoderTest::fastForwardTest()
+{
+	PhVideoDecoder decoder(8, 32);
+	QVERIFY(decoder.open(GOP_VIDEO));
+
+	// One frame out of three is read ahead and the frames
+	// decoded in between are not stored.
+	decoder.requestFrame(0, 3);
+	QList<PhFrame> expected;
+	for(PhFrame frame = 0; frame <= 18; frame += 3)
+		expected.append(frame);
+	QVERIFY(waitBufferedFrames(&decoder, expected));
+	QTest::qWait(100);
+	QCOMPARE(decoder.bufferedFrames(), expected);
+
+	// Moving the request keeps the frames still in the window
+	decoder.requestFrame(9, 3);
+	expected.clear();
+	for(PhFrame frame = 9; frame <= 27; frame += 3)
+		expected.append(frame);
+	QVERIFY(waitBufferedFrames(&decoder, expected));
+
+	// Fast rewind
+	decoder.requestFrame(45, -3);
+	expected.clear();
+	for(PhFrame frame = 45; frame >= 36; frame -= 3)
+		expected.append(frame);
+	QVERIFY(waitBufferedFrames(&decoder, expected));
+	foreach(PhFrame frame, decoder.bufferedFrames()) {
+		if(frame >= 36)
+			QVERIFY((45 - frame) % 3 == 0);
+	}
+
+	decoder.close();
+}
@@ -0,0 +1,36 @@
+/**
+ * Copyright (C) 2012-2014 Phonations
+ * License: http://www.gnu.org/licenses/gpl.html GPL version 2 or higher
+ */
+
+#ifndef VIDEODECODERTEST_H
+#define VIDEODECODERTEST_H
+
+#include <QObject>
+
+#include "PhVideo/PhVideoDecoder.h"
+
+class VideoDecoderTest : public QObject
+{
+	Q_OBJECT
+
+private slots:
+	void initTestCase();
+
+	void indexCacheTest();
+	void indexCacheCorruptTest();
+	void acquireFrameTest();
+	void seekTest();
+	void backwardTest();
+	void fastForwardTest();
+
+private:
+	bool createVideo(QString fileName);
+	void writeIndexHeader(QString fileName, qint64 frameLength, qint32 count);
+	qint32 readIndexCount(QString fileName);
+	PhVideoFrame *waitFrame(PhVideoDecoder *decoder, PhFrame frame);
+	QByteArray picture(PhVideoFrame *videoFrame);
+	bool waitBufferedFrames(PhVideoDecoder *decoder, QList<PhFrame> frames);
+};
+
+#endif // VIDEODECODERTEST_H
@@ -18,6 +18,7 @@
 #include "GraphicStripTest.h"
 #include "GraphicTextTest.h"
 #include "VideoTest.h"
+#include "VideoDecoderTest.h"
 #include "MidiTest.h"
 
 int main(int argc, char *argv[])
@@ -164,6 +165,9 @@ int main(int argc, char *argv[])
 	if(testVideo) {
 		VideoTest videoTest;
 		result += QTest::qExec(&videoTest, testArgList);
+
+		VideoDecoderTest videoDecoderTest;
+		result += QTest::qExec(&videoDecoderTest, testArgList);
 	}
 
 	if(testMidi) {
@@ -0,0 +1,23 @@
+#
+# Copyright (C) 2012-2014 Phonations
+# License: http://www.gnu.org/licenses/gpl.html GPL version 2 or higher
+#
+
+TARGET = StripBatchTest
+CONFIG   += console
+CONFIG   -= app_bundle
+
+QT += concurrent
+
+TOP_ROOT = $${_PRO_FILE_PWD_}/../..
+
+include($$TOP_ROOT/common/common.pri)
+
+include($$TOP_ROOT/libs/PhTools/PhTools.pri)
+include($$TOP_ROOT/libs/PhSync/PhSync.pri)
+include($$TOP_ROOT/libs/PhStrip/PhStrip.pri)
+
+SOURCES += main.cpp
+
+PH_DEPLOY_LOCATION = $$(TESTS_RELEASE_PATH)
+include($$TOP_ROOT/common/deploy.pri)
@@ -0,0 +1,233 @@
+/**
+ * @file
+ * @copyright (C) 2012-2014 Phonations
+ * @license http://www.gnu.org/licenses/gpl.html GPL version 2 or higher
+ */
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QTextStream>
+#include <QThread>
+#include <QThreadPool>
+#include <QtConcurrent>
+
+#include "PhTools/PhDebug.h"
+#include "PhStrip/PhStripDoc.h"
+
+/**
+ * @brief The result of a document conversion
+ */
+struct StripBatchResult
+{
+	/** @brief The source file */
+	QString fileName;
+	/** @brief True if the document was imported */
+	bool opened;
+	/** @brief True if the document was written in the output format */
+	bool saved;
+	/** @brief The import duration in milliseconds */
+	double elapsed;
+	/** @brief The people count */
+	int peopleCount;
+	/** @brief The main text count */
+	int textCount;
+	/** @brief The detect count */
+	int detectCount;
+	/** @brief The loop count */
+	int loopCount;
+	/** @brief The cut count */
+	int cutCount;
+};
+
+/**
+ * @brief Import and convert the documents in a thread pool
+ */
+class StripBatchConverter
+{
+public:
+	/**
+	 * @brief StripBatchConverter constructor
+	 * @param format The output format ("joker", "cache" or "none")
+	 * @param outputPath The output folder
+	 */
+	StripBatchConverter(const QString &format, const QString &outputPath) :
+		_format(format),
+		_outputPath(outputPath)
+	{
+	}
+
+	/**
+	 * @brief The result type for QtConcurrent::mapped()
+	 */
+	typedef StripBatchResult result_type;
+
+	/**
+	 * @brief Get the path of the converted document
+	 * @param fileName The source file
+	 * @return A file path or an empty string if nothing is written
+	 */
+	QString outputFileName(const QString &fileName) const
+	{
+		QFileInfo info(fileName);
+		QDir output(_outputPath);
+		if(_format == "joker")
+			return output.absoluteFilePath(info.completeBaseName() + ".joker");
+		else if(_format == "cache")
+			return output.absoluteFilePath(PhStripDoc::cacheFileName(info.fileName()));
+		return "";
+	}
+
+	/**
+	 * @brief Import a document and write it in the output format
+	 *
+	 * It is called in a worker thread: the document is owned by
+	 * the call and only the result is given back.
+	 * @param fileName The source file
+	 * @return The conversion result
+	 */
+	StripBatchResult operator()(const QString &fileName) const
+	{
+		StripBatchResult result;
+		result.fileName = fileName;
+		result.saved = false;
+
+		QFileInfo info(fileName);
+		PhStripDoc doc;
+
+		QElapsedTimer timer;
+		timer.start();
+		result.opened = doc.openStripFile(info.absoluteFilePath());
+		result.elapsed = timer.nsecsElapsed() / 1000000.0;
+
+		result.peopleCount = doc.peoples().count();
+		result.textCount = doc.texts().count();
+		result.detectCount = doc.detects().count();
+		result.loopCount = doc.loops().count();
+		result.cutCount = doc.cuts().count();
+
+		if(result.opened) {
+			if(_format == "joker")
+				result.saved = doc.saveStripFile(outputFileName(fileName), doc.lastTime());
+			else if(_format == "cache")
+				result.saved = doc.writeCacheFile(outputFileName(fileName), info.absoluteFilePath());
+			else
+				result.saved = true;
+		}
+
+		return result;
+	}
+
+private:
+	QString _format;
+	QString _outputPath;
+};
+
+/**
+ * @brief The application main entry point
+ *
+ * Usage: StripBatchTest [-j threads] [-f joker|cache|none] [-o folder] [-m logMask] files...
+ *
+ * The documents are imported in parallel and the import duration and
+ * object counts are reported for each of them.
+ * @param argc Command line argument count
+ * @param argv Command line argument list
+ * @return 0 if all the documents were converted.
+ */
+int main(int argc, char *argv[])
+{
+	QCoreApplication app(argc, argv);
+
+	// The imports are silent unless a mask is given
+	int logMask = 0;
+	int threadCount = QThread::idealThreadCount();
+	QString format = "none";
+	QString outputPath = QDir::currentPath();
+	QStringList fileNames;
+
+	QStringList arguments = app.arguments();
+	for(int i = 1; i < arguments.count(); i++) {
+		QString argument = arguments[i];
+		if((argument == "-j") && (i + 1 < arguments.count()))
+			threadCount = arguments[++i].toInt();
+		else if((argument == "-f") && (i + 1 < arguments.count()))
+			format = arguments[++i].toLower();
+		else if((argument == "-o") && (i + 1 < arguments.count()))
+			outputPath = arguments[++i];
+		else if((argument == "-m") && (i + 1 < arguments.count()))
+			logMask = arguments[++i].toInt();
+		else if(QFile::exists(argument))
+			fileNames.append(argument);
+		else
+			PHERR << argument << "doesn't exists!!!";
+	}
+
+	QTextStream out(stdout);
+
+	if(fileNames.isEmpty() || ((format != "joker") && (format != "cache") && (format != "none"))) {
+		out << "Usage: StripBatchTest [-j threads] [-f joker|cache|none] [-o folder] [-m logMask] files..." << endl;
+		return 1;
+	}
+
+	// Create the debug instance before starting the workers
+	PhDebug::setLogMask(logMask);
+
+	if(!QDir().mkpath(outputPath)) {
+		PHERR << "Unable to create" << outputPath;
+		return 1;
+	}
+
+	// The output names only keep the base name of the sources: two sources
+	// with the same one (ep1.detx and ep1.mos, or a/ep1.detx and b/ep1.detx)
+	// would be written concurrently to the same file.
+	StripBatchConverter converter(format, outputPath);
+	QMap<QString, QString> outputs;
+	foreach(QString fileName, fileNames) {
+		QString outputFileName = converter.outputFileName(fileName);
+		if(outputFileName.isEmpty())
+			continue;
+		if(outputs.contains(outputFileName)) {
+			PHERR << fileName << "and" << outputs[outputFileName] << "are both converted to" << outputFileName;
+			return 1;
+		}
+		outputs[outputFileName] = fileName;
+	}
+
+	QThreadPool::globalInstance()->setMaxThreadCount(qMax(1, threadCount));
+
+	QElapsedTimer timer;
+	timer.start();
+	QList<StripBatchResult> results = QtConcurrent::blockingMapped<QList<StripBatchResult> >(fileNames, converter);
+	qint64 elapsed = timer.elapsed();
+
+	int result = 0;
+	double importTime = 0;
+	foreach(const StripBatchResult &r, results) {
+		out << r.fileName << "\t";
+		if(r.opened) {
+			out << QString::number(r.elapsed, 'f', 1) << " ms"
+			    << "\tpeoples: " << r.peopleCount
+			    << "\ttexts: " << r.textCount
+			    << "\tdetects: " << r.detectCount
+			    << "\tloops: " << r.loopCount
+			    << "\tcuts: " << r.cutCount;
+			if(!r.saved) {
+				out << "\tNOT SAVED";
+				result = 1;
+			}
+			importTime += r.elapsed;
+		}
+		else {
+			out << "FAILED";
+			result = 1;
+		}
+		out << endl;
+	}
+
+	out << results.count() << " files imported in " << elapsed << " ms with "
+	    << QThreadPool::globalInstance()->maxThreadCount() << " threads ("
+	    << QString::number(importTime, 'f', 1) << " ms of import)" << endl;
+
+	return result;
+}
@@ -3,6 +3,7 @@ TEMPLATE = subdirs
 SUBDIRS += \
 	GraphicStripSyncTest \
 	GraphicStripTest \
+	StripBatchTest \
 	StripTest \
 	VideoStripTest \
 
@@ -13,6 +13,7 @@ SUBDIRS += \
 	OpenGLTest \
 	SDLTest \
 	SerialTest \
+	StripBatchTest \
 	StripTest \
 	TextEditTest \
 	TimecodePlayer \